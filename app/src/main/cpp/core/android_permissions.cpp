@@ -38,7 +38,60 @@ static jclass load_java_class(JNIEnv* a_env, jobject a_instance, const string& a
 
     jstring j_class_name = a_env->NewStringUTF(a_class_name.c_str());
 
-    return static_cast<jclass>(a_env->CallObjectMethod(ClassLoaderObj, loadClass, j_class_name));
+    auto result = static_cast<jclass>(a_env->CallObjectMethod(ClassLoaderObj, loadClass, j_class_name));
+
+    a_env->DeleteLocalRef(j_class_name);
+    a_env->DeleteLocalRef(ClassLoaderObj);
+    a_env->DeleteLocalRef(ClassLoader);
+    a_env->DeleteLocalRef(NativeActivity);
+
+    return result;
+}
+
+// Class lookups through the activity class loader are expensive, so classes and method ids are resolved
+// once and kept as global references for the lifetime of the process.
+
+static struct
+{
+    jclass ActivityCompat = nullptr;
+    jclass ContextCompat = nullptr;
+    jclass String = nullptr;
+    jstring camera_permission = nullptr;
+    jmethodID ActivityCompat_requestPermissions = nullptr;
+    jmethodID ContextCompat_checkSelfPermission = nullptr;
+} jni_cache;
+
+static void initialize_jni_cache(JNIEnv* a_env, jobject a_instance)
+{
+    if(jni_cache.ContextCompat)
+        return;
+
+    auto global_class = [a_env](jclass a_class) {
+        auto result = static_cast<jclass>(a_env->NewGlobalRef(a_class));
+        a_env->DeleteLocalRef(a_class);
+        return result;
+    };
+
+    jni_cache.ActivityCompat = global_class(load_java_class(a_env, a_instance, "androidx/core/app/ActivityCompat"));
+    jni_cache.String = global_class(a_env->FindClass("java/lang/String"));
+
+    jni_cache.ActivityCompat_requestPermissions =
+        a_env->GetStaticMethodID(jni_cache.ActivityCompat, "requestPermissions",
+            "(Landroid/app/Activity;[Ljava/lang/String;I)V");
+
+    jstring camera_permission = a_env->NewStringUTF("android.permission.CAMERA");
+    jni_cache.camera_permission = static_cast<jstring>(a_env->NewGlobalRef(camera_permission));
+    a_env->DeleteLocalRef(camera_permission);
+
+    jclass ContextCompat = load_java_class(a_env, a_instance, "androidx/core/content/ContextCompat");
+
+    jni_cache.ContextCompat_checkSelfPermission =
+        a_env->GetStaticMethodID(ContextCompat, "checkSelfPermission",
+            "(Landroid/content/Context;Ljava/lang/String;)I");
+
+    // Set last, it marks the cache as complete.
+
+    jni_cache.ContextCompat = global_class(ContextCompat);
 }
 
 namespace core
@@ -52,16 +105,13 @@ namespace core
         if(vm->AttachCurrentThread(&env, nullptr) != JNI_OK)
             throw runtime_error("Could not attach thread to running VM.");
 
-        jclass ActivityCompat = load_java_class(env, instance, "androidx/core/app/ActivityCompat");
-
-        jmethodID ActivityCompat_requestPermissions =
-            env->GetStaticMethodID(ActivityCompat, "requestPermissions",
-                   "(Landroid/app/Activity;[Ljava/lang/String;I)V");
+        initialize_jni_cache(env, instance);
 
-        jstring camera_permission = env->NewStringUTF("android.permission.CAMERA");
-        jobjectArray perms = env->NewObjectArray(1, env->FindClass("java/lang/String"), nullptr);
-        env->SetObjectArrayElement(perms, 0, camera_permission);
-        env->CallStaticVoidMethod(ActivityCompat, ActivityCompat_requestPermissions, instance, perms, 1);
+        jobjectArray perms = env->NewObjectArray(1, jni_cache.String, nullptr);
+        env->SetObjectArrayElement(perms, 0, jni_cache.camera_permission);
+        env->CallStaticVoidMethod(jni_cache.ActivityCompat, jni_cache.ActivityCompat_requestPermissions,
+            instance, perms, 1);
+        env->DeleteLocalRef(perms);
 
         vm->DetachCurrentThread();
     }
@@ -75,18 +125,13 @@ namespace core
         if(vm->AttachCurrentThread(&env, nullptr) != JNI_OK)
             throw runtime_error("Could not attach thread to running VM.");
 
-        jclass ContextCompat = load_java_class(env, instance, "androidx/core/content/ContextCompat");
+        initialize_jni_cache(env, instance);
 
-        jmethodID ContextCompat_checkSelfPermission =
-            env->GetStaticMethodID(ContextCompat, "checkSelfPermission",
-               "(Landroid/content/Context;Ljava/lang/String;)I");
-
-        jstring camera_permission = env->NewStringUTF("android.permission.CAMERA");
-        jint result = env->CallStaticIntMethod(ContextCompat, ContextCompat_checkSelfPermission,
-                                               instance, camera_permission);
+        jint result = env->CallStaticIntMethod(jni_cache.ContextCompat, jni_cache.ContextCompat_checkSelfPermission,
+            instance, jni_cache.camera_permission);
 
         vm->DetachCurrentThread();
 
         return result == 0;
     }
-}
\ No newline at end of file
+}
@@ -18,6 +18,7 @@
 #ifndef NCV_EVENT_LOOP_HPP
 #define NCV_EVENT_LOOP_HPP
 
+#include <core/frame_scheduler.hpp>
 #include <android_native_app_glue.h>
 #include <utilities/log.hpp>
 
@@ -51,7 +52,10 @@ namespace core
 
             while(true)
             {
-                while((result = ALooper_pollAll(m_engine->is_rendering() ? 0 : -1, nullptr, nullptr,
+                // Sleep inside the looper until the next target frame time. Vsync callbacks and input
+                // wake it up early, pollOnce returns as soon as a callback has been dispatched.
+
+                while((result = ALooper_pollOnce(poll_timeout(), nullptr, nullptr,
                         reinterpret_cast<void**>(&source))) >= 0 )
                 {
                     if(source != nullptr)
@@ -70,7 +74,7 @@ namespace core
                         return;
                     }
                 }
-                if(m_engine->is_rendering())
+                if(m_engine->is_rendering() && m_scheduler.acquire_frame())
                 {
                     if constexpr(__ncv_logging_enabled)
                         _log_android(::utilities::log_level::verbose) << "Processing application display...";
@@ -81,8 +85,19 @@ namespace core
 
     private:
 
+        int poll_timeout()
+        {
+            if(m_engine->is_rendering() && !m_scheduler.is_running())
+                m_scheduler.start();
+            else if(!m_engine->is_rendering() && m_scheduler.is_running())
+                m_scheduler.stop();
+
+            return m_scheduler.poll_timeout();
+        }
+
         android_app* m_app = nullptr;
         std::shared_ptr<T> m_engine;
+        frame_scheduler m_scheduler;
     };
 
 }
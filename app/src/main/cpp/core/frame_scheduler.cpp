@@ -0,0 +1,188 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <core/frame_scheduler.hpp>
+#include <utilities/log.hpp>
+
+#ifdef __ANDROID__
+#include <android/choreographer.h>
+#endif
+
+#include <algorithm>
+
+using namespace ::std;
+using namespace ::std::chrono;
+using namespace ::utilities;
+
+namespace core
+{
+    frame_scheduler::frame_scheduler(nanoseconds a_period) : m_period{a_period}
+    {
+#ifdef __ANDROID__
+        // Only succeeds on threads that own a looper, which is the case for the native app glue thread.
+        m_choreographer = AChoreographer_getInstance();
+#endif
+        m_last_vsync = m_last_frame = clock::now();
+
+        if constexpr(__ncv_logging_enabled)
+            _log_android(log_level::info) << "Frame scheduler created (vsync source: "
+                << (m_choreographer ? "choreographer" : "clock") << ").";
+    }
+
+    frame_scheduler::~frame_scheduler()
+    {
+        // A callback that is still pending is harmless here, the owning looper is not polled after the
+        // event loop has returned.
+
+        stop();
+
+        if constexpr(__ncv_logging_enabled)
+            _log_android(log_level::info) << "Destroying frame scheduler...";
+    }
+
+    void frame_scheduler::start()
+    {
+        if(m_running)
+            return;
+
+        m_running = true;
+        m_frame_due = true;
+        m_last_vsync = m_last_frame = clock::now();
+
+        post_callback();
+    }
+
+    void frame_scheduler::stop() noexcept
+    {
+        m_running = false;
+        m_frame_due = false;
+    }
+
+    int frame_scheduler::poll_timeout() const
+    {
+        if(!m_running)
+            return -1;
+
+        if(m_frame_due)
+            return 0;
+
+        auto now = clock::now();
+        auto target = next_vsync(m_last_frame);
+
+        // With a choreographer the clock only takes over once vsync callbacks stall (see acquire_frame), until
+        // then there's nothing to wake up for but the callback itself.
+
+        if(m_choreographer)
+            target = max(target, m_last_vsync + 2 * m_period);
+
+        if(target <= now)
+            return 0;
+
+        auto wait = min(duration_cast<nanoseconds>(target - now), duration_cast<nanoseconds>(max_wait));
+
+        // Round up, waking early just to go back to sleep costs more than a late wake-up of a fraction
+        // of a millisecond.
+
+        return static_cast<int>((wait.count() + 999999) / 1000000);
+    }
+
+    bool frame_scheduler::acquire_frame()
+    {
+        if(!m_running)
+            return false;
+
+        auto now = clock::now();
+
+        // In clock mode the target is the first tick after the previous frame. With a choreographer the
+        // callback marks frames as due, the clock is only consulted when vsync callbacks stall.
+
+        if(!m_frame_due && (!m_choreographer || now - m_last_vsync >= 2 * m_period))
+            m_frame_due = now >= next_vsync(m_last_frame);
+
+        if(!m_frame_due)
+            return false;
+
+        m_frame_due = false;
+        m_last_frame = now;
+
+        return true;
+    }
+
+    void frame_scheduler::on_vsync(int64_t a_frame_time_ns, void *a_data)
+    {
+        auto self = static_cast<frame_scheduler*>(a_data);
+
+        self->m_callback_pending = false;
+
+        if(!self->m_running)
+            return;
+
+        auto now = clock::now();
+        auto vsync = a_frame_time_ns > 0 ? clock::time_point{nanoseconds{a_frame_time_ns}} : now;
+
+        if(vsync > now || now - vsync > 4 * self->m_period)
+            vsync = now;
+
+        // Track the actual refresh rate (60/90/120 Hz panels) with a slow moving average of the
+        // per-vsync interval.
+
+        auto delta = duration_cast<nanoseconds>(vsync - self->m_last_vsync);
+        auto periods = (delta + self->m_period / 2) / self->m_period;
+
+        if(periods > 0 && periods < 4)
+        {
+            auto estimate = clamp(delta / periods, nanoseconds{4000000}, nanoseconds{50000000});
+            self->m_period += (estimate - self->m_period) / 8;
+        }
+
+        self->m_last_vsync = vsync;
+        self->m_frame_due = true;
+
+        self->post_callback();
+    }
+
+    void frame_scheduler::post_callback()
+    {
+        if(!m_choreographer || m_callback_pending)
+            return;
+
+        m_callback_pending = true;
+
+#ifdef __ANDROID__
+#if __ANDROID_API__ >= 29
+        AChoreographer_postFrameCallback64(m_choreographer, [](int64_t a_time, void* a_data){
+            on_vsync(a_time, a_data);
+        }, this);
+#else
+        // The legacy callback hands over a long, which truncates the timestamp on 32-bit targets.
+        AChoreographer_postFrameCallback(m_choreographer, [](long a_time, void* a_data){
+            on_vsync(sizeof(long) < sizeof(int64_t) ? -1 : static_cast<int64_t>(a_time), a_data);
+        }, this);
+#endif
+#endif
+    }
+
+    frame_scheduler::clock::time_point frame_scheduler::next_vsync(clock::time_point a_now) const
+    {
+        if(a_now < m_last_vsync)
+            return m_last_vsync;
+
+        auto ticks = (a_now - m_last_vsync) / m_period;
+
+        return m_last_vsync + (ticks + 1) * m_period;
+    }
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_FRAME_SCHEDULER_HPP
+#define NCV_FRAME_SCHEDULER_HPP
+
+#include <chrono>
+#include <cstdint>
+
+class AChoreographer;
+
+namespace core
+{
+    // Paces the main loop against the display refresh. Vsync timestamps are taken from AChoreographer
+    // when one is available on the calling thread, otherwise a steady clock ticking at the nominal
+    // period stands in for the display. The event loop sleeps inside the looper until the next
+    // target frame time instead of spinning with a zero timeout.
+
+    class frame_scheduler
+    {
+    public:
+
+        using clock = std::chrono::steady_clock;
+
+        constexpr static std::chrono::nanoseconds default_period{16666667};
+
+        // Upper bound for a single looper wait, keeps input and sensor latency bounded even when
+        // the vsync source stalls.
+        constexpr static std::chrono::milliseconds max_wait{33};
+
+        explicit frame_scheduler(std::chrono::nanoseconds a_period = default_period);
+        ~frame_scheduler();
+
+        void start();
+        void stop() noexcept;
+
+        bool is_running() const { return m_running; }
+        bool is_vsync_driven() const { return m_choreographer != nullptr; }
+
+        int poll_timeout() const;
+        bool acquire_frame();
+
+        std::chrono::nanoseconds period() const { return m_period; }
+
+    private:
+
+        static void on_vsync(int64_t a_frame_time_ns, void* a_data);
+
+        void post_callback();
+        clock::time_point next_vsync(clock::time_point a_now) const;
+
+        AChoreographer* m_choreographer = nullptr;
+
+        std::chrono::nanoseconds m_period;
+        clock::time_point m_last_vsync;
+        clock::time_point m_last_frame;
+
+        bool m_running = false;
+        bool m_callback_pending = false;
+        bool m_frame_due = false;
+    };
+}
+
+#endif //NCV_FRAME_SCHEDULER_HPP
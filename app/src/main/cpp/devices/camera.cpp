@@ -76,7 +76,13 @@ namespace devices
                 // Select which camera to use (front or back)
 
                 if(facing == ACAMERA_LENS_FACING_BACK)
+                {
                     selected_camera = string(cam_id);
+
+                    m_realtime_timestamps = ACameraMetadata_getConstEntry(metadata,
+                        ACAMERA_SENSOR_INFO_TIMESTAMP_SOURCE, &entry) == ACAMERA_OK &&
+                        entry.data.u8[0] == ACAMERA_SENSOR_INFO_TIMESTAMP_SOURCE_REALTIME;
+                }
             }
             ACameraMetadata_free(metadata);
         }
@@ -24,6 +24,7 @@
 #include <camera/NdkCameraError.h>
 #include <camera/NdkCameraManager.h>
 
+#include <atomic>
 #include <memory>
 
 namespace devices
@@ -51,11 +52,23 @@ namespace devices
         void start_capturing();
         void stop_capturing();
 
+        // Whether frame timestamps share the time base of sensor events (boot time). Otherwise they are
+        // monotonic and have to be shifted before being compared against sensor samples.
+        bool has_realtime_timestamps() const { return m_realtime_timestamps; }
+
+        // False once the device has been taken over (e.g. by another application while we were in the
+        // background) or has reported an error, in which case the camera has to be reopened.
+        bool is_available() const { return m_available; }
+
         static void on_device_disconnected(void* a_obj, ACameraDevice* a_device)
-        {}
+        {
+            reinterpret_cast<camera*>(a_obj)->m_available = false;
+        }
 
         static void on_device_error(void* a_obj, ACameraDevice* a_device, int a_err_code)
-        {}
+        {
+            reinterpret_cast<camera*>(a_obj)->m_available = false;
+        }
 
         static void on_session_closed(void* a_obj, ACameraCaptureSession* a_session)
         {}
@@ -91,6 +104,9 @@ namespace devices
         ACameraCaptureSession_ptr m_session;
         ACaptureRequest_ptr m_capture_req;
         ACameraOutputTarget_ptr m_target;
+
+        bool m_realtime_timestamps = false;
+        std::atomic<bool> m_available{true};
     };
 
 }
@@ -34,6 +34,7 @@ namespace devices
             m_images.push_back({nullptr, AImage_delete});
 
         m_buffers = vector<AHardwareBuffer*>(a_max_images, nullptr);
+        m_timestamps = vector<int64_t>(a_max_images, 0);
 
         auto pt = m_reader.release();
         AImageReader_newWithUsage(a_width, a_height, a_format, a_usage, m_images.size()+2, &pt);
@@ -82,12 +83,19 @@ namespace devices
                     m_cur_index = 0;
                 m_images[m_cur_index].reset(image);
                 m_buffers[m_cur_index] = buffer;
+                if(AImage_getTimestamp(image, &m_timestamps[m_cur_index]) != AMEDIA_OK)
+                    m_timestamps[m_cur_index] = 0;
             }
         }
 
         return m_buffers[m_cur_index];
     }
 
+    int64_t image_reader::get_latest_timestamp() const
+    {
+        return m_timestamps[m_cur_index];
+    }
+
     ANativeWindow * image_reader::get_window() const
     {
         return m_window;
@@ -38,6 +38,7 @@ namespace devices
         ~image_reader();
 
         AHardwareBuffer* get_latest_buffer();
+        int64_t get_latest_timestamp() const;
         ANativeWindow* get_window() const;
 
     private:
@@ -45,6 +46,7 @@ namespace devices
         uint32_t m_cur_index;
         ANativeWindow* m_window = nullptr;
         std::vector<AHardwareBuffer*> m_buffers;
+        std::vector<int64_t> m_timestamps;
 
         img_reader_ptr m_reader;
         std::vector<image_ptr> m_images;
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_SENSOR_FILTER_HPP
+#define NCV_SENSOR_FILTER_HPP
+
+#include <cstdint>
+
+namespace devices
+{
+    // Filters are driven by sample timestamps (nanoseconds) rather than by call count, so batched
+    // sensor events are weighted by the time they actually cover.
+
+    template<typename T>
+    class low_pass_filter
+    {
+    public:
+
+        // A time constant of zero (or less) lets samples through unfiltered.
+
+        explicit low_pass_filter(float a_time_constant = 0.f) : m_time_constant{a_time_constant}
+        {}
+
+        void set_time_constant(float a_time_constant) { m_time_constant = a_time_constant; }
+        void reset() { m_primed = false; }
+
+        const T& update(int64_t a_timestamp, const T& a_value)
+        {
+            if(!m_primed || m_time_constant <= 0.f)
+            {
+                m_state = a_value;
+                m_timestamp = a_timestamp;
+                m_primed = true;
+                return m_state;
+            }
+
+            auto dt = static_cast<float>(a_timestamp - m_timestamp) * 1e-9f;
+
+            if(dt <= 0.f)
+                return m_state;
+
+            m_timestamp = a_timestamp;
+            m_state = m_state + (a_value - m_state) * (dt / (m_time_constant + dt));
+
+            return m_state;
+        }
+
+        const T& state() const { return m_state; }
+
+    private:
+
+        float m_time_constant;
+        bool m_primed = false;
+        int64_t m_timestamp = 0;
+        T m_state{};
+    };
+
+    // Blends an integrated rate signal (responsive but drifting, e.g. gyroscope) with an absolute
+    // reference (drift free but noisy, e.g. gravity from the accelerometer). The time constant sets the
+    // crossover: below it the rate path dominates, above it the reference does.
+
+    template<typename T>
+    class complementary_filter
+    {
+    public:
+
+        explicit complementary_filter(float a_time_constant = .5f) : m_time_constant{a_time_constant}
+        {}
+
+        void set_time_constant(float a_time_constant) { m_time_constant = a_time_constant; }
+        void reset() { m_primed = false; }
+        bool is_primed() const { return m_primed; }
+
+        const T& update(int64_t a_timestamp, const T& a_rate, const T& a_reference)
+        {
+            if(!m_primed)
+            {
+                m_state = a_reference;
+                m_timestamp = a_timestamp;
+                m_primed = true;
+                return m_state;
+            }
+
+            auto dt = static_cast<float>(a_timestamp - m_timestamp) * 1e-9f;
+
+            if(dt <= 0.f)
+                return m_state;
+
+            auto k = m_time_constant > 0.f ? m_time_constant / (m_time_constant + dt) : 0.f;
+
+            m_timestamp = a_timestamp;
+            m_state = (m_state + a_rate * dt) * k + a_reference * (1.f - k);
+
+            return m_state;
+        }
+
+        const T& state() const { return m_state; }
+
+    private:
+
+        float m_time_constant;
+        bool m_primed = false;
+        int64_t m_timestamp = 0;
+        T m_state{};
+    };
+}
+
+#endif //NCV_SENSOR_FILTER_HPP
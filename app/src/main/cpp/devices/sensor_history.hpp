@@ -0,0 +1,142 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_SENSOR_HISTORY_HPP
+#define NCV_SENSOR_HISTORY_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace devices
+{
+    template<typename T>
+    struct sensor_sample
+    {
+        int64_t timestamp;
+        T value;
+    };
+
+    // Fixed capacity ring buffer of timestamped samples, ordered by timestamp. Oldest samples are
+    // overwritten once the buffer is full. Free of platform dependencies so recorded sample streams
+    // can be replayed through it on any host.
+
+    template<typename T, size_t Capacity = 256>
+    class sensor_history
+    {
+    public:
+
+        static_assert(Capacity > 1, "History must be able to hold at least two samples.");
+
+        constexpr static size_t capacity = Capacity;
+
+        bool push(int64_t a_timestamp, const T& a_value)
+        {
+            // Out of order or duplicate samples would break the interpolation search.
+
+            if(m_count > 0 && a_timestamp <= latest().timestamp)
+                return false;
+
+            m_samples[(m_first + m_count) % Capacity] = {a_timestamp, a_value};
+
+            if(m_count < Capacity)
+                ++m_count;
+            else
+                m_first = (m_first + 1) % Capacity;
+
+            return true;
+        }
+
+        void clear()
+        {
+            m_first = m_count = 0;
+        }
+
+        bool empty() const { return m_count == 0; }
+        size_t size() const { return m_count; }
+
+        // Index 0 is the oldest sample held.
+
+        const sensor_sample<T>& operator[](size_t a_index) const
+        {
+            return m_samples[(m_first + a_index) % Capacity];
+        }
+
+        const sensor_sample<T>& oldest() const { return (*this)[0]; }
+        const sensor_sample<T>& latest() const { return (*this)[m_count - 1]; }
+
+        // Linearly interpolated state at the requested timestamp. Requests outside the recorded range
+        // are clamped to the closest sample instead of extrapolated.
+
+        T sample_at(int64_t a_timestamp) const
+        {
+            return sample_at(a_timestamp, [](const T& a_lhs, const T& a_rhs, float a_t) {
+                return a_lhs + (a_rhs - a_lhs) * a_t;
+            });
+        }
+
+        // Same as above with a caller supplied blend, for values that don't interpolate linearly
+        // (e.g. rotations).
+
+        template<typename Interpolate>
+        T sample_at(int64_t a_timestamp, Interpolate a_interpolate) const
+        {
+            if(m_count == 0)
+                return T{};
+
+            if(a_timestamp <= oldest().timestamp)
+                return oldest().value;
+
+            if(a_timestamp >= latest().timestamp)
+                return latest().value;
+
+            auto upper = upper_bound(a_timestamp);
+            auto& a = (*this)[upper - 1];
+            auto& b = (*this)[upper];
+
+            auto t = static_cast<float>(a_timestamp - a.timestamp) / static_cast<float>(b.timestamp - a.timestamp);
+
+            return a_interpolate(a.value, b.value, t);
+        }
+
+        // Logical index of the first sample with a timestamp greater than the one given.
+
+        size_t upper_bound(int64_t a_timestamp) const
+        {
+            size_t lo = 0, hi = m_count;
+
+            while(lo < hi)
+            {
+                auto mid = lo + (hi - lo) / 2;
+                if((*this)[mid].timestamp <= a_timestamp)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+
+            return lo;
+        }
+
+    private:
+
+        std::array<sensor_sample<T>, Capacity> m_samples{};
+        size_t m_first = 0;
+        size_t m_count = 0;
+    };
+}
+
+#endif //NCV_SENSOR_HISTORY_HPP
@@ -0,0 +1,219 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <devices/sensor_hub.hpp>
+#include <utilities/log.hpp>
+#include <android_native_app_glue.h>
+#include <android/sensor.h>
+
+#include <ctime>
+
+using namespace ::std;
+using namespace ::utilities;
+
+namespace
+{
+    constexpr array<int, 3> sensor_types = {
+        ASENSOR_TYPE_ACCELEROMETER,
+        ASENSOR_TYPE_GYROSCOPE,
+        ASENSOR_TYPE_ROTATION_VECTOR
+    };
+
+    int64_t clock_ns(clockid_t a_clock)
+    {
+        timespec ts;
+        clock_gettime(a_clock, &ts);
+        return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+    }
+}
+
+namespace devices
+{
+    sensor_hub::sensor_hub(android_app *a_app, const string &a_package_name)
+        : m_queue{nullptr, [&](ASensorEventQueue* pt){
+            ASensorManager_destroyEventQueue(m_manager, pt);
+        }}
+    {
+        m_manager = ASensorManager_getInstanceForPackage(a_package_name.c_str());
+
+        for(size_t i = 0; i < sensor_types.size(); ++i)
+            m_sensors[i] = ASensorManager_getDefaultSensor(m_manager, sensor_types[i]);
+
+        // All sensors share a single queue, hence a single looper wake-up per batch.
+
+        m_queue.reset(ASensorManager_createEventQueue(m_manager, a_app->looper, LOOPER_ID_USER, nullptr, nullptr));
+
+        update_clock_offset();
+
+        if constexpr(__ncv_logging_enabled)
+            _log_android(log_level::info) << "Sensor hub created (accelerometer: "
+                << is_available(sensor::accelerometer) << ", gyroscope: " << is_available(sensor::gyroscope)
+                << ", rotation vector: " << is_available(sensor::rotation_vector) << ").";
+    }
+
+    sensor_hub::~sensor_hub()
+    {
+        if constexpr(__ncv_logging_enabled)
+            _log_android(log_level::info) << "Destroying sensor hub...";
+    }
+
+    void sensor_hub::disable()
+    {
+        m_rate = 0;
+
+        for(auto sensor : m_sensors)
+            if(sensor)
+                ASensorEventQueue_disableSensor(m_queue.get(), sensor);
+
+        m_accel_filter.reset();
+        m_gravity_filter.reset();
+        m_angular_rate = glm::vec3{0.f, 0.f, 0.f};
+        m_timeline.clear();
+    }
+
+    void sensor_hub::enable(int32_t a_rate, int64_t a_max_report_latency_us)
+    {
+        m_rate = a_rate < 1 ? 1u : (static_cast<uint32_t>(a_rate) > max_rate ? max_rate : a_rate);
+
+        for(auto sensor : m_sensors)
+        {
+            if(!sensor)
+                continue;
+
+            auto latency = ASensor_getFifoMaxEventCount(sensor) > 0 ? a_max_report_latency_us : 0;
+            auto result = ASensorEventQueue_registerSensor(m_queue.get(), sensor, 1000000 / m_rate, latency);
+
+            if constexpr(__ncv_logging_enabled)
+                if(result < 0)
+                    _log_android(log_level::error) << "Failed to register sensor of type "
+                        << ASensor_getType(sensor) << " (code: " << result << ").";
+        }
+
+        update_clock_offset();
+    }
+
+    void sensor_hub::set_filter_time_constant(float a_seconds)
+    {
+        m_accel_filter.set_time_constant(a_seconds);
+        m_accel_filter.reset();
+    }
+
+    void sensor_hub::set_fusion_time_constant(float a_seconds)
+    {
+        m_gravity_filter.set_time_constant(a_seconds);
+        m_gravity_filter.reset();
+    }
+
+    bool sensor_hub::is_available(sensor a_sensor) const
+    {
+        return m_sensors[static_cast<size_t>(a_sensor)] != nullptr;
+    }
+
+    size_t sensor_hub::process_events()
+    {
+        array<ASensorEvent, 64> events;
+        ssize_t e_count = -1;
+        size_t total = 0;
+
+        if(m_rate < 1)
+            return 0;
+
+        while((e_count = ASensorEventQueue_getEvents(m_queue.get(), events.data(), events.size())) > 0)
+        {
+            for(ssize_t i = 0; i < e_count; ++i)
+            {
+                auto& event = events[i];
+
+                switch(event.type)
+                {
+                    case ASENSOR_TYPE_ACCELEROMETER:
+                    {
+                        m_acceleration = {event.acceleration.x, event.acceleration.y, event.acceleration.z};
+                        m_timeline.push_acceleration(event.timestamp,
+                            m_accel_filter.update(event.timestamp, m_acceleration));
+                        fuse_gravity(event.timestamp);
+                        break;
+                    }
+                    case ASENSOR_TYPE_GYROSCOPE:
+                        m_angular_rate = {event.data[0], event.data[1], event.data[2]};
+                        m_timeline.push_angular_rate(event.timestamp, m_angular_rate);
+                        if(m_gravity_filter.is_primed())
+                            fuse_gravity(event.timestamp);
+                        break;
+                    case ASENSOR_TYPE_ROTATION_VECTOR:
+                    {
+                        // The scalar component has always been reported since API level 18, below the minimum
+                        // SDK, so it is taken as is (its sign is part of the rotation).
+
+                        float x = event.data[0], y = event.data[1], z = event.data[2], w = event.data[3];
+
+                        m_timeline.push_orientation(event.timestamp, glm::normalize(glm::quat{w, x, y, z}));
+                        break;
+                    }
+                    default:
+                        break;
+                }
+            }
+
+            total += e_count;
+        }
+
+        // The offset between the two time bases drifts across device suspend, refresh it per batch.
+
+        if(total > 0)
+            update_clock_offset();
+
+        if constexpr(__ncv_logging_enabled)
+            if(total > 0)
+                _log_android(log_level::verbose) << "Sensor hub processed " << total << " events.";
+
+        return total;
+    }
+
+    sensor_state sensor_hub::latest() const
+    {
+        return m_timeline.latest();
+    }
+
+    sensor_state sensor_hub::state_at(int64_t a_timestamp, time_base a_base) const
+    {
+        return m_timeline.state_at(a_timestamp, a_base);
+    }
+
+    void sensor_hub::fuse_gravity(int64_t a_timestamp)
+    {
+        // Gravity is fixed in the world, so in the device frame it turns against the device's own rotation
+        // (dg/dt = g x w). The gyroscope carries it between samples and the raw accelerometer reading pulls it
+        // back, cancelling the gyroscope drift and filtering out linear acceleration. Without a gyroscope this
+        // reduces to a low-pass filter of the accelerometer.
+
+        auto rate = glm::cross(m_gravity_filter.state(), m_angular_rate);
+
+        m_timeline.push_gravity(a_timestamp, m_gravity_filter.update(a_timestamp, rate, m_acceleration));
+    }
+
+    void sensor_hub::update_clock_offset()
+    {
+        // Bracket the boot time reading with two monotonic ones to bound the sampling error.
+
+        auto mono_before = clock_ns(CLOCK_MONOTONIC);
+        auto boot = clock_ns(CLOCK_BOOTTIME);
+        auto mono_after = clock_ns(CLOCK_MONOTONIC);
+
+        m_timeline.set_monotonic_offset(boot - (mono_before + (mono_after - mono_before) / 2));
+    }
+}
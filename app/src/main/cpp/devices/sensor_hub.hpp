@@ -0,0 +1,89 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_SENSOR_HUB_HPP
+#define NCV_SENSOR_HUB_HPP
+
+#include <devices/sensor_filter.hpp>
+#include <devices/sensor_timeline.hpp>
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+
+class ASensorEventQueue;
+class ASensorManager;
+class ASensor;
+class android_app;
+
+namespace devices
+{
+    class sensor_hub
+    {
+    public:
+
+        using ASensorEventQueue_ptr = std::unique_ptr<ASensorEventQueue, std::function<void(ASensorEventQueue*)>>;
+        using time_base = sensor_timeline::time_base;
+
+        enum class sensor : uint32_t
+        {
+            accelerometer = 0,
+            gyroscope,
+            rotation_vector,
+            count
+        };
+
+        constexpr static float g = 9.81f;
+        constexpr static uint32_t max_rate = 200u;
+        constexpr static int64_t default_report_latency_us = 50000;
+
+        explicit sensor_hub(android_app* a_app, const std::string& a_package_name);
+        ~sensor_hub();
+
+        void disable();
+        void enable(int32_t a_rate = 60, int64_t a_max_report_latency_us = default_report_latency_us);
+        void set_filter_time_constant(float a_seconds);
+        void set_fusion_time_constant(float a_seconds);
+
+        bool is_available(sensor a_sensor) const;
+
+        size_t process_events();
+        sensor_state latest() const;
+        sensor_state state_at(int64_t a_timestamp, time_base a_base = time_base::boottime) const;
+        const sensor_timeline& get_timeline() const { return m_timeline; }
+
+    private:
+
+        void update_clock_offset();
+        void fuse_gravity(int64_t a_timestamp);
+
+        ASensorEventQueue_ptr m_queue;
+        ASensorManager* m_manager = nullptr;
+        std::array<const ASensor*, static_cast<size_t>(sensor::count)> m_sensors{};
+
+        uint32_t m_rate = 0;
+
+        low_pass_filter<glm::vec3> m_accel_filter{.05f};
+        complementary_filter<glm::vec3> m_gravity_filter{.5f};
+        glm::vec3 m_acceleration{0.f, 0.f, 0.f};
+        glm::vec3 m_angular_rate{0.f, 0.f, 0.f};
+        sensor_timeline m_timeline;
+    };
+}
+
+#endif //NCV_SENSOR_HUB_HPP
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_SENSOR_TIMELINE_HPP
+#define NCV_SENSOR_TIMELINE_HPP
+
+#include <devices/sensor_history.hpp>
+
+#include <algorithm>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace devices
+{
+    struct sensor_state
+    {
+        int64_t timestamp = 0;
+        glm::vec3 acceleration{0.f, 0.f, 0.f};
+        glm::vec3 angular_rate{0.f, 0.f, 0.f};
+        glm::vec3 gravity{0.f, 0.f, 0.f};
+        glm::quat orientation{1.f, 0.f, 0.f, 0.f};
+    };
+
+    // Per-sensor timestamped histories and the logic that resamples them on an arbitrary time point,
+    // typically the capture timestamp of the camera frame on screen. Sensor events are stamped in the
+    // boot time base (elapsedRealtimeNanos), camera frames either in the same base or in the monotonic
+    // one depending on ACAMERA_SENSOR_INFO_TIMESTAMP_SOURCE. Kept free of platform calls so it can be
+    // driven by synthetic streams.
+
+    class sensor_timeline
+    {
+    public:
+
+        enum class time_base
+        {
+            boottime,
+            monotonic
+        };
+
+        // Offset to add to a monotonic timestamp to bring it to the boot time base.
+
+        void set_monotonic_offset(int64_t a_offset_ns) { m_monotonic_offset = a_offset_ns; }
+        int64_t monotonic_offset() const { return m_monotonic_offset; }
+
+        void push_acceleration(int64_t a_timestamp, const glm::vec3& a_value)
+        {
+            m_acceleration.push(a_timestamp, a_value);
+        }
+
+        void push_angular_rate(int64_t a_timestamp, const glm::vec3& a_value)
+        {
+            m_angular_rate.push(a_timestamp, a_value);
+        }
+
+        void push_gravity(int64_t a_timestamp, const glm::vec3& a_value)
+        {
+            m_gravity.push(a_timestamp, a_value);
+        }
+
+        void push_orientation(int64_t a_timestamp, const glm::quat& a_value)
+        {
+            // Keep consecutive samples in the same hemisphere so plain interpolation takes the short arc.
+
+            auto value = a_value;
+
+            if(!m_orientation.empty() && glm::dot(m_orientation.latest().value, value) < 0.f)
+                value = -value;
+
+            m_orientation.push(a_timestamp, value);
+        }
+
+        void clear()
+        {
+            m_acceleration.clear();
+            m_angular_rate.clear();
+            m_gravity.clear();
+            m_orientation.clear();
+        }
+
+        int64_t to_boottime(int64_t a_timestamp, time_base a_base) const
+        {
+            return a_base == time_base::monotonic ? a_timestamp + m_monotonic_offset : a_timestamp;
+        }
+
+        int64_t latest_timestamp() const
+        {
+            int64_t result = 0;
+
+            if(!m_acceleration.empty())
+                result = std::max(result, m_acceleration.latest().timestamp);
+            if(!m_angular_rate.empty())
+                result = std::max(result, m_angular_rate.latest().timestamp);
+            if(!m_gravity.empty())
+                result = std::max(result, m_gravity.latest().timestamp);
+            if(!m_orientation.empty())
+                result = std::max(result, m_orientation.latest().timestamp);
+
+            return result;
+        }
+
+        sensor_state latest() const
+        {
+            return state_at(latest_timestamp());
+        }
+
+        sensor_state state_at(int64_t a_timestamp, time_base a_base = time_base::boottime) const
+        {
+            sensor_state state;
+
+            state.timestamp = to_boottime(a_timestamp, a_base);
+            state.acceleration = m_acceleration.sample_at(state.timestamp);
+            state.angular_rate = m_angular_rate.sample_at(state.timestamp);
+            state.gravity = m_gravity.sample_at(state.timestamp);
+
+            if(!m_orientation.empty())
+                state.orientation = m_orientation.sample_at(state.timestamp,
+                    [](const glm::quat& a_lhs, const glm::quat& a_rhs, float a_t) {
+                        return glm::normalize(glm::slerp(a_lhs, a_rhs, a_t));
+                    });
+
+            return state;
+        }
+
+        const sensor_history<glm::vec3>& acceleration() const { return m_acceleration; }
+        const sensor_history<glm::vec3>& angular_rate() const { return m_angular_rate; }
+        const sensor_history<glm::vec3>& gravity() const { return m_gravity; }
+        const sensor_history<glm::quat>& orientation() const { return m_orientation; }
+
+    private:
+
+        int64_t m_monotonic_offset = 0;
+
+        sensor_history<glm::vec3> m_acceleration;
+        sensor_history<glm::vec3> m_angular_rate;
+        sensor_history<glm::vec3> m_gravity;
+        sensor_history<glm::quat> m_orientation;
+    };
+}
+
+#endif //NCV_SENSOR_TIMELINE_HPP
@@ -67,6 +67,8 @@ namespace engine
 
         virtual void start_engine() = 0;
         virtual void stop_engine() = 0;
+        virtual void suspend_engine() = 0;
+        virtual bool resume_engine() = 0;
 
         const std::string m_package_name, m_app_name;
         const uint32_t m_app_version;
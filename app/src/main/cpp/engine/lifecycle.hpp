@@ -0,0 +1,114 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_LIFECYCLE_HPP
+#define NCV_LIFECYCLE_HPP
+
+#include <cstdint>
+
+namespace engine
+{
+    // Drives the engine through its application lifecycle. The backend is expected to provide:
+    //
+    //   void start_engine();      cold start, creates devices and graphics resources
+    //   void stop_engine();       full teardown
+    //   void suspend_engine();    warm suspend, pauses devices and drops the window bound resources
+    //   bool resume_engine();     warm resume, returns false when the kept devices are no longer usable
+    //
+    // The machine itself holds no platform state, so it can be exercised with a fake backend.
+
+    template<typename Backend>
+    class lifecycle
+    {
+    public:
+
+        enum class state : uint8_t
+        {
+            idle,
+            running,
+            suspended
+        };
+
+        explicit lifecycle(Backend& a_backend) : m_backend{a_backend}
+        {}
+
+        // Window has focus and is ready to be rendered into. A change in camera permission since the last
+        // cold start invalidates the kept devices, hence it forces a cold restart.
+
+        void focus_gained(bool a_camera_permitted)
+        {
+            bool reconfigure = m_state != state::idle && a_camera_permitted != m_camera_permitted;
+
+            m_camera_permitted = a_camera_permitted;
+
+            if(reconfigure)
+                stop();
+
+            switch(m_state)
+            {
+                case state::idle:
+                    m_backend.start_engine();
+                    m_state = state::running;
+                    break;
+                case state::suspended:
+                    if(!m_backend.resume_engine())
+                    {
+                        m_backend.stop_engine();
+                        m_backend.start_engine();
+                    }
+                    m_state = state::running;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        void window_terminated()
+        {
+            if(m_state != state::running)
+                return;
+
+            m_backend.suspend_engine();
+            m_state = state::suspended;
+        }
+
+        void destroy()
+        {
+            stop();
+        }
+
+        state get_state() const { return m_state; }
+        bool is_camera_permitted() const { return m_camera_permitted; }
+
+    private:
+
+        void stop()
+        {
+            if(m_state == state::idle)
+                return;
+
+            m_backend.stop_engine();
+            m_state = state::idle;
+        }
+
+        Backend& m_backend;
+        state m_state = state::idle;
+        bool m_camera_permitted = false;
+    };
+}
+
+#endif //NCV_LIFECYCLE_HPP
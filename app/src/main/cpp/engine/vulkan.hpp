@@ -19,9 +19,10 @@
 #define NCV_VULKAN_HPP
 
 #include <engine/generic.hpp>
+#include <engine/lifecycle.hpp>
 #include <core/android_permissions.hpp>
 #include <vk_util/vk_helpers.hpp>
-#include <devices/accelerometer.hpp>
+#include <devices/sensor_hub.hpp>
 #include <devices/image_reader.hpp>
 #include <devices/camera.hpp>
 #include <android_native_app_glue.h>
@@ -57,8 +58,14 @@ namespace engine
 
     private:
 
+        friend class lifecycle<vulkan>;
+
         void start_engine();
         void stop_engine() noexcept;
+        void suspend_engine();
+        bool resume_engine();
+        void reset_frame_counters();
+        void update_state(const ::devices::sensor_state& a_sensors);
 
         static std::chrono::time_point<std::chrono::high_resolution_clock> m_time_pt;
         uint64_t m_frames_processed = 0;
@@ -67,7 +74,9 @@ namespace engine
 
         T m_context;
 
-        std::shared_ptr<::devices::accelerometer> m_accelerometer;
+        lifecycle<vulkan> m_lifecycle{*this};
+
+        std::shared_ptr<::devices::sensor_hub> m_sensors;
         std::shared_ptr<::devices::image_reader> m_img_reader;
         std::shared_ptr<::devices::camera> m_camera;
     };
@@ -97,11 +106,20 @@ namespace engine
     template<typename T>
     inline void vulkan<T>::process_devices_input()
     {
-        using ::devices::accelerometer;
-
         if(!this->m_rendering)
             return;
 
+        m_sensors->process_events();
+
+        if constexpr(__ncv_logging_enabled)
+            _log_android(::utilities::log_level::verbose) << "Devices input has been processed.";
+    }
+
+    template<typename T>
+    inline void vulkan<T>::update_state(const ::devices::sensor_state& a_sensors)
+    {
+        using ::devices::sensor_hub;
+
         int32_t c = floorf(((m_state.touch_pos.x * m_state.touch_pos.y) /
                             (m_state.screen_size.s * m_state.screen_size.t)) * 65535.f);
 
@@ -110,12 +128,9 @@ namespace engine
         m_state.back_color = {
             ((c & 0xff00) >> 8) / 255.f,
             (c & 0xff) / 255.f,
-            powf((accelerometer::g - fabsf(m_accelerometer->get_acceleration().y)) / accelerometer::g, 2.0f),
+            powf((sensor_hub::g - fabsf(a_sensors.gravity.y)) / sensor_hub::g, 2.0f),
             1.f
         };
-
-        if constexpr(__ncv_logging_enabled)
-            _log_android(::utilities::log_level::verbose) << "Devices input has been processed.";
     }
 
     template<typename T>
@@ -124,31 +139,43 @@ namespace engine
         using std::chrono::nanoseconds;
         using std::chrono::high_resolution_clock;
         using std::chrono::duration_cast;
+        using ::devices::sensor_hub;
 
-        if constexpr(__ncv_profiling_enabled)
+        AHardwareBuffer* buffer = nullptr;
+        auto sensors = m_sensors->latest();
+
+        if constexpr(std::is_same<decltype(m_context), ::graphics::complex_context>())
         {
-            if constexpr(std::is_same<decltype(m_context), ::graphics::complex_context>())
-                if(this->m_cam_permission)
-                    m_context.render_frame(m_state.back_color, m_img_reader->get_latest_buffer());
-                else
-                    m_context.render_frame(m_state.back_color);
-            else if constexpr(std::is_same<decltype(m_context), ::graphics::simple_context>())
+            if(this->m_cam_permission)
+            {
+                // Resample the sensors at the capture time of the frame that is about to be shown, so
+                // that anything derived from them lines up with the camera image.
+
+                buffer = m_img_reader->get_latest_buffer();
+
+                if(auto timestamp = m_img_reader->get_latest_timestamp(); timestamp > 0)
+                    sensors = m_sensors->state_at(timestamp, m_camera->has_realtime_timestamps() ?
+                        sensor_hub::time_base::boottime : sensor_hub::time_base::monotonic);
+            }
+        }
+
+        update_state(sensors);
+
+        if constexpr(std::is_same<decltype(m_context), ::graphics::complex_context>())
+            if(buffer)
+                m_context.render_frame(m_state.back_color, buffer);
+            else
                 m_context.render_frame(m_state.back_color);
+        else if constexpr(std::is_same<decltype(m_context), ::graphics::simple_context>())
+            m_context.render_frame(m_state.back_color);
+
+        if constexpr(__ncv_profiling_enabled)
+        {
             m_frames_processed++;
             auto ns = duration_cast<nanoseconds>(high_resolution_clock::now() - m_time_pt);
             _log_android(::utilities::log_level::verbose) << "Rate of processed frames: "
                 << m_frames_processed / (ns.count() / 1e+9) << " Hz";
         }
-        else
-        {
-            if constexpr(std::is_same<decltype(m_context), ::graphics::complex_context>())
-                if(this->m_cam_permission)
-                    m_context.render_frame(m_state.back_color, m_img_reader->get_latest_buffer());
-                else
-                    m_context.render_frame(m_state.back_color);
-            else if constexpr(std::is_same<decltype(m_context), ::graphics::simple_context>())
-                m_context.render_frame(m_state.back_color);
-        }
 
         if constexpr(__ncv_logging_enabled)
             _log_android(::utilities::log_level::verbose) << "Display has been processed.";
@@ -176,10 +203,13 @@ namespace engine
                 break;
             case APP_CMD_GAINED_FOCUS:
                 engine->m_cam_permission = permissions.is_camera_permitted(engine->m_app);
-                engine->start_engine();
+                engine->m_lifecycle.focus_gained(engine->m_cam_permission);
                 break;
             case APP_CMD_TERM_WINDOW:
-                engine->stop_engine();
+                engine->m_lifecycle.window_terminated();
+                break;
+            case APP_CMD_DESTROY:
+                engine->m_lifecycle.destroy();
                 break;
             default:
                 break;
@@ -229,7 +259,21 @@ namespace engine
 
         // Initialize camera and image reader
 
-        m_accelerometer = std::make_shared<accelerometer>(this->m_app, this->m_package_name);
+        m_sensors = std::make_shared<sensor_hub>(this->m_app, this->m_package_name);
+
+        // The latest orientation is drained from the sensor queue at the moment the transform is latched
+
+        if constexpr(std::is_same<decltype(m_context), ::graphics::complex_context>())
+            m_context.set_orientation_source([sensors = std::weak_ptr<sensor_hub>{m_sensors}]() {
+                auto hub = sensors.lock();
+
+                if(!hub)
+                    return glm::quat{1.f, 0.f, 0.f, 0.f};
+
+                hub->process_events();
+
+                return hub->latest().orientation;
+            });
 
         if constexpr(std::is_same<decltype(m_context), ::graphics::complex_context>())
         {
@@ -245,13 +289,7 @@ namespace engine
             }
         }
 
-        // Reset framerate counters
-
-        if constexpr(__ncv_profiling_enabled)
-        {
-            m_time_pt = std::chrono::high_resolution_clock::now();
-            m_frames_processed = 0;
-        }
+        reset_frame_counters();
 
         // Initialize graphics
 
@@ -269,7 +307,7 @@ namespace engine
 
         this->m_rendering = true;
 
-        m_accelerometer->enable();
+        m_sensors->enable();
 
         if constexpr(__ncv_logging_enabled)
             _log_android(::utilities::log_level::info) << "Vulkan engine has been started.";
@@ -279,21 +317,97 @@ namespace engine
     inline void vulkan<T>::stop_engine() noexcept
     {
         if constexpr(std::is_same<decltype(m_context), ::graphics::complex_context>())
-            if(this->m_cam_permission)
+            if(m_camera)
                 m_camera->stop_capturing();
         this->m_rendering = false;
-        m_accelerometer->disable();
+        if(m_sensors)
+            m_sensors->disable();
         if constexpr(std::is_same<decltype(m_context), ::graphics::complex_context>())
         {
             m_camera.reset();
             m_img_reader.reset();
         }
-        m_accelerometer.reset();
+        m_sensors.reset();
         if constexpr(__ncv_logging_enabled)
             _log_android(::utilities::log_level::info) << "Vulkan engine has been stopped.";
         return;
     }
 
+    template<typename T>
+    inline void vulkan<T>::suspend_engine()
+    {
+        // Pause the repeating request but keep the camera session and image reader open, the sensors
+        // registered with the looper and the Vulkan device with all of its window independent resources.
+
+        this->m_rendering = false;
+
+        if constexpr(std::is_same<decltype(m_context), ::graphics::complex_context>())
+        {
+            if(m_camera)
+                m_camera->stop_capturing();
+            m_context.suspend_graphics();
+        }
+        else if constexpr(std::is_same<decltype(m_context), ::graphics::simple_context>())
+        {
+            m_context.suspend_graphics();
+        }
+
+        m_sensors->disable();
+
+        if constexpr(__ncv_logging_enabled)
+            _log_android(::utilities::log_level::info) << "Vulkan engine has been suspended.";
+    }
+
+    template<typename T>
+    inline bool vulkan<T>::resume_engine()
+    {
+        // The image reader still holds the last acquired frame, so the first frame after resume is rendered
+        // without waiting for the camera.
+
+        if constexpr(std::is_same<decltype(m_context), ::graphics::complex_context>())
+        {
+            if(this->m_cam_permission)
+            {
+                if(!m_camera || !m_camera->is_available())
+                {
+                    if constexpr(__ncv_logging_enabled)
+                        _log_android(::utilities::log_level::info) << "Camera lost while suspended, restarting.";
+                    return false;
+                }
+
+                m_camera->start_capturing();
+                m_context.initialize_graphics(this->m_app, m_img_reader->get_latest_buffer());
+            }
+            else
+                m_context.initialize_graphics(this->m_app);
+        }
+        else if constexpr(std::is_same<decltype(m_context), ::graphics::simple_context>())
+        {
+            m_context.initialize_graphics(this->m_app);
+        }
+
+        reset_frame_counters();
+
+        this->m_rendering = true;
+
+        m_sensors->enable();
+
+        if constexpr(__ncv_logging_enabled)
+            _log_android(::utilities::log_level::info) << "Vulkan engine has been resumed.";
+
+        return true;
+    }
+
+    template<typename T>
+    inline void vulkan<T>::reset_frame_counters()
+    {
+        if constexpr(__ncv_profiling_enabled)
+        {
+            m_time_pt = std::chrono::high_resolution_clock::now();
+            m_frames_processed = 0;
+        }
+    }
+
     template<typename T>
     std::chrono::time_point<std::chrono::high_resolution_clock> vulkan<T>::m_time_pt =
         std::chrono::high_resolution_clock::now();
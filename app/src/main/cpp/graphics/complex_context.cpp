@@ -17,17 +17,30 @@
 
 #include <graphics/complex_context.hpp>
 #include <graphics/pipeline.hpp>
+#include <graphics/pipeline_registry.hpp>
 
 #include <graphics/resources/image.hpp>
 #include <graphics/resources/buffer.hpp>
+#include <graphics/resources/upload_manager.hpp>
+#include <graphics/resources/deletion_queue.hpp>
 
-#include <graphics/data/index.hpp>
 #include <graphics/data/model_view_projection.hpp>
 #include <graphics/data/vertex.hpp>
+#include <graphics/data/compact_vertex.hpp>
+#include <graphics/data/geometry.hpp>
+#include <graphics/data/mesh.hpp>
+#include <graphics/data/asset_pack.hpp>
 #include <graphics/data/texture.hpp>
+#include <graphics/data/texture_loader.hpp>
+
+#include <graphics/shaders/reflection.hpp>
+#include <graphics/shaders/spirv.hpp>
 
 #include <android_native_app_glue.h>
 
+#include <algorithm>
+#include <cstring>
+
 using namespace ::std;
 using namespace ::vk;
 using namespace ::utilities;
@@ -35,12 +48,32 @@ using namespace ::metadata;
 
 namespace graphics
 {
+    // The vertex stage is fed straight from data::compact_vertex, a mismatch would otherwise only show up as
+    // garbage on screen.
+
+    static_assert(shaders::matches_vertex_layout<data::vertex_layout<data::compact_vertex>>(
+        shaders::reflect(shaders::simple_vert, size(shaders::simple_vert))),
+        "simple.vert inputs do not match the layout of data::compact_vertex.");
+
+    // Both stages end up in one descriptor set layout, shared bindings must be declared identically.
+
+    static_assert(shaders::compatible_bindings(shaders::reflect(shaders::simple_vert, size(shaders::simple_vert)),
+        shaders::reflect(shaders::mapping_frag, size(shaders::mapping_frag))),
+        "simple.vert and mapping.frag declare a shared descriptor binding differently.");
+
     complex_context::complex_context(const string &a_app_name) : vulkan_context{}
     {
         using ::vk_util::message_callback;
 
         m_ref_time = std::chrono::high_resolution_clock::now();
 
+        m_pivot_tilt = glm::angleAxis(glm::radians(28.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+        m_pivot_node = m_scene.add_node();
+        m_scene.set(m_pivot_node, glm::vec3(0.04f, 0.0f, 0.0f), m_pivot_tilt, glm::vec3(1.0f));
+        m_cube_node = m_scene.add_node(m_pivot_node);
+        m_scene.set(m_cube_node, glm::vec3(0.0f), glm::angleAxis(glm::radians(-90.0f), glm::vec3(0.0f, 0.0f, 1.0f)),
+            glm::vec3(0.325f));
+
         // Create an instance and query for physical devices
 
         if (m_enable_validation)
@@ -108,6 +141,9 @@ namespace graphics
 
     complex_context::~complex_context()
     {
+        // Decodes still running would call back into a half destroyed context
+
+        m_texture_loader.reset();
         m_device->waitIdle();
 
         if(is_initialized)
@@ -117,11 +153,14 @@ namespace graphics
             m_samplers.clear();
             m_device->destroyDescriptorPool(m_desc_pool.release());
             m_uniform_data.clear();
-            m_graphics_pipeline.reset();
+            for(auto& variant : m_pipelines)
+                variant.reset();
+            m_pipeline_registry.reset();
             m_texture_data.reset();
             m_camera_image.reset();
             m_vertex_data.reset();
             m_index_data.reset();
+            m_index32_data.reset();
             release_rendering_resources();
             m_device->destroyRenderPass(m_render_pass);
             for(auto& semaphore : m_proc_semaphores)
@@ -142,10 +181,63 @@ namespace graphics
         if(m_enable_validation && !!m_debug_msg)
             m_instance->destroyDebugUtilsMessengerEXT(m_debug_msg);
 
+        m_deletions.reset();
+        m_uploads.reset();
+        m_allocator.reset();
         m_device.release().destroy();
         m_instance.release().destroy();
     }
 
+    void complex_context::log_memory_footprint()
+    {
+        auto info = log_level::info;
+        auto logger = ::vk_util::logger{box_width, col_width + 9, info};
+        auto cc = align::ccenter;
+        auto bytes = [](DeviceSize a_size){ return to_string(a_size) + " B"; };
+
+        DeviceSize uniform_total = 0;
+
+        auto index_size = m_index_data ? m_index_data->memory_size() :
+            m_index32_data ? m_index32_data->memory_size() : 0;
+        auto texture_size = m_texture_data ? m_texture_data->memory_size() : 0;
+        auto depth_size = m_depth_buffer ? m_depth_buffer->memory_size() : 0;
+        auto camera_size = m_camera_image ? m_camera_image->memory_size() : 0;
+        auto vertex_size = m_vertex_data ? m_vertex_data->memory_size() : 0;
+        auto staging_size = m_uploads->get_resident_size();
+
+        for(auto& uniform : m_uniform_data)
+            uniform_total += uniform->memory_size();
+
+        auto host_total = staging_size + uniform_total;
+        auto device_total = vertex_size + index_size + texture_size + depth_size + camera_size;
+
+        auto mem_stats = m_allocator->get_statistics();
+
+        logger.box_top();
+        logger.write_line("MEMORY FOOTPRINT", cc);
+        logger.box_separator();
+        logger.write_line("Host", cc);
+        logger.write_line("‾‾‾‾", cc);
+        logger.write_line_2col("  Staging ring:", bytes(staging_size).c_str());
+        logger.write_line_2col("  Uniform buffers:", bytes(uniform_total).c_str());
+        logger.write_line_2col("  Total:", bytes(host_total).c_str());
+        logger.box_separator();
+        logger.write_line("Device", cc);
+        logger.write_line("‾‾‾‾‾‾", cc);
+        logger.write_line_2col("  Vertex buffer:", bytes(vertex_size).c_str());
+        logger.write_line_2col("  Index buffer:", bytes(index_size).c_str());
+        logger.write_line_2col("  Texture:", bytes(texture_size).c_str());
+        logger.write_line_2col("  Depth buffer:", bytes(depth_size).c_str());
+        logger.write_line_2col("  Camera image (imported):", bytes(camera_size).c_str());
+        logger.write_line_2col("  Total:", bytes(device_total).c_str());
+        logger.box_separator();
+        logger.write_line("Allocator", cc);
+        logger.write_line("‾‾‾‾‾‾‾‾‾", cc);
+        logger.write_line_2col("  Reserved:", bytes(mem_stats.reserved_bytes).c_str());
+        logger.write_line_2col("  Used:", bytes(mem_stats.used_bytes).c_str());
+        logger.box_bottom();
+    }
+
     void complex_context::reset_surface(ANativeWindow* a_window)
     {
         // Create a presentation surface or reset existing one
@@ -229,6 +321,54 @@ namespace graphics
         dev_features.pNext = &ycbcr_features;
         dev_features.features.samplerAnisotropy = true;
 
+        // Both are only used by the optional extensions below
+
+        auto available = m_gpu.enumerateDeviceExtensionProperties();
+        [[maybe_unused]] auto is_available = [&available](const char* a_name) {
+            return any_of(available.begin(), available.end(),
+                [a_name](const ExtensionProperties& a_props) { return strcmp(a_props.extensionName, a_name) == 0; });
+        };
+        [[maybe_unused]] auto request = [this](const char* a_extension) {
+            if(none_of(m_requested_dev_extensions.begin(), m_requested_dev_extensions.end(),
+                [a_extension](const char* a_name) { return strcmp(a_name, a_extension) == 0; }))
+                m_requested_dev_extensions.push_back(a_extension);
+        };
+
+        // Upload sources kept alive by an owner are imported in place instead of staged (upload_manager::enqueue).
+        // Opt in with NCV_HOST_IMPORT, the path still has to be proven on devices exposing the extension.
+
+#ifdef NCV_HOST_IMPORT_ENABLED
+        auto host_import = is_available(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+
+        if(host_import)
+            request(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+#else
+        auto host_import = false;
+#endif
+
+#if defined(VK_EXT_host_image_copy) && defined(NCV_HOST_IMAGE_COPY_ENABLED)
+        // Textures are written straight from host memory where the device allows it (upload_manager::host_copy).
+        // Opt in with NCV_HOST_IMAGE_COPY, for the same reason.
+
+        PhysicalDeviceHostImageCopyFeaturesEXT host_copy_features;
+
+        auto host_copy_extensions = {VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME, VK_KHR_COPY_COMMANDS_2_EXTENSION_NAME,
+            VK_KHR_FORMAT_FEATURE_FLAGS_2_EXTENSION_NAME};
+
+        auto host_copy = all_of(host_copy_extensions.begin(), host_copy_extensions.end(), is_available) &&
+            m_gpu.getFeatures2<PhysicalDeviceFeatures2, PhysicalDeviceHostImageCopyFeaturesEXT>()
+                .get<PhysicalDeviceHostImageCopyFeaturesEXT>().hostImageCopy;
+
+        if(host_copy)
+        {
+            host_copy_features.hostImageCopy = true;
+            ycbcr_features.pNext = &host_copy_features;
+
+            for(auto extension : host_copy_extensions)
+                request(extension);
+        }
+#endif
+
         DeviceCreateInfo dev_info;
 
         dev_info.pNext = &dev_features;
@@ -248,9 +388,27 @@ namespace graphics
 
         VULKAN_HPP_DEFAULT_DISPATCHER.init(m_device.get());
 
+        m_allocator = make_unique<resources::memory_allocator>(m_gpu, m_device);
+        m_deletions = make_unique<resources::deletion_queue>();
+        m_uploads = make_unique<resources::upload_manager>(*m_allocator, m_pres_queue, m_qfam_index);
+
+#if defined(VK_EXT_host_image_copy) && defined(NCV_HOST_IMAGE_COPY_ENABLED)
+        if(host_copy)
+            m_uploads->enable_host_image_copy();
+#endif
+
+        if(host_import)
+            m_uploads->enable_host_import();
+
         if constexpr(__ncv_logging_enabled)
         {
             _log_android(log_level::info) << "Logical device created with success.";
+            _log_android(log_level::info) << "Unified memory: " << (m_allocator->is_unified() ?
+                "yes, device local buffers are written in place." : "no, device local buffers are staged.");
+            _log_android(log_level::info) << "Host image copy: " << (m_uploads->is_host_image_copy_enabled() ?
+                "yes, textures are written from host memory." : "no, textures are staged.");
+            _log_android(log_level::info) << "Host memory import: " << (m_uploads->is_host_import_enabled() ?
+                "yes, aligned to " + to_string(m_uploads->get_import_alignment()) + " bytes." : "no.");
             log_requested_logical_device_info();
         }
     }
@@ -360,23 +518,247 @@ namespace graphics
 
     void complex_context::create_data_buffers(AHardwareBuffer* a_buffer)
     {
-        m_index_data = make_shared<index_data>(m_gpu, m_device, BufferUsageFlagBits::eIndexBuffer,
-            SharingMode::eExclusive, data::index_set);
-        m_vertex_data = make_shared<vertex_data>(m_gpu, m_device, BufferUsageFlagBits::eVertexBuffer,
-            SharingMode::eExclusive, data::vertex_set);
+        // Geometry goes through the mesh path (deduplication, cache and fetch reordering, index width selection)
+
+        auto geometry = data::mesh{data::cube.vertices, data::cube.indices};
+        auto& mesh_stats = geometry.get_statistics();
+
+        if(geometry.get_index_width() == data::mesh::index_width::bits16)
+        {
+            m_index_data = make_shared<index_data>(*m_allocator, *m_deletions, *m_uploads,
+                BufferUsageFlagBits::eIndexBuffer, SharingMode::eExclusive, geometry.get_indices16());
+            m_index_type = IndexType::eUint16;
+        }
+        else
+        {
+            m_index32_data = make_shared<index32_data>(*m_allocator, *m_deletions, *m_uploads,
+                BufferUsageFlagBits::eIndexBuffer, SharingMode::eExclusive, geometry.get_indices());
+            m_index_type = IndexType::eUint32;
+        }
+
+        m_index_count = geometry.get_index_count();
+
+        m_vertex_data = make_shared<vertex_data>(*m_allocator, *m_deletions, *m_uploads,
+            BufferUsageFlagBits::eVertexBuffer, SharingMode::eExclusive,
+            data::pack_vertices<data::compact_vertex>(geometry.get_vertices()));
+
+        if constexpr(__ncv_profiling_enabled)
+        {
+            _log_android(log_level::info) << "Mesh: " << mesh_stats.source_vertices << " source vertices, "
+                << mesh_stats.unique_vertices << " unique, " << mesh_stats.triangles << " triangles, ACMR "
+                << mesh_stats.acmr_before << " -> " << mesh_stats.acmr_after << ", loaded in " << mesh_stats.load_ms
+                << " ms, optimized in " << mesh_stats.optimize_ms << " ms.";
+            _log_android(log_level::info) << "Vertex fetch footprint: " << geometry.get_vertices().size()
+                << " vertices, " << sizeof(data::compact_vertex) << " bytes per vertex ("
+                << sizeof(data::vertex_format) << " unpacked), " << m_vertex_data->data_size() << " bytes per draw.";
+            _log_android(log_level::info) << "Transform kernels: " << data::transform_batch::get_isa() << ".";
+        }
 
         if(a_buffer)
-            m_camera_image = make_shared<camera_data>(m_gpu, m_device, a_buffer);
+            m_camera_image = make_shared<camera_data>(*m_allocator, *m_deletions, a_buffer);
+
+        // A grey placeholder is sampled until the texture has been decoded off this thread
+
+        auto placeholder = data::texture{1, 1, 0xff808080};
+
+        replace_texture(upload_texture(placeholder));
+
+        if(!m_texture_loader)
+        {
+            // KTX2 formats are taken when they can be sampled with linear filtering from optimal tiling
+
+            auto gpu = m_gpu;
+            auto supported = [gpu](uint32_t a_format) {
+                auto needed = FormatFeatureFlagBits::eSampledImage | FormatFeatureFlagBits::eSampledImageFilterLinear |
+                    FormatFeatureFlagBits::eTransferDst;
+                auto features = gpu.getFormatProperties(static_cast<Format>(a_format)).optimalTilingFeatures;
+                return (features & needed) == needed;
+            };
+
+            // Assets come from the pack when it's been packaged, one by one otherwise
+
+            shared_ptr<data::asset_pack> pack;
+            auto pack_start = chrono::steady_clock::now();
+
+            try
+            {
+                pack = make_shared<data::asset_pack>(m_app->activity->assetManager, "assets.pack");
+            }
+            catch(exception const &e)
+            {
+                if constexpr(__ncv_logging_enabled)
+                    _log_android(log_level::info) << "No asset pack (" << e.what() << "), reading separate assets.";
+            }
 
-        m_stbi_data = make_shared<data::texture>(m_app->activity->assetManager, "texture.jpg");
-        auto stbi_extent = m_stbi_data->get_extent();
-        m_stbi_extent = Extent3D{stbi_extent.width, stbi_extent.height, stbi_extent.depth};
+            if constexpr(__ncv_profiling_enabled)
+                if(pack)
+                    _log_android(log_level::info) << "Asset pack mapped in " << chrono::duration<double, milli>(
+                        chrono::steady_clock::now() - pack_start).count() << " ms, " << pack->get_entry_count()
+                        << " entries in " << pack->get_size() << " bytes.";
 
-        m_texture_data = make_shared<texture_data>(m_gpu, m_device, ImageUsageFlagBits::eSampled,
-            SharingMode::eExclusive, m_stbi_extent, Format::eR8G8B8A8Srgb, m_stbi_data->get_data());
+            m_texture_loader = make_unique<data::texture_loader>(m_app->activity->assetManager, supported, pack);
+        }
+
+        // Compressed levels from the KTX2 file when present, the JPEG decoded and mipmapped here otherwise
+
+        load_texture({"texture.ktx2", "texture.jpg"});
+
+        // Geometry and placeholder leave in a single transfer batch, frames submitted later on the same queue
+        // see them through the batch's closing barriers.
+
+        m_loading_batch = m_uploads->flush();
 
         if constexpr(__ncv_logging_enabled)
             _log_android(log_level::debug) << "Buffers created with success. Data Loaded.";
+
+        if constexpr(__ncv_profiling_enabled)
+        {
+            auto mem_stats = m_allocator->get_statistics();
+
+            _log_android(log_level::info) << "Device memory: " << mem_stats.device_allocations
+                << " driver allocations (" << mem_stats.blocks << " blocks, " << mem_stats.dedicated_allocations
+                << " dedicated) serving " << mem_stats.sub_allocations << " sub-allocations, "
+                << mem_stats.used_bytes << " of " << mem_stats.reserved_bytes << " bytes used, fragmentation "
+                << mem_stats.fragmentation << ".";
+
+            auto upload_stats = m_uploads->get_statistics();
+
+            _log_android(log_level::info) << "Uploads: " << upload_stats.uploads << " regions, " << upload_stats.bytes
+                << " bytes in " << upload_stats.batches << " batches through a " << m_uploads->get_ring_size()
+                << " byte staging ring, " << upload_stats.ring_stalls << " stalls, " << upload_stats.host_copies
+                << " host copies (" << upload_stats.host_bytes << " bytes), " << upload_stats.imports
+                << " host imports (" << upload_stats.imported_bytes << " bytes read in place).";
+        }
+    }
+
+    void complex_context::load_texture(vector<string> a_candidates)
+    {
+        if(a_candidates.empty())
+            return;
+
+        auto filename = a_candidates.front();
+
+        a_candidates.erase(a_candidates.begin());
+
+        // Images that can be host copied are created and written by the worker that decoded them, the rest are
+        // uploaded through the staging ring from this thread once polled.
+
+        auto prepared = make_shared<shared_ptr<texture_data>>();
+
+        auto after_decode = [this, prepared](data::texture& a_texture)
+        {
+            auto usage = ImageUsageFlagBits::eTransferDst | ImageUsageFlagBits::eSampled;
+
+            if(!m_uploads->get_host_copy_usage(static_cast<Format>(a_texture.get_format()), usage))
+                return;
+
+            auto start = chrono::steady_clock::now();
+
+            *prepared = upload_texture(a_texture);
+
+            if constexpr(__ncv_profiling_enabled)
+                _log_android(log_level::info) << "Texture host copied on its worker in " <<
+                    chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() << " ms.";
+        };
+
+        m_texture_loader->load(filename, [this, filename, a_candidates, prepared](shared_ptr<data::texture> a_texture,
+            exception_ptr a_error)
+        {
+            if(a_error)
+            {
+                try
+                {
+                    rethrow_exception(a_error);
+                }
+                catch(exception const &e)
+                {
+                    if constexpr(__ncv_logging_enabled)
+                        _log_android(a_candidates.empty() ? log_level::error : log_level::info) << "Texture "
+                            << filename << " not loaded (" << e.what() << "), "
+                            << (a_candidates.empty() ? "keeping placeholder." : "trying next candidate.");
+                }
+
+                load_texture(a_candidates);
+                return;
+            }
+
+            if constexpr(__ncv_profiling_enabled)
+            {
+                auto extent = a_texture->get_extent();
+                auto megapixels = static_cast<double>(extent.width) * extent.height / 1e6;
+
+                _log_android(log_level::info) << "Texture " << filename << " loaded: " << extent.width << "x"
+                    << extent.height << " in " << a_texture->get_decode_ms() << " ms (" << megapixels * 1e3 /
+                    a_texture->get_decode_ms() << " MP/s) on one of " << m_texture_loader->get_thread_count()
+                    << " workers.";
+            }
+
+            replace_texture(*prepared ? *prepared : upload_texture(*a_texture));
+
+            if constexpr(__ncv_profiling_enabled)
+                _log_android(log_level::info) << "Texture uploaded with " << m_texture_data->get_mip_levels()
+                    << " mip levels in format " << to_string(static_cast<Format>(a_texture->get_format())) << ", "
+                    << m_texture_data->memory_size() << " bytes of device memory, "
+                    << (*prepared ? "host copied." : "staged.");
+        }, after_decode);
+    }
+
+    shared_ptr<complex_context::texture_data> complex_context::upload_texture(data::texture &a_texture)
+    {
+        auto extent = a_texture.get_extent();
+        auto image_extent = Extent3D{extent.width, extent.height, extent.depth};
+
+        auto format = static_cast<Format>(a_texture.get_format());
+        auto& levels = a_texture.get_levels();
+
+        // Decoded images get their chain generated, stored chains are uploaded as they are
+
+        shared_ptr<texture_data> uploaded;
+
+        // Host import takes anonymous host allocations only, file mapped levels are staged through the ring
+
+        shared_ptr<const void> owner;
+
+        if(!a_texture.is_file_mapped())
+            owner = a_texture.get_owner();
+
+        if(levels.size() == 1 && format == Format::eR8G8B8A8Srgb)
+            uploaded = make_shared<texture_data>(*m_allocator, *m_deletions, *m_uploads, ImageUsageFlagBits::eSampled,
+                SharingMode::eExclusive, image_extent, format, a_texture.get_data(), true, owner);
+        else
+        {
+            vector<utilities::span<const data::stbi_uc>> level_data;
+
+            for(size_t i = 0; i < levels.size(); ++i)
+                level_data.push_back(a_texture.get_level(i));
+
+            uploaded = make_shared<texture_data>(*m_allocator, *m_deletions, *m_uploads, ImageUsageFlagBits::eSampled,
+                SharingMode::eExclusive, image_extent, format, level_data, owner);
+        }
+
+        // The staging ring took its own copy of the data at enqueue time, host copies are done already, and
+        // imported uploads hold their own reference until their batch completes
+
+        a_texture.release();
+
+        return uploaded;
+    }
+
+    void complex_context::replace_texture(shared_ptr<texture_data> a_texture)
+    {
+        // The previous image goes to the deletion queue, frames still sampling it complete first. Host copied
+        // images have no batch to wait for.
+
+        m_texture_data = move(a_texture);
+
+        if(auto ticket = m_texture_data->get_ticket())
+            m_loading_batch = ticket;
+
+        // Descriptors are written right before each frame is recorded, and uploads are flushed ahead of the
+        // frame's submission, so the new view can be swapped in right away.
+
+        for(auto& config : m_desc_configs[static_cast<size_t>(sampling_mode::texture)])
+            config.image_infos[0].imageView = m_texture_data->get_img_view();
     }
 
     void complex_context::create_graphics_pipeline()
@@ -385,23 +767,54 @@ namespace graphics
 
         // Create graphics pipeline
 
-        auto glpipe_params = pipeline::parameters{
-            m_app->activity->assetManager,
-            m_device.get(),
-            surf_caps.currentExtent,
-            m_render_pass,
-            m_camera_image != nullptr ? m_camera_image->get_sampler() : nullptr
-        };
+        // Build every variant upfront, switching the image source is then just a different bind. The camera
+        // variant needs the immutable YCbCr sampler, so it only exists once a camera image has been imported.
+        // Variants share their modules through the registry and only differ in the specialization constant.
 
-        auto glpipe_shader_info = pipeline::shaders_info{
-            "simple.vert",
-            m_camera_image != nullptr ? "camera-mapping.frag" : "image-mapping.frag"
-        };
+        if(!m_pipeline_registry)
+            m_pipeline_registry = make_unique<pipeline_registry>(m_device.get());
+
+        vector<pipeline_registry::request> manifest;
 
-        m_graphics_pipeline.reset(new pipeline(glpipe_params, glpipe_shader_info));
+        for(size_t mode = 0; mode < sampling_mode_count; ++mode)
+        {
+            bool camera_mode = static_cast<sampling_mode>(mode) == sampling_mode::camera;
+
+            if(camera_mode && m_camera_image == nullptr)
+                continue;
+
+            manifest.push_back({
+                pipeline::shaders_info{
+                    "simple.vert",
+                    "mapping.frag",
+                    {},
+                    pipeline::specialization{}.set(0, static_cast<uint32_t>(mode))
+                },
+                surf_caps.currentExtent,
+                m_render_pass,
+                camera_mode ? m_camera_image->get_sampler() : nullptr,
+                data::make_vertex_input<data::compact_vertex>()
+            });
+        }
+
+        m_pipeline_registry->prewarm(manifest);
+
+        for(size_t mode = 0, entry = 0; mode < sampling_mode_count; ++mode)
+        {
+            bool camera_mode = static_cast<sampling_mode>(mode) == sampling_mode::camera;
+
+            if(camera_mode && m_camera_image == nullptr)
+                continue;
+
+            m_pipelines[mode] = m_pipeline_registry->get(manifest[entry++]);
+        }
+
+        // Variants of an earlier build (previous render pass or extent) are no longer referenced
+
+        m_pipeline_registry->trim();
 
         if constexpr(__ncv_logging_enabled)
-            _log_android(log_level::debug) << "Graphics pipeline created with success.";
+            _log_android(log_level::debug) << "Graphics pipeline variants created with success.";
     }
 
     void complex_context::reset_swapchain()
@@ -470,8 +883,8 @@ namespace graphics
             m_swapchain_img_views.push_back(m_device->createImageView(img_view_info));
         }
 
-        m_depth_buffer = make_shared<depth_data>(m_gpu, m_device, ImageUsageFlagBits::eDepthStencilAttachment,
-            SharingMode::eExclusive, m_surface_extent);
+        m_depth_buffer = make_shared<depth_data>(*m_allocator, *m_deletions,
+            ImageUsageFlagBits::eDepthStencilAttachment, SharingMode::eExclusive, m_surface_extent);
 
         // Create framebuffers
         for(auto& image_view : m_swapchain_img_views)
@@ -513,6 +926,7 @@ namespace graphics
             for(auto& fence : m_cmd_fences)
                 m_device->destroyFence(fence);
             m_cmd_fences.clear();
+            m_frame_stamps.clear();
             m_device->freeCommandBuffers(m_cmd_pool.get(), m_cmd_buffers);
             m_cmd_buffers.clear();
             m_device->destroyCommandPool(m_cmd_pool.release());
@@ -551,6 +965,8 @@ namespace graphics
             m_pres_semaphores.push_back(m_device->createSemaphore(semaphore_info));
         }
 
+        m_frame_stamps.assign(m_cmd_buffers.size(), 0);
+
         if constexpr(__ncv_logging_enabled)
             _log_android(log_level::debug) << "Command buffers and sync resources created with success.";
     }
@@ -566,37 +982,38 @@ namespace graphics
             m_samplers.clear();
             m_device->destroyDescriptorPool(m_desc_pool.release());
             m_uniform_data.clear();
+            m_mvp_data.clear();
         }
 
-        // Create or reset descriptor pool
+        // New uniform buffers start from the initial model, they need every node
+
+        m_scene_pending.assign(m_cmd_buffers.size(), data::scene_graph::dirty_range::all(m_scene.size()));
 
-        m_desc_configs = vector<descriptor_configuration>(m_cmd_buffers.size());
+        // Create or reset descriptor pool, one set per swapchain image for every available pipeline variant
+
+        uint32_t variant_count = 0;
+
+        for(auto& variant : m_pipelines)
+            if(variant)
+                variant_count++;
+
+        uint32_t set_count = m_cmd_buffers.size() * variant_count;
 
         array<DescriptorPoolSize, 2> pool_sizes;
 
         pool_sizes[0].type = DescriptorType::eUniformBuffer;
-        pool_sizes[0].descriptorCount = m_cmd_buffers.size();
+        pool_sizes[0].descriptorCount = set_count;
         pool_sizes[1].type = DescriptorType::eCombinedImageSampler;
-        pool_sizes[1].descriptorCount = m_cmd_buffers.size() * m_desc_configs[0].writes.size();
+        pool_sizes[1].descriptorCount = set_count;
 
         DescriptorPoolCreateInfo pool_info;
 
         pool_info.poolSizeCount = pool_sizes.size();
         pool_info.pPoolSizes = pool_sizes.data();
-        pool_info.maxSets = m_cmd_buffers.size();
+        pool_info.maxSets = set_count;
 
         m_desc_pool.reset(m_device->createDescriptorPool(pool_info));
 
-        vector<DescriptorSetLayout> desc_layouts(m_cmd_buffers.size(), m_graphics_pipeline->get_desc_set());
-
-        DescriptorSetAllocateInfo desc_set_alloc_info;
-
-        desc_set_alloc_info.descriptorPool = m_desc_pool.get();
-        desc_set_alloc_info.descriptorSetCount = m_cmd_buffers.size();
-        desc_set_alloc_info.pSetLayouts = desc_layouts.data();
-
-        m_desc_sets = m_device->allocateDescriptorSets(desc_set_alloc_info);
-
         SamplerCreateInfo sampler_info;
 
         sampler_info.magFilter = Filter::eLinear;
@@ -613,49 +1030,75 @@ namespace graphics
         sampler_info.mipmapMode = SamplerMipmapMode::eLinear;
         sampler_info.mipLodBias = 0.0f;
         sampler_info.minLod = 0.0f;
-        sampler_info.maxLod = 0.0f;
 
-        data::model_view_projection mvp =
-            static_cast<float>(m_surface_extent.height) / static_cast<float>(m_surface_extent.width);
+        // Textures are replaced at runtime with varying chain lengths, the view bounds the levels in reach
+
+        sampler_info.maxLod = VK_LOD_CLAMP_NONE;
 
         for(uint32_t i = 0; i < m_cmd_buffers.size(); ++i)
         {
             m_samplers.push_back(m_device->createSampler(sampler_info));
             m_mvp_data.push_back(static_cast<float>(m_surface_extent.height) /
                 static_cast<float>(m_surface_extent.width));
-            m_uniform_data.push_back(make_shared<uniform_data>(m_gpu, m_device,
+            m_uniform_data.push_back(make_shared<uniform_data>(*m_allocator, *m_deletions,
                 BufferUsageFlagBits::eUniformBuffer, SharingMode::eExclusive, vector{m_mvp_data.back()}));
-            m_desc_configs[i].buffer_infos[0].buffer = m_uniform_data.back()->get();
-            m_desc_configs[i].buffer_infos[0].offset = 0;
-            m_desc_configs[i].buffer_infos[0].range = VK_WHOLE_SIZE;
+        }
 
-            if(m_camera_image != nullptr)
-            {
-                m_desc_configs[i].image_infos[0].imageLayout = ImageLayout::eShaderReadOnlyOptimal;
-                m_desc_configs[i].image_infos[0].imageView = m_camera_image->get_img_view();
-                m_desc_configs[i].image_infos[0].sampler = m_camera_image->get_sampler();
-            }
-            else
-            {
-                m_desc_configs[i].image_infos[0].imageLayout = ImageLayout::eShaderReadOnlyOptimal;
-                m_desc_configs[i].image_infos[0].imageView = m_texture_data->get_img_view();
-                m_desc_configs[i].image_infos[0].sampler = m_samplers.back();
-            }
+        for(size_t mode = 0; mode < sampling_mode_count; ++mode)
+        {
+            auto& configs = m_desc_configs[mode];
+
+            configs.clear();
+            m_desc_sets[mode].clear();
+
+            if(!m_pipelines[mode])
+                continue;
+
+            configs = vector<descriptor_configuration>(m_cmd_buffers.size());
+
+            vector<DescriptorSetLayout> desc_layouts(m_cmd_buffers.size(), m_pipelines[mode]->get_desc_set());
+
+            DescriptorSetAllocateInfo desc_set_alloc_info;
 
-            m_desc_configs[i].writes[0].dstSet = m_desc_sets[i];
-            m_desc_configs[i].writes[0].dstBinding = 0;
-            m_desc_configs[i].writes[0].dstArrayElement = 0;
-            m_desc_configs[i].writes[0].descriptorType = DescriptorType::eUniformBuffer;
-            m_desc_configs[i].writes[0].descriptorCount = 1;
-            m_desc_configs[i].writes[0].pBufferInfo = &m_desc_configs[i].buffer_infos[0];
+            desc_set_alloc_info.descriptorPool = m_desc_pool.get();
+            desc_set_alloc_info.descriptorSetCount = m_cmd_buffers.size();
+            desc_set_alloc_info.pSetLayouts = desc_layouts.data();
 
-            m_desc_configs[i].writes[1].dstSet = m_desc_sets[i];
-            m_desc_configs[i].writes[1].dstBinding = 1;
-            m_desc_configs[i].writes[1].dstArrayElement = 0;
-            m_desc_configs[i].writes[1].descriptorType = DescriptorType::eCombinedImageSampler;
-            m_desc_configs[i].writes[1].descriptorCount = 1;
-            m_desc_configs[i].writes[1].pImageInfo = &m_desc_configs[i].image_infos[0];
+            m_desc_sets[mode] = m_device->allocateDescriptorSets(desc_set_alloc_info);
 
+            for(uint32_t i = 0; i < m_cmd_buffers.size(); ++i)
+            {
+                configs[i].buffer_infos[0].buffer = m_uniform_data[i]->get();
+                configs[i].buffer_infos[0].offset = 0;
+                configs[i].buffer_infos[0].range = VK_WHOLE_SIZE;
+
+                if(static_cast<sampling_mode>(mode) == sampling_mode::camera)
+                {
+                    configs[i].image_infos[0].imageLayout = ImageLayout::eShaderReadOnlyOptimal;
+                    configs[i].image_infos[0].imageView = m_camera_image->get_img_view();
+                    configs[i].image_infos[0].sampler = m_camera_image->get_sampler();
+                }
+                else
+                {
+                    configs[i].image_infos[0].imageLayout = ImageLayout::eShaderReadOnlyOptimal;
+                    configs[i].image_infos[0].imageView = m_texture_data->get_img_view();
+                    configs[i].image_infos[0].sampler = m_samplers[i];
+                }
+
+                configs[i].writes[0].dstSet = m_desc_sets[mode][i];
+                configs[i].writes[0].dstBinding = 0;
+                configs[i].writes[0].dstArrayElement = 0;
+                configs[i].writes[0].descriptorType = DescriptorType::eUniformBuffer;
+                configs[i].writes[0].descriptorCount = 1;
+                configs[i].writes[0].pBufferInfo = &configs[i].buffer_infos[0];
+
+                configs[i].writes[1].dstSet = m_desc_sets[mode][i];
+                configs[i].writes[1].dstBinding = 1;
+                configs[i].writes[1].dstArrayElement = 0;
+                configs[i].writes[1].descriptorType = DescriptorType::eCombinedImageSampler;
+                configs[i].writes[1].descriptorCount = 1;
+                configs[i].writes[1].pImageInfo = &configs[i].image_infos[0];
+            }
         }
 
         if constexpr(__ncv_logging_enabled)
@@ -673,31 +1116,69 @@ namespace graphics
         for(uint32_t i = 0; i < m_uniform_data.size(); ++i)
         {
             m_mvp_data[i].set_camera_y(y);
-            m_uniform_data[i]->update(vector{m_mvp_data[i]});
+            m_uniform_data[i]->update(m_mvp_data[i]);
         }
     }
 
     void complex_context::release_rendering_resources()
     {
+        // The frame fences don't cover a present still in flight, which reads the swapchain image and waits on
+        // the render semaphore. This only runs on window teardown or resize, so the device is drained instead.
+        // Everything retired by earlier frames goes with it.
+
         m_device->waitIdle();
-        
+
+        m_deletions->collect(m_deletions->get_current() - 1);
+
         for(auto& framebuffer : m_framebuffers)
-        {
             m_device->destroyFramebuffer(framebuffer);
-            m_device->waitIdle();
-        }
         m_framebuffers.clear();
         m_depth_buffer.reset();
         for(auto& image_view : m_swapchain_img_views)
-        {
             m_device->destroyImageView(image_view);
-            m_device->waitIdle();
-        }
         m_swapchain_img_views.clear();
         m_device->destroySwapchainKHR(m_swap_chain.release());
         m_instance->destroySurfaceKHR(m_surface.release());
     }
 
+    void complex_context::latch_transform(uint32_t a_index)
+    {
+        m_latch_time = chrono::steady_clock::now();
+
+        auto elapsed = chrono::duration_cast<chrono::nanoseconds>(m_latch_time - m_ref_time);
+        auto angle = (static_cast<float>(elapsed.count() % 3600000000) / 3.6e+9f) * 360.0f;
+
+        m_scene.set_rotation(m_cube_node, glm::angleAxis(glm::radians(angle), glm::vec3(1.0f, 0.0f, 0.0f)) *
+            glm::angleAxis(glm::radians(-90.0f), glm::vec3(0.0f, 0.0f, 1.0f)));
+
+        // The pivot counters the device's rotation since the first sample, keeping the cube fixed in the world
+
+        if(m_orientation_source)
+        {
+            auto orientation = m_orientation_source();
+
+            if(!m_orientation_ref)
+                m_orientation_ref = glm::inverse(orientation);
+
+            m_scene.set_rotation(m_pivot_node, glm::inverse(*m_orientation_ref * orientation) * m_pivot_tilt);
+        }
+
+        auto changed = m_scene.update();
+
+        for(auto& pending : m_scene_pending)
+            pending.merge(changed);
+
+        auto& pending = m_scene_pending[a_index];
+
+        if(pending.contains(m_cube_node))
+        {
+            m_mvp_data[a_index].m_model = m_scene.get_world(m_cube_node);
+            m_uniform_data[a_index]->update(m_mvp_data[a_index]);
+        }
+
+        pending.clear();
+    }
+
     void complex_context::initialize_graphics(android_app *a_app, AHardwareBuffer* a_buffer)
     {
         m_app = a_app;
@@ -730,17 +1211,38 @@ namespace graphics
         is_initialized = true;
     }
 
+    void complex_context::suspend_graphics()
+    {
+        // Only the window bound objects are released. Device, pipeline, data buffers and descriptors are kept
+        // so that the next initialize_graphics merely recreates the surface and swapchain.
+
+        if(is_initialized)
+            release_rendering_resources();
+
+        if constexpr(__ncv_logging_enabled)
+            _log_android(log_level::debug) << "Graphics suspended, window bound resources released.";
+    }
+
     void complex_context::render_frame(const std::any& a_params, AHardwareBuffer* a_buffer)
     {
         glm::vec4 a_rgba = any_cast<glm::vec4>(a_params);
 
+        // Without a camera variant (no camera image at initialization) camera frames can't be sampled
+
+        if(!m_pipelines[static_cast<size_t>(sampling_mode::camera)])
+            a_buffer = nullptr;
+
+        auto mode = static_cast<size_t>(a_buffer ? sampling_mode::camera : sampling_mode::texture);
+
+        auto frame_start = chrono::steady_clock::now();
+
         auto img_idx = m_device->acquireNextImageKHR(m_swap_chain.get(), UINT64_MAX,
             m_proc_semaphores[m_proc_si]);
 
         if(a_buffer)
         {
             m_camera_image->update(ImageUsageFlagBits::eSampled, SharingMode::eExclusive, a_buffer);
-            m_desc_configs[img_idx.value].image_infos[0].imageView = m_camera_image->get_img_view();
+            m_desc_configs[mode][img_idx.value].image_infos[0].imageView = m_camera_image->get_img_view();
         }
 
         CommandBufferBeginInfo begin_info;
@@ -766,8 +1268,7 @@ namespace graphics
 
         DeviceSize buf_offset = 0;
 
-        vector<BufferCopy> copy_vertex_regions{{0, 0, m_vertex_data->data_size()}};
-        vector<BufferCopy> copy_index_regions{{0, 0, m_index_data->data_size()}};
+        auto index_buffer = m_index_data ? m_index_data->get() : m_index32_data->get();
 
         ImageMemoryBarrier cam_frag_barrier;
 
@@ -784,54 +1285,24 @@ namespace graphics
         cam_frag_barrier.srcAccessMask = AccessFlags{0};
         cam_frag_barrier.dstAccessMask = AccessFlagBits::eShaderRead;
 
-        ImageMemoryBarrier tex_copy_barrier;
-
-        tex_copy_barrier.oldLayout = ImageLayout::eUndefined;
-        tex_copy_barrier.newLayout = ImageLayout::eTransferDstOptimal;
-        tex_copy_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        tex_copy_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        tex_copy_barrier.image = m_texture_data->get();
-        tex_copy_barrier.subresourceRange.aspectMask = ImageAspectFlagBits::eColor;
-        tex_copy_barrier.subresourceRange.baseMipLevel = 0;
-        tex_copy_barrier.subresourceRange.levelCount = 1;
-        tex_copy_barrier.subresourceRange.baseArrayLayer = 0;
-        tex_copy_barrier.subresourceRange.layerCount = 1;
-        tex_copy_barrier.srcAccessMask = AccessFlags{0};
-        tex_copy_barrier.dstAccessMask = AccessFlagBits::eTransferWrite;
-
-        ImageMemoryBarrier tex_frag_barrier;
-
-        tex_frag_barrier.oldLayout = ImageLayout::eTransferDstOptimal;
-        tex_frag_barrier.newLayout = ImageLayout::eShaderReadOnlyOptimal;
-        tex_frag_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        tex_frag_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        tex_frag_barrier.image = m_texture_data->get();
-        tex_frag_barrier.subresourceRange.aspectMask = ImageAspectFlagBits::eColor;
-        tex_frag_barrier.subresourceRange.baseMipLevel = 0;
-        tex_frag_barrier.subresourceRange.levelCount = 1;
-        tex_frag_barrier.subresourceRange.baseArrayLayer = 0;
-        tex_frag_barrier.subresourceRange.layerCount = 1;
-        tex_frag_barrier.srcAccessMask = AccessFlagBits::eTransferWrite;
-        tex_frag_barrier.dstAccessMask = AccessFlagBits::eShaderRead;
-
-        BufferImageCopy texture_copy;
-
-        texture_copy.bufferOffset = 0;
-        texture_copy.bufferRowLength = 0;
-        texture_copy.bufferImageHeight = 0;
-        texture_copy.imageSubresource.aspectMask = ImageAspectFlagBits::eColor;
-        texture_copy.imageSubresource.mipLevel = 0;
-        texture_copy.imageSubresource.baseArrayLayer = 0;
-        texture_copy.imageSubresource.layerCount = 1;
-        texture_copy.imageOffset = Offset3D{0, 0, 0};
-        texture_copy.imageExtent = m_stbi_extent;
-
-        m_mvp_data[img_idx.value].rotate_view(m_ref_time);
-        m_uniform_data[img_idx.value]->update(vector{m_mvp_data[img_idx.value]});
+        // The uniform buffer of this image may still be read by its previous submission, so the transform
+        // is never written before the fence wait.
 
         auto wait_result = m_device->waitForFences(m_cmd_fences[img_idx.value], VK_TRUE, UINT64_MAX);
 
-        m_device->updateDescriptorSets(m_desc_configs[img_idx.value].writes, nullptr);
+        m_deletions->collect(m_frame_stamps[img_idx.value]);
+
+        // Decoded textures are uploaded from this thread, their views land in the descriptors written below
+
+        m_texture_loader->poll();
+
+        if constexpr(__ncv_profiling_enabled)
+            m_late_latching = (m_latch_frame++ / m_latch_period) % 2 == 0;
+
+        if(!m_late_latching)
+            latch_transform(img_idx.value);
+
+        m_device->updateDescriptorSets(m_desc_configs[mode][img_idx.value].writes, nullptr);
 
         m_cmd_buffers[img_idx.value].begin(begin_info);
 
@@ -841,34 +1312,20 @@ namespace graphics
                 PipelineStageFlagBits::eFragmentShader, static_cast<DependencyFlags>(0), 0, nullptr,
                 0, nullptr, 1, &cam_frag_barrier);
         }
-        else
-        {
-            m_cmd_buffers[img_idx.value].pipelineBarrier(PipelineStageFlagBits::eTopOfPipe,
-                PipelineStageFlagBits::eTransfer, static_cast<DependencyFlags>(0), 0, nullptr, 0,
-                nullptr, 1, &tex_copy_barrier);
-            m_cmd_buffers[img_idx.value].copyBufferToImage(m_texture_data->get_staging(), m_texture_data->get(),
-                ImageLayout::eTransferDstOptimal, 1, &texture_copy);
-            m_cmd_buffers[img_idx.value].pipelineBarrier(PipelineStageFlagBits::eTransfer,
-                PipelineStageFlagBits::eFragmentShader, static_cast<DependencyFlags>(0), 0, nullptr,
-                0, nullptr, 1, &tex_frag_barrier);
-        }
 
-        m_cmd_buffers[img_idx.value].copyBuffer(m_vertex_data->get_staging(), m_vertex_data->get(),
-            copy_vertex_regions);
-        m_cmd_buffers[img_idx.value].copyBuffer(m_index_data->get_staging(), m_index_data->get(),
-            copy_index_regions);
         m_cmd_buffers[img_idx.value].bindDescriptorSets(
-            PipelineBindPoint::eGraphics, m_graphics_pipeline->get_layout(), 0, m_desc_sets[img_idx.value], nullptr);
+            PipelineBindPoint::eGraphics, m_pipelines[mode]->get_layout(), 0, m_desc_sets[mode][img_idx.value],
+            nullptr);
         m_cmd_buffers[img_idx.value].beginRenderPass(render_pass_begin_info, SubpassContents::eInline);
-        m_cmd_buffers[img_idx.value].bindPipeline(PipelineBindPoint::eGraphics, m_graphics_pipeline->get());
+        m_cmd_buffers[img_idx.value].bindPipeline(PipelineBindPoint::eGraphics, m_pipelines[mode]->get());
         m_cmd_buffers[img_idx.value].bindVertexBuffers(0, 1, &m_vertex_data->get(), &buf_offset);
-        m_cmd_buffers[img_idx.value].bindIndexBuffer(m_index_data->get(), 0, IndexType::eUint16);
-        m_cmd_buffers[img_idx.value].drawIndexed(data::index_set.size(), 1, 0, 0, 0);
+        m_cmd_buffers[img_idx.value].bindIndexBuffer(index_buffer, 0, m_index_type);
+        m_cmd_buffers[img_idx.value].drawIndexed(m_index_count, 1, 0, 0, 0);
         m_cmd_buffers[img_idx.value].endRenderPass();
         m_cmd_buffers[img_idx.value].end();
 
         SubmitInfo submit_info;
-        auto wdst_mask = PipelineStageFlags(PipelineStageFlagBits::eTransfer);
+        auto wdst_mask = PipelineStageFlags(PipelineStageFlagBits::eColorAttachmentOutput);
 
         submit_info.waitSemaphoreCount = 1;
         submit_info.pWaitSemaphores = &m_proc_semaphores[m_proc_si++];
@@ -878,8 +1335,59 @@ namespace graphics
         submit_info.signalSemaphoreCount = 1;
         submit_info.pSignalSemaphores = &m_pres_semaphores[img_idx.value];
 
+        if(m_late_latching)
+            latch_transform(img_idx.value);
+
+        // Uploads enqueued since the last frame go ahead of it, completed batches give their ring space back
+
+        m_uploads->collect();
+        m_uploads->flush();
+
+        if(m_loading_batch && !m_texture_loader->get_pending() && m_uploads->is_complete(m_loading_batch) &&
+            m_uploads->trim())
+        {
+            m_loading_batch = 0;
+
+            if constexpr(__ncv_profiling_enabled)
+                log_memory_footprint();
+        }
+
         m_device->resetFences(m_cmd_fences[img_idx.value]);
         m_pres_queue.submit(submit_info, m_cmd_fences[img_idx.value]);
+        m_frame_stamps[img_idx.value] = m_deletions->advance();
+
+        if constexpr(__ncv_profiling_enabled)
+        {
+            // Age of the sampled transform at submission versus the age it would have if it had been sampled
+            // when the frame started (the early latching point).
+
+            using chrono::duration;
+            using chrono::microseconds;
+
+            auto submit_time = chrono::steady_clock::now();
+            auto latch_age = duration<double, micro>(submit_time - m_latch_time).count();
+            auto frame_age = duration<double, micro>(submit_time - frame_start).count();
+
+            auto& stats = m_latch_stats[m_late_latching];
+
+            stats.frames++;
+            stats.latch_age_us += (latch_age - stats.latch_age_us) / stats.frames;
+            stats.frame_age_us += (frame_age - stats.frame_age_us) / stats.frames;
+
+            auto& late = m_latch_stats[true];
+            auto& early = m_latch_stats[false];
+
+            _log_android(log_level::verbose) << "Transform age at submit (" << (m_late_latching ? "late" : "early")
+                << " latching): " << latch_age << " us. Avg late: " << late.latch_age_us << " us over "
+                << late.frames << " frames, avg early: " << early.latch_age_us << " us over " << early.frames
+                << " frames. Frame start to submit: " << frame_age << " us, avg " << stats.frame_age_us << " us.";
+
+            auto& scene_stats = m_scene.get_statistics();
+
+            _log_android(log_level::verbose) << "Scene: " << m_scene.size() << " nodes, " << scene_stats.updates
+                << " updates (" << scene_stats.clean_updates << " clean), " << scene_stats.locals_computed
+                << " local and " << scene_stats.worlds_computed << " world matrices computed.";
+        }
 
         PresentInfoKHR pres_info;
 
@@ -21,28 +21,46 @@
 #include <graphics/vulkan_context.hpp>
 #include <metadata/version.hpp>
 #include <graphics/data/types.hpp>
+#include <graphics/data/scene_graph.hpp>
 #include <graphics/resources/types.hpp>
 
+#include <array>
 #include <map>
 #include <any>
+#include <functional>
+#include <optional>
 
 class android_app;
 
 namespace graphics
 {
     class pipeline;
+    class pipeline_registry;
 
     class complex_context : public vulkan_context
     {
     public:
 
         typedef resources::buffer<resources::device_upload, data::index_format> index_data;
+        typedef resources::buffer<resources::device_upload, uint32_t> index32_data;
         typedef resources::buffer<resources::host, data::model_view_projection> uniform_data;
-        typedef resources::buffer<resources::device_upload, data::vertex_format> vertex_data;
+        typedef resources::buffer<resources::device_upload, data::compact_vertex> vertex_data;
         typedef resources::image<resources::external> camera_data;
         typedef resources::image<resources::device> depth_data;
         typedef resources::image<resources::device_upload, data::stbi_uc> texture_data;
 
+        // Fragment sampling modes, each backed by a pipeline variant built at initialization. Values match the
+        // sampling_mode specialization constant of mapping.frag.
+
+        enum class sampling_mode : uint32_t
+        {
+            texture = 0,
+            camera,
+            count
+        };
+
+        constexpr static size_t sampling_mode_count = static_cast<size_t>(sampling_mode::count);
+
         struct descriptor_configuration
         {
             std::array<vk::DescriptorBufferInfo, 1> buffer_infos;
@@ -54,6 +72,18 @@ namespace graphics
         ~complex_context();
         void initialize_graphics(android_app *a_app, AHardwareBuffer* a_buffer = nullptr);
         void render_frame(const std::any &a_params, AHardwareBuffer* a_buffer = nullptr);
+        void suspend_graphics();
+
+        // Device orientation, sampled when the transform is latched. The cube's pivot follows the rotation
+        // relative to the first sample, so the freshness of the input shows on screen.
+
+        using orientation_source = std::function<glm::quat()>;
+
+        void set_orientation_source(orientation_source a_source)
+        {
+            m_orientation_source = std::move(a_source);
+            m_orientation_ref.reset();
+        }
 
     protected:
 
@@ -74,6 +104,8 @@ namespace graphics
             const std::vector<vk::SurfaceFormatKHR>& a_surf_fmts,
             const std::vector<vk::PresentModeKHR>& a_pres_modes) const;
 
+        void log_memory_footprint();
+
         void reset_surface(ANativeWindow* a_window);
 
         void select_device_and_qfamily();
@@ -86,6 +118,19 @@ namespace graphics
 
         void create_data_buffers(AHardwareBuffer* a_buffer);
 
+        // Uploads a_texture and releases its data. Safe on worker threads when the upload manager can host copy
+        // the texture's format.
+
+        std::shared_ptr<texture_data> upload_texture(data::texture& a_texture);
+
+        // Makes a_texture the sampled texture
+
+        void replace_texture(std::shared_ptr<texture_data> a_texture);
+
+        // Loads the first of a_candidates that works, later ones are only tried when the earlier fail
+
+        void load_texture(std::vector<std::string> a_candidates);
+
         void reset_swapchain();
 
         void reset_framebuffer_and_zbuffer();
@@ -98,6 +143,8 @@ namespace graphics
 
         void release_rendering_resources();
 
+        void latch_transform(uint32_t a_index);
+
     private:
 
         std::vector<const char*> m_requested_gl_extensions = {
@@ -152,6 +199,10 @@ namespace graphics
         std::vector<vk::Semaphore> m_proc_semaphores;
         std::vector<vk::Semaphore> m_pres_semaphores;
 
+        // Deletion queue frame submitted last with each command buffer, its fence completing retires that frame
+
+        std::vector<uint64_t> m_frame_stamps;
+
         uint32_t m_proc_si {0};
 
         vk::RenderPass m_render_pass = nullptr;
@@ -161,29 +212,71 @@ namespace graphics
 
         vk::Extent2D m_surface_extent;
 
-        std::shared_ptr<pipeline> m_graphics_pipeline = nullptr;
+        std::unique_ptr<resources::memory_allocator> m_allocator;
+        std::unique_ptr<resources::deletion_queue> m_deletions;
+        std::unique_ptr<resources::upload_manager> m_uploads;
+
+        // Latest batch carrying startup data, the staging ring is released once it completes and no texture is
+        // left to decode
+
+        uint64_t m_loading_batch = 0;
+        std::unique_ptr<pipeline_registry> m_pipeline_registry;
+        std::array<std::shared_ptr<pipeline>, sampling_mode_count> m_pipelines;
         std::shared_ptr<vertex_data> m_vertex_data = nullptr;
         std::shared_ptr<index_data> m_index_data = nullptr;
+        std::shared_ptr<index32_data> m_index32_data = nullptr;
+        vk::IndexType m_index_type = vk::IndexType::eUint16;
+        uint32_t m_index_count = 0;
 
         std::vector<vk::Sampler> m_samplers;
         std::shared_ptr<camera_data> m_camera_image = nullptr;
         std::shared_ptr<depth_data> m_depth_buffer = nullptr;
 
-        std::shared_ptr<data::texture> m_stbi_data = nullptr;
-        vk::Extent3D m_stbi_extent;
+        std::unique_ptr<data::texture_loader> m_texture_loader;
         std::shared_ptr<texture_data> m_texture_data = nullptr;
 
         vk::UniqueDescriptorPool m_desc_pool;
-        std::vector<vk::DescriptorSet> m_desc_sets;
-        std::vector<descriptor_configuration> m_desc_configs;
+        std::array<std::vector<vk::DescriptorSet>, sampling_mode_count> m_desc_sets;
+        std::array<std::vector<descriptor_configuration>, sampling_mode_count> m_desc_configs;
 
         std::vector<data::model_view_projection> m_mvp_data;
         std::vector<std::shared_ptr<uniform_data>> m_uniform_data;
 
+        // The cube hangs off a pivot node (offset and tilt), only its own spin changes per frame. Each uniform
+        // buffer collects the scene changes it hasn't picked up yet.
+
+        data::scene_graph m_scene;
+        data::scene_graph::node_id m_pivot_node = data::scene_graph::no_parent;
+        data::scene_graph::node_id m_cube_node = data::scene_graph::no_parent;
+        std::vector<data::scene_graph::dirty_range> m_scene_pending;
+
         vk::DebugUtilsMessengerEXT m_debug_msg;
 
         std::chrono::time_point<std::chrono::steady_clock> m_ref_time;
 
+        // Late latching samples the input and writes the transform after the command buffer has been recorded,
+        // right before submission. Profiling builds switch to early latching (ahead of recording) for every
+        // other run of m_latch_period frames, so a single run logs both.
+
+        static constexpr uint64_t m_latch_period = 120;
+        bool m_late_latching = true;
+        orientation_source m_orientation_source;
+        std::optional<glm::quat> m_orientation_ref;
+        glm::quat m_pivot_tilt{1.0f, 0.0f, 0.0f, 0.0f};
+        std::chrono::time_point<std::chrono::steady_clock> m_latch_time;
+
+        // Running averages per latching mode, indexed by m_late_latching
+
+        struct latch_statistics
+        {
+            uint64_t frames = 0;
+            double latch_age_us = 0.0;
+            double frame_age_us = 0.0;
+        };
+
+        std::array<latch_statistics, 2> m_latch_stats;
+        uint64_t m_latch_frame = 0;
+
         android_app* m_app = nullptr;
     };
 
@@ -0,0 +1,237 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include <graphics/data/asset_pack.hpp>
+
+#ifdef __ANDROID__
+#include <android/asset_manager.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+namespace graphics{ namespace data{
+
+#ifdef __ANDROID__
+    asset_pack::asset_pack(AAssetManager *a_ass_mgr, const std::string &a_filename)
+    {
+        m_asset = AAssetManager_open(a_ass_mgr, a_filename.c_str(), AASSET_MODE_RANDOM);
+
+        if(!m_asset)
+            throw std::runtime_error{"Couldn't open asset pack " + a_filename + "."};
+
+        off64_t start = 0, length = 0;
+        int fd = AAsset_openFileDescriptor64(m_asset, &start, &length);
+
+        if(fd >= 0)
+        {
+            // The pack sits somewhere inside the APK, the mapping has to start on a page boundary
+
+            auto page = static_cast<off64_t>(sysconf(_SC_PAGESIZE));
+            auto lead = start % page;
+
+            m_mapping_size = static_cast<size_t>(length + lead);
+            m_mapping = mmap64(nullptr, m_mapping_size, PROT_READ, MAP_PRIVATE, fd, start - lead);
+
+            close(fd);
+
+            if(m_mapping == MAP_FAILED)
+                m_mapping = nullptr;
+            else
+            {
+                m_data = static_cast<const uint8_t*>(m_mapping) + lead;
+                m_size = static_cast<size_t>(length);
+
+                AAsset_close(m_asset);
+                m_asset = nullptr;
+            }
+        }
+
+        if(!m_data)
+        {
+            m_data = static_cast<const uint8_t*>(AAsset_getBuffer(m_asset));
+            m_size = static_cast<size_t>(AAsset_getLength64(m_asset));
+        }
+
+        try
+        {
+            if(!m_data)
+                throw std::runtime_error{"Couldn't map asset pack " + a_filename + "."};
+
+            parse();
+        }
+        catch(...)
+        {
+            release();
+            throw;
+        }
+    }
+#endif
+
+    asset_pack::asset_pack(const std::string &a_path)
+    {
+        int fd = open(a_path.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if(fd < 0)
+            throw std::runtime_error{"Couldn't open asset pack " + a_path + "."};
+
+        struct stat info{};
+
+        if(fstat(fd, &info) != 0 || info.st_size <= 0)
+        {
+            close(fd);
+            throw std::runtime_error{"Couldn't stat asset pack " + a_path + "."};
+        }
+
+        m_mapping_size = static_cast<size_t>(info.st_size);
+        m_mapping = mmap(nullptr, m_mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        // The mapping holds its own reference to the file
+
+        close(fd);
+
+        if(m_mapping == MAP_FAILED)
+        {
+            m_mapping = nullptr;
+            throw std::runtime_error{"Couldn't map asset pack " + a_path + "."};
+        }
+
+        m_data = static_cast<const uint8_t*>(m_mapping);
+        m_size = m_mapping_size;
+
+        try
+        {
+            parse();
+        }
+        catch(...)
+        {
+            release();
+            throw;
+        }
+    }
+
+    asset_pack::~asset_pack()
+    {
+        release();
+    }
+
+    utilities::span<const uint8_t> asset_pack::read(std::string_view a_name, std::vector<uint8_t> &a_storage) const
+    {
+        auto found = find(a_name);
+
+        if(!found)
+            throw std::runtime_error{"Asset " + std::string{a_name} + " is not in the pack."};
+
+        auto& info = found->info;
+        auto stored = m_data + info.offset;
+
+        if(info.method == compression::none)
+            return {stored, static_cast<size_t>(info.size)};
+
+        a_storage.resize(static_cast<size_t>(info.size));
+
+        auto size = static_cast<uLongf>(info.size);
+
+        if(uncompress(a_storage.data(), &size, stored, static_cast<uLong>(info.stored_size)) != Z_OK ||
+            size != info.size)
+            throw std::runtime_error{"Asset " + std::string{a_name} + " is corrupt."};
+
+        return {a_storage.data(), a_storage.size()};
+    }
+
+    void asset_pack::parse()
+    {
+        header head;
+
+        if(m_size < sizeof(head))
+            throw std::runtime_error{"Asset pack is truncated."};
+
+        memcpy(&head, m_data, sizeof(head));
+
+        if(memcmp(head.magic, magic, sizeof(magic)) != 0 || head.version != version)
+            throw std::runtime_error{"Not an asset pack of a supported version."};
+
+        // Entries are copied out, the mapping only guarantees the alignment the APK gives the pack
+
+        auto entries_end = sizeof(head) + static_cast<uint64_t>(head.entry_count) * sizeof(entry);
+        auto names_end = entries_end + head.names_size;
+
+        if(names_end > m_size)
+            throw std::runtime_error{"Asset pack index is truncated."};
+
+        auto names = reinterpret_cast<const char*>(m_data + entries_end);
+
+        m_index.resize(head.entry_count);
+
+        for(uint32_t i = 0; i < head.entry_count; ++i)
+        {
+            auto& item = m_index[i];
+
+            memcpy(&item.info, m_data + sizeof(head) + i * sizeof(entry), sizeof(entry));
+
+            auto& info = item.info;
+
+            if(static_cast<uint64_t>(info.name_offset) + info.name_length > head.names_size)
+                throw std::runtime_error{"Asset pack name is out of bounds."};
+
+            if(info.offset > m_size || info.stored_size > m_size - info.offset)
+                throw std::runtime_error{"Asset pack entry is out of bounds."};
+
+            if(info.method == compression::none ? info.stored_size != info.size : info.method != compression::deflate)
+                throw std::runtime_error{"Asset pack entry has an unknown encoding."};
+
+            item.name = {names + info.name_offset, info.name_length};
+
+            if(i > 0 && !(m_index[i - 1].name < item.name))
+                throw std::runtime_error{"Asset pack index is not sorted."};
+        }
+    }
+
+    const asset_pack::indexed *asset_pack::find(std::string_view a_name) const
+    {
+        auto found = std::lower_bound(m_index.begin(), m_index.end(), a_name,
+            [](const indexed& a_item, std::string_view a_key) { return a_item.name < a_key; });
+
+        return found != m_index.end() && found->name == a_name ? &*found : nullptr;
+    }
+
+    void asset_pack::release() noexcept
+    {
+        if(m_mapping)
+            munmap(m_mapping, m_mapping_size);
+
+#ifdef __ANDROID__
+        if(m_asset)
+            AAsset_close(m_asset);
+#endif
+
+        m_mapping = nullptr;
+        m_asset = nullptr;
+        m_data = nullptr;
+        m_size = 0;
+        m_index.clear();
+    }
+
+}}
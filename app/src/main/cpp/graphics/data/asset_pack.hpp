@@ -0,0 +1,122 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef NCV_ASSET_PACK_HPP
+#define NCV_ASSET_PACK_HPP
+
+#include <utilities/span.hpp>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class AAssetManager;
+struct AAsset;
+
+namespace graphics{ namespace data{
+
+    // Read only archive holding many assets in one file, produced by tools/pack_assets.cpp. The pack is mapped
+    // once, lookups are a binary search over the index and stored entries are handed out as views into the
+    // mapping. Deflated entries are inflated on request.
+    //
+    // Layout (little endian): header, entry_count entries sorted by name, the name table, then the entry data
+    // with every entry starting at a multiple of the header's alignment.
+
+    class asset_pack
+    {
+    public:
+
+        enum class compression : uint32_t
+        {
+            none = 0,
+            deflate = 1
+        };
+
+        struct header
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t entry_count;
+            uint32_t alignment;
+            uint32_t names_size;
+            uint64_t reserved;
+        };
+
+        struct entry
+        {
+            uint64_t offset;
+            uint64_t stored_size;
+            uint64_t size;
+            uint32_t name_offset;
+            uint32_t name_length;
+            compression method;
+            uint32_t reserved;
+        };
+
+        static_assert(sizeof(header) == 32 && sizeof(entry) == 40, "Pack structures must be unpadded.");
+
+        static constexpr char magic[8] = {'N', 'C', 'V', 'P', 'A', 'C', 'K', '\0'};
+        static constexpr uint32_t version = 1;
+
+#ifdef __ANDROID__
+        // Mapped through the APK's file descriptor, which needs the pack stored uncompressed (noCompress), the
+        // asset's buffer is used otherwise.
+
+        asset_pack(AAssetManager* a_ass_mgr, const std::string& a_filename);
+#endif
+        explicit asset_pack(const std::string& a_path);
+        ~asset_pack();
+
+        asset_pack(const asset_pack&) = delete;
+        asset_pack& operator=(const asset_pack&) = delete;
+
+        bool contains(std::string_view a_name) const { return find(a_name) != nullptr; }
+
+        // Contents of a_name. Stored entries are viewed in place and a_storage is left alone, deflated ones are
+        // inflated into a_storage. Views stay valid for the lifetime of the pack. Throws when the entry is
+        // missing or corrupt.
+
+        utilities::span<const uint8_t> read(std::string_view a_name, std::vector<uint8_t>& a_storage) const;
+
+        size_t get_entry_count() const { return m_index.size(); }
+        size_t get_size() const { return m_size; }
+
+    private:
+
+        struct indexed
+        {
+            std::string_view name;
+            entry info;
+        };
+
+        void parse();
+        const indexed* find(std::string_view a_name) const;
+        void release() noexcept;
+
+        const uint8_t* m_data = nullptr;
+        size_t m_size = 0;
+        void* m_mapping = nullptr;
+        size_t m_mapping_size = 0;
+        AAsset* m_asset = nullptr;
+        std::vector<indexed> m_index;
+    };
+
+}}
+
+#endif //NCV_ASSET_PACK_HPP
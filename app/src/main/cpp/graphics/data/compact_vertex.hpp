@@ -0,0 +1,170 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_COMPACT_VERTEX_HPP
+#define NCV_COMPACT_VERTEX_HPP
+
+#include <graphics/data/vertex.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <vector>
+
+namespace graphics{ namespace data{
+
+    // Attribute stored in a packed integer, the format it is fetched with is part of the type. The fixed function
+    // fetch unpacks it to float, so shaders keep reading vecN inputs.
+
+    template<typename Storage, vk::Format Format>
+    struct packed
+    {
+        Storage bits;
+    };
+
+    template<typename Storage, vk::Format Format>
+    struct attribute_format<packed<Storage, Format>>
+    {
+        constexpr static vk::Format value = Format;
+    };
+
+    using half2 = packed<uint32_t, vk::Format::eR16G16Sfloat>;
+    using half4 = packed<uint64_t, vk::Format::eR16G16B16A16Sfloat>;
+    using snorm16x4 = packed<uint64_t, vk::Format::eR16G16B16A16Snorm>;
+    using unorm8x4 = packed<uint32_t, vk::Format::eR8G8B8A8Unorm>;
+
+    inline half2 pack_half(const glm::vec2& a_value) { return {glm::packHalf2x16(a_value)}; }
+    inline half4 pack_half(const glm::vec4& a_value) { return {glm::packHalf4x16(a_value)}; }
+    inline snorm16x4 pack_snorm16(const glm::vec4& a_value) { return {glm::packSnorm4x16(a_value)}; }
+    inline unorm8x4 pack_unorm8(const glm::vec4& a_value) { return {glm::packUnorm4x8(a_value)}; }
+
+    // Half position, unorm8 color, half UVs (16 bytes, 40 for vertex_format)
+
+    struct compact_vertex
+    {
+        half4 position;
+        unorm8x4 color;
+        half2 tex_coords;
+    };
+
+    // Snorm position, for meshes whose positions are normalized into the unit cube. The scale that undoes the
+    // normalization belongs to the model matrix. Precision is uniform across the cube, unlike half.
+
+    struct snorm_vertex
+    {
+        snorm16x4 position;
+        unorm8x4 color;
+        half2 tex_coords;
+    };
+
+    // Positions and the remaining attributes in separate streams. Passes that only need positions (depth,
+    // shadows) bind the first stream alone and fetch 8 bytes per vertex.
+
+    struct split_position
+    {
+        half4 position;
+    };
+
+    struct split_attributes
+    {
+        unorm8x4 color;
+        half2 tex_coords;
+    };
+
+    struct split_vertex;
+
+    template<>
+    struct vertex_layout<compact_vertex>
+    {
+        constexpr static std::array<vertex_binding, 1> bindings = {{{0, sizeof(compact_vertex)}}};
+        constexpr static std::array<vertex_attribute, 3> attributes = {{
+            make_attribute<decltype(compact_vertex::position)>(0, offsetof(compact_vertex, position)),
+            make_attribute<decltype(compact_vertex::color)>(1, offsetof(compact_vertex, color)),
+            make_attribute<decltype(compact_vertex::tex_coords)>(2, offsetof(compact_vertex, tex_coords))
+        }};
+    };
+
+    template<>
+    struct vertex_layout<snorm_vertex>
+    {
+        constexpr static std::array<vertex_binding, 1> bindings = {{{0, sizeof(snorm_vertex)}}};
+        constexpr static std::array<vertex_attribute, 3> attributes = {{
+            make_attribute<decltype(snorm_vertex::position)>(0, offsetof(snorm_vertex, position)),
+            make_attribute<decltype(snorm_vertex::color)>(1, offsetof(snorm_vertex, color)),
+            make_attribute<decltype(snorm_vertex::tex_coords)>(2, offsetof(snorm_vertex, tex_coords))
+        }};
+    };
+
+    template<>
+    struct vertex_layout<split_vertex>
+    {
+        constexpr static std::array<vertex_binding, 2> bindings = {{
+            {0, sizeof(split_position)},
+            {1, sizeof(split_attributes)}
+        }};
+        constexpr static std::array<vertex_attribute, 3> attributes = {{
+            make_attribute<decltype(split_position::position)>(0, offsetof(split_position, position), 0),
+            make_attribute<decltype(split_attributes::color)>(1, offsetof(split_attributes, color), 1),
+            make_attribute<decltype(split_attributes::tex_coords)>(2, offsetof(split_attributes, tex_coords), 1)
+        }};
+    };
+
+    static_assert(sizeof(compact_vertex) == 16 && sizeof(snorm_vertex) == 16, "Unexpected compact vertex size.");
+    static_assert(sizeof(split_position) == 8 && sizeof(split_attributes) == 8, "Unexpected split vertex size.");
+
+    // Conversion from the authoring format
+
+    template<typename T>
+    T pack_vertex(const vertex_format& a_vertex);
+
+    template<>
+    inline compact_vertex pack_vertex<compact_vertex>(const vertex_format& a_vertex)
+    {
+        return {pack_half(a_vertex.position), pack_unorm8(a_vertex.color), pack_half(a_vertex.tex_coords)};
+    }
+
+    template<>
+    inline snorm_vertex pack_vertex<snorm_vertex>(const vertex_format& a_vertex)
+    {
+        return {pack_snorm16(a_vertex.position), pack_unorm8(a_vertex.color), pack_half(a_vertex.tex_coords)};
+    }
+
+    template<>
+    inline split_position pack_vertex<split_position>(const vertex_format& a_vertex)
+    {
+        return {pack_half(a_vertex.position)};
+    }
+
+    template<>
+    inline split_attributes pack_vertex<split_attributes>(const vertex_format& a_vertex)
+    {
+        return {pack_unorm8(a_vertex.color), pack_half(a_vertex.tex_coords)};
+    }
+
+    template<typename T>
+    std::vector<T> pack_vertices(const std::vector<vertex_format>& a_vertices)
+    {
+        std::vector<T> result;
+
+        result.reserve(a_vertices.size());
+
+        for(auto& vertex : a_vertices)
+            result.push_back(pack_vertex<T>(vertex));
+
+        return result;
+    }
+}}
+
+#endif //NCV_COMPACT_VERTEX_HPP
@@ -0,0 +1,239 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_GEOMETRY_HPP
+#define NCV_GEOMETRY_HPP
+
+#include <graphics/data/vertex.hpp>
+
+#include <array>
+#include <cstdint>
+
+namespace graphics{ namespace data{
+
+    // Primitive geometry generated at compile time. Tables are constant initialized, so they end up in .rodata
+    // with no static initializer and no heap copy per translation unit. Faces are wound like the cube, front
+    // faces are (top left, top right, bottom right) when looked at from outside.
+
+    template<size_t VertexCount, size_t IndexCount>
+    struct geometry_table
+    {
+        std::array<vertex_format, VertexCount> vertices;
+        std::array<uint32_t, IndexCount> indices;
+    };
+
+    namespace detail
+    {
+        constexpr double pi = 3.14159265358979323846;
+
+        // std::sin is not constexpr, a Taylor series over [-pi, pi] is exact to double precision
+
+        constexpr double sin(double a_x)
+        {
+            while(a_x > pi)
+                a_x -= 2. * pi;
+            while(a_x < -pi)
+                a_x += 2. * pi;
+
+            double term = a_x, sum = a_x;
+
+            for(int n = 1; n < 14; ++n)
+            {
+                term *= -a_x * a_x / ((2. * n) * (2. * n + 1.));
+                sum += term;
+            }
+
+            return sum;
+        }
+
+        constexpr double cos(double a_x)
+        {
+            return sin(a_x + pi / 2.);
+        }
+
+        // Two triangles per quad of a (Columns + 1) x (Rows + 1) vertex lattice, rows running top to bottom
+
+        template<size_t IndexCount>
+        constexpr void lattice_indices(std::array<uint32_t, IndexCount>& a_indices, uint32_t a_columns,
+            uint32_t a_rows)
+        {
+            size_t k = 0;
+
+            for(uint32_t j = 0; j < a_rows; ++j)
+            {
+                for(uint32_t i = 0; i < a_columns; ++i)
+                {
+                    uint32_t top_left = j * (a_columns + 1) + i, top_right = top_left + 1;
+                    uint32_t bottom_left = top_left + a_columns + 1, bottom_right = bottom_left + 1;
+
+                    a_indices[k++] = top_left;
+                    a_indices[k++] = top_right;
+                    a_indices[k++] = bottom_right;
+                    a_indices[k++] = bottom_right;
+                    a_indices[k++] = bottom_left;
+                    a_indices[k++] = top_left;
+                }
+            }
+        }
+    }
+
+    // Unit cube, one color and texture mapping per face
+
+    constexpr geometry_table<24, 36> make_cube()
+    {
+        return {
+            {{
+                {{-1.0f, 1.0f,  1.0f, 1.0f}, {1.f,  0.0f, 0.0f, 1.0f}, {1.0f, 0.0f}},
+                {{1.0f, 1.0f,  1.0f, 1.0f}, {0.0f, 0.0f, 1.0f, 1.0f}, {0.0f, 0.0f}},
+                {{1.0f, -1.0f, 1.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f}},
+                {{-1.0f, -1.0f, 1.0f, 1.0f}, {1.0f, 1.0f, 0.0f, 1.0f}, {1.0f, 1.0f}},
+
+                {{-1.0f, 1.0f,  -1.0f, 1.0f}, {1.f,  0.0f, 0.0f, 1.0f}, {0.0f, 0.0f}},
+                {{1.0f, 1.0f,  -1.0f, 1.0f}, {0.0f, 0.0f, 1.0f, 1.0f}, {1.0f, 0.0f}},
+                {{1.0f, -1.0f, -1.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {1.0f, 1.0f}},
+                {{-1.0f, -1.0f, -1.0f, 1.0f}, {1.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f}},
+
+                {{1.0f, 1.0f,  1.0f, 1.0f}, {0.0f, 0.0f, 1.0f, 1.0f}, {1.0f, 0.0f}},
+                {{1.0f, 1.0f,  -1.0f, 1.0f}, {0.0f, 0.0f, 1.0f, 1.0f}, {0.0f, 0.0f}},
+                {{1.0f, -1.0f, -1.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f}},
+                {{1.0f, -1.0f, 1.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {1.0f, 1.0f}},
+
+                {{-1.0f, 1.0f,  -1.0f, 1.0f}, {1.f,  0.0f, 0.0f, 1.0f}, {1.0f, 0.0f}},
+                {{-1.0f, 1.0f,  1.0f, 1.0f}, {1.f,  0.0f, 0.0f, 1.0f}, {0.0f, 0.0f}},
+                {{-1.0f, -1.0f, 1.0f, 1.0f}, {1.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f}},
+                {{-1.0f, -1.0f, -1.0f, 1.0f}, {1.0f, 1.0f, 0.0f, 1.0f}, {1.0f, 1.0f}},
+
+                {{-1.0f, 1.0f,  -1.0f, 1.0f}, {1.f,  0.0f, 0.0f, 1.0f}, {0.0f, 0.0f}},
+                {{1.0f, 1.0f,  -1.0f, 1.0f}, {0.0f, 0.0f, 1.0f, 1.0f}, {0.0f, 1.0f}},
+                {{1.0f, 1.0f,  1.0f, 1.0f}, {0.0f, 0.0f, 1.0f, 1.0f}, {1.0f, 1.0f}},
+                {{-1.0f, 1.0f,  1.0f, 1.0f}, {1.f,  0.0f, 0.0f, 1.0f}, {1.0f, 0.0f}},
+
+                {{-1.0f, -1.0f, 1.0f, 1.0f}, {1.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 0.0f}},
+                {{1.0f, -1.0f, 1.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f}},
+                {{1.0f, -1.0f, -1.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {1.0f, 1.0f}},
+                {{-1.0f, -1.0f, -1.0f, 1.0f}, {1.0f, 1.0f, 0.0f, 1.0f}, {1.0f, 0.0f}}
+            }},
+            {{
+                0, 1, 2, 2, 3, 0,
+                7, 5, 4, 7, 6, 5,
+                8, 9, 10, 10, 11, 8,
+                12, 13, 14, 14, 15, 12,
+                16, 17, 18, 18, 19, 16,
+                20, 21, 22, 22, 23, 20
+            }}
+        };
+    }
+
+    // Subdivided rectangle on the XY plane, centered at the origin and facing +Z
+
+    template<uint32_t Columns, uint32_t Rows>
+    constexpr geometry_table<(Columns + 1) * (Rows + 1), Columns * Rows * 6> make_grid(float a_width = 2.f,
+        float a_height = 2.f)
+    {
+        static_assert(Columns > 0 && Rows > 0, "Grid needs at least one quad.");
+
+        geometry_table<(Columns + 1) * (Rows + 1), Columns * Rows * 6> result{};
+
+        for(uint32_t j = 0; j <= Rows; ++j)
+        {
+            for(uint32_t i = 0; i <= Columns; ++i)
+            {
+                float u = static_cast<float>(i) / Columns, v = static_cast<float>(j) / Rows;
+
+                result.vertices[j * (Columns + 1) + i] = vertex_format{
+                    {(u - .5f) * a_width, (.5f - v) * a_height, 0.f, 1.f},
+                    {1.f, 1.f, 1.f, 1.f},
+                    {u, v}
+                };
+            }
+        }
+
+        detail::lattice_indices(result.indices, Columns, Rows);
+
+        return result;
+    }
+
+    constexpr auto make_plane(float a_width = 2.f, float a_height = 2.f)
+    {
+        return make_grid<1, 1>(a_width, a_height);
+    }
+
+    // UV sphere centered at the origin. Slices run around the Y axis, stacks from the north (+Y) to the south
+    // pole. Pole rows keep one vertex per slice so texture coordinates stay continuous, their degenerate
+    // triangles are dropped.
+
+    template<uint32_t Slices, uint32_t Stacks>
+    constexpr geometry_table<(Slices + 1) * (Stacks + 1), Slices * (Stacks - 1) * 6> make_sphere(
+        float a_radius = 1.f)
+    {
+        static_assert(Slices >= 3 && Stacks >= 2, "Sphere needs at least 3 slices and 2 stacks.");
+
+        geometry_table<(Slices + 1) * (Stacks + 1), Slices * (Stacks - 1) * 6> result{};
+
+        for(uint32_t j = 0; j <= Stacks; ++j)
+        {
+            double phi = detail::pi * j / Stacks;
+
+            for(uint32_t i = 0; i <= Slices; ++i)
+            {
+                double theta = 2. * detail::pi * i / Slices;
+
+                result.vertices[j * (Slices + 1) + i] = vertex_format{
+                    {
+                        static_cast<float>(a_radius * detail::sin(phi) * detail::sin(theta)),
+                        static_cast<float>(a_radius * detail::cos(phi)),
+                        static_cast<float>(a_radius * detail::sin(phi) * detail::cos(theta)),
+                        1.f
+                    },
+                    {1.f, 1.f, 1.f, 1.f},
+                    {static_cast<float>(i) / Slices, static_cast<float>(j) / Stacks}
+                };
+            }
+        }
+
+        size_t k = 0;
+
+        for(uint32_t j = 0; j < Stacks; ++j)
+        {
+            for(uint32_t i = 0; i < Slices; ++i)
+            {
+                uint32_t top_left = j * (Slices + 1) + i, top_right = top_left + 1;
+                uint32_t bottom_left = top_left + Slices + 1, bottom_right = bottom_left + 1;
+
+                if(j != 0)
+                {
+                    result.indices[k++] = top_left;
+                    result.indices[k++] = top_right;
+                    result.indices[k++] = bottom_right;
+                }
+
+                if(j != Stacks - 1)
+                {
+                    result.indices[k++] = bottom_right;
+                    result.indices[k++] = bottom_left;
+                    result.indices[k++] = top_left;
+                }
+            }
+        }
+
+        return result;
+    }
+
+    inline constexpr auto cube = make_cube();
+}}
+
+#endif //NCV_GEOMETRY_HPP
@@ -0,0 +1,293 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include <graphics/data/ktx2.hpp>
+
+#ifdef NCV_BASISU_ENABLED
+#include <transcoder/basisu_transcoder.h>
+#include <mutex>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+namespace graphics{ namespace data{
+
+    namespace
+    {
+        const uint8_t identifier[12] = {0xab, 0x4b, 0x54, 0x58, 0x20, 0x32, 0x30, 0xbb, 0x0d, 0x0a, 0x1a, 0x0a};
+
+        constexpr size_t header_size = 80;
+        constexpr size_t level_entry_size = 24;
+
+        // Data format descriptor fields (KHR_DF_MODEL_UASTC and KHR_DF_TRANSFER_SRGB)
+
+        constexpr uint8_t dfd_model_uastc = 166;
+        constexpr uint8_t dfd_transfer_srgb = 2;
+
+        // VkFormat values
+
+        constexpr uint32_t format_rgba8_unorm = 37;
+        constexpr uint32_t format_rgba8_srgb = 43;
+
+        struct format_range
+        {
+            uint32_t first;
+            uint32_t last;
+            ktx2::block_info block;
+        };
+
+        const format_range block_formats[] = {
+            {format_rgba8_unorm, format_rgba8_unorm, {1, 1, 4}},
+            {format_rgba8_srgb, format_rgba8_srgb, {1, 1, 4}},
+            {131, 134, {4, 4, 8}},      // BC1
+            {135, 138, {4, 4, 16}},     // BC2, BC3
+            {139, 140, {4, 4, 8}},      // BC4
+            {141, 146, {4, 4, 16}},     // BC5, BC6H, BC7
+            {147, 150, {4, 4, 8}},      // ETC2 RGB8, RGB8A1
+            {151, 152, {4, 4, 16}},     // ETC2 RGBA8
+            {153, 154, {4, 4, 8}},      // EAC R11
+            {155, 156, {4, 4, 16}}      // EAC R11G11
+        };
+
+        // ASTC LDR formats come in UNORM/SRGB pairs from 157 on, all with 16 byte blocks
+
+        const uint32_t astc_blocks[][2] = {{4, 4}, {5, 4}, {5, 5}, {6, 5}, {6, 6}, {8, 5}, {8, 6}, {8, 8}, {10, 5},
+            {10, 6}, {10, 8}, {10, 10}, {12, 10}, {12, 12}};
+        constexpr uint32_t astc_first = 157;
+
+        bool is_srgb_format(uint32_t a_format)
+        {
+            if(a_format == format_rgba8_srgb)
+                return true;
+            if((a_format >= 131 && a_format <= 138) || (a_format >= 145 && a_format <= 152))
+                return a_format % 2 == 0;
+            if(a_format >= astc_first && a_format < astc_first + 28)
+                return (a_format - astc_first) % 2 == 1;
+            return false;
+        }
+
+        template<typename T>
+        T read(utilities::span<const uint8_t> a_file, size_t a_offset)
+        {
+            T value;
+            memcpy(&value, a_file.data() + a_offset, sizeof(T));
+            return value;
+        }
+
+        size_t level_size(const ktx2::block_info& a_block, uint32_t a_width, uint32_t a_height)
+        {
+            size_t blocks_x = (a_width + a_block.width - 1) / a_block.width;
+            size_t blocks_y = (a_height + a_block.height - 1) / a_block.height;
+            return blocks_x * blocks_y * a_block.bytes;
+        }
+
+#ifdef NCV_BASISU_ENABLED
+        struct basis_target
+        {
+            uint32_t unorm;
+            uint32_t srgb;
+            basist::transcoder_texture_format format;
+        };
+
+        const basis_target basis_targets[] = {
+            {157, 158, basist::transcoder_texture_format::cTFASTC_4x4_RGBA},
+            {145, 146, basist::transcoder_texture_format::cTFBC7_RGBA},
+            {151, 152, basist::transcoder_texture_format::cTFETC2_RGBA},
+            {format_rgba8_unorm, format_rgba8_srgb, basist::transcoder_texture_format::cTFRGBA32}
+        };
+
+        ktx2_image transcode(const ktx2& a_container, utilities::span<const uint8_t> a_file,
+            const ktx2::format_filter& a_supported)
+        {
+            static std::once_flag init;
+            std::call_once(init, []{ basist::basisu_transcoder_init(); });
+
+            auto target = std::find_if(std::begin(basis_targets), std::end(basis_targets),
+                [&](const basis_target& a_target) {
+                    return !a_supported || a_supported(a_container.is_srgb() ? a_target.srgb : a_target.unorm);
+                });
+
+            if(target == std::end(basis_targets))
+                throw std::runtime_error{"No supported format to transcode KTX2 texture to."};
+
+            basist::ktx2_transcoder transcoder;
+
+            if(!transcoder.init(a_file.data(), static_cast<uint32_t>(a_file.size())) ||
+                !transcoder.start_transcoding())
+                throw std::runtime_error{"Could not start transcoding KTX2 texture."};
+
+            ktx2_image result;
+
+            result.format = a_container.is_srgb() ? target->srgb : target->unorm;
+            result.width = a_container.get_width();
+            result.height = a_container.get_height();
+
+            auto bytes_per_unit = basist::basis_get_bytes_per_block_or_pixel(target->format);
+            auto uncompressed = basist::basis_transcoder_format_is_uncompressed(target->format);
+
+            for(uint32_t i = 0; i < a_container.get_levels().size(); ++i)
+            {
+                basist::ktx2_image_level_info info;
+
+                if(!transcoder.get_image_level_info(info, i, 0, 0))
+                    throw std::runtime_error{"Could not query KTX2 level."};
+
+                // Blocks for compressed targets, pixels for RGBA32
+
+                uint32_t units = uncompressed ? info.m_orig_width * info.m_orig_height : info.m_total_blocks;
+                auto offset = result.data.size();
+                auto size = static_cast<size_t>(units) * bytes_per_unit;
+
+                result.data.resize(offset + size);
+
+                if(!transcoder.transcode_image_level(i, 0, 0, result.data.data() + offset, units, target->format))
+                    throw std::runtime_error{"Could not transcode KTX2 level."};
+
+                result.levels.push_back({offset, size, info.m_orig_width, info.m_orig_height});
+            }
+
+            return result;
+        }
+#endif
+    }
+
+    ktx2::ktx2(utilities::span<const uint8_t> a_file)
+    {
+        if(!is_ktx2(a_file) || a_file.size() < header_size)
+            throw std::runtime_error{"Not a KTX2 file."};
+
+        m_format = read<uint32_t>(a_file, 12);
+        m_width = read<uint32_t>(a_file, 20);
+        m_height = read<uint32_t>(a_file, 24);
+
+        auto depth = read<uint32_t>(a_file, 28);
+        auto layers = read<uint32_t>(a_file, 32);
+        auto faces = read<uint32_t>(a_file, 36);
+        auto level_count = std::max(read<uint32_t>(a_file, 40), 1u);
+
+        m_scheme = static_cast<supercompression>(read<uint32_t>(a_file, 44));
+
+        if(!m_width || !m_height || depth > 1 || layers > 1 || faces != 1)
+            throw std::runtime_error{"Only single 2D KTX2 images are supported."};
+
+        if(level_count > 32 || (std::max(m_width, m_height) >> (level_count - 1)) == 0)
+            throw std::runtime_error{"KTX2 level count exceeds the image's mip chain."};
+
+        auto dfd_offset = read<uint32_t>(a_file, 48);
+        auto dfd_length = read<uint32_t>(a_file, 52);
+
+        if(static_cast<size_t>(dfd_offset) + dfd_length > a_file.size())
+            throw std::runtime_error{"KTX2 data format descriptor is out of bounds."};
+
+        if(header_size + level_count * level_entry_size > a_file.size())
+            throw std::runtime_error{"KTX2 level index is out of bounds."};
+
+        // Total size, then the basic descriptor block: vendor/type, version/size, then model, primaries,
+        // transfer function and flags a byte each.
+
+        uint8_t model = 0, transfer = 0;
+
+        if(dfd_length >= 16)
+        {
+            model = a_file[dfd_offset + 12];
+            transfer = a_file[dfd_offset + 14];
+        }
+
+        m_basis = m_format == 0 && (m_scheme == supercompression::basis_lz || model == dfd_model_uastc);
+        m_srgb = m_format ? is_srgb_format(m_format) : transfer == dfd_transfer_srgb;
+
+        std::optional<block_info> block;
+
+        if(!m_basis)
+        {
+            if(m_scheme != supercompression::none)
+                throw std::runtime_error{"Supercompressed KTX2 data is not supported."};
+
+            block = get_block_info(m_format);
+
+            if(!block)
+                throw std::runtime_error{"KTX2 format is not supported."};
+        }
+
+        for(uint32_t i = 0; i < level_count; ++i)
+        {
+            auto entry = header_size + i * level_entry_size;
+            auto offset = read<uint64_t>(a_file, entry);
+            auto size = read<uint64_t>(a_file, entry + 8);
+            auto width = std::max(m_width >> i, 1u), height = std::max(m_height >> i, 1u);
+
+            if(offset > a_file.size() || size > a_file.size() - offset)
+                throw std::runtime_error{"KTX2 level is out of bounds."};
+
+            if(block && size != level_size(*block, width, height))
+                throw std::runtime_error{"KTX2 level size differs from its extent."};
+
+            m_levels.push_back({static_cast<size_t>(offset), static_cast<size_t>(size), width, height});
+        }
+    }
+
+    bool ktx2::is_ktx2(utilities::span<const uint8_t> a_file)
+    {
+        return a_file.size() >= sizeof(identifier) && !memcmp(a_file.data(), identifier, sizeof(identifier));
+    }
+
+    std::optional<ktx2::block_info> ktx2::get_block_info(uint32_t a_format)
+    {
+        for(auto& range : block_formats)
+            if(a_format >= range.first && a_format <= range.last)
+                return range.block;
+
+        if(a_format >= astc_first && a_format < astc_first + 2 * std::size(astc_blocks))
+        {
+            auto& dims = astc_blocks[(a_format - astc_first) / 2];
+            return block_info{dims[0], dims[1], 16};
+        }
+
+        return std::nullopt;
+    }
+
+    ktx2_image prepare_ktx2(const ktx2& a_container, utilities::span<const uint8_t> a_file,
+        const ktx2::format_filter& a_supported)
+    {
+        if(a_container.is_basis())
+        {
+#ifdef NCV_BASISU_ENABLED
+            return transcode(a_container, a_file, a_supported);
+#else
+            static_cast<void>(a_file);
+            throw std::runtime_error{"KTX2 texture needs Basis Universal transcoding, which is not built in."};
+#endif
+        }
+
+        if(a_supported && !a_supported(a_container.get_format()))
+            throw std::runtime_error{"KTX2 texture format is not supported by the device."};
+
+        ktx2_image result;
+
+        result.format = a_container.get_format();
+        result.width = a_container.get_width();
+        result.height = a_container.get_height();
+        result.levels = a_container.get_levels();
+
+        return result;
+    }
+
+}}
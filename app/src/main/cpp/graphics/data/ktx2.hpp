@@ -0,0 +1,123 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef NCV_KTX2_HPP
+#define NCV_KTX2_HPP
+
+#include <utilities/span.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace graphics{ namespace data{
+
+    // Reader for KTX 2.0 containers holding a single 2D image (no array layers, no cube faces). It works on a
+    // view of the whole file and checks every offset against it. Formats are VkFormat values, so this module
+    // stays free of Vulkan and Android and can be exercised on any host.
+
+    class ktx2
+    {
+    public:
+
+        enum class supercompression : uint32_t
+        {
+            none = 0,
+            basis_lz = 1,
+            zstd = 2,
+            zlib = 3
+        };
+
+        struct block_info
+        {
+            uint32_t width;
+            uint32_t height;
+            uint32_t bytes;
+        };
+
+        // Offsets are from the start of the viewed data
+
+        struct level
+        {
+            size_t offset;
+            size_t size;
+            uint32_t width;
+            uint32_t height;
+        };
+
+        // Asked whether a format can be sampled (and filtered) by the device
+
+        using format_filter = std::function<bool(uint32_t a_format)>;
+
+        explicit ktx2(utilities::span<const uint8_t> a_file);
+
+        static bool is_ktx2(utilities::span<const uint8_t> a_file);
+
+        // Texel block of the formats that are uploaded as stored (RGBA8, BC, ETC2/EAC and ASTC LDR)
+
+        static std::optional<block_info> get_block_info(uint32_t a_format);
+
+        // VK_FORMAT_UNDEFINED (0) for Basis Universal payloads
+
+        uint32_t get_format() const { return m_format; }
+        uint32_t get_width() const { return m_width; }
+        uint32_t get_height() const { return m_height; }
+        supercompression get_supercompression() const { return m_scheme; }
+
+        // Largest level first, files without stored mips report one level
+
+        const std::vector<level>& get_levels() const { return m_levels; }
+
+        // ETC1S (BasisLZ) or UASTC data, has to be transcoded before upload
+
+        bool is_basis() const { return m_basis; }
+        bool is_srgb() const { return m_srgb; }
+
+    private:
+
+        uint32_t m_format = 0;
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+        supercompression m_scheme = supercompression::none;
+        std::vector<level> m_levels;
+        bool m_basis = false;
+        bool m_srgb = false;
+    };
+
+    // Levels ready for upload, pointing into data or, when data is empty, into the file itself
+
+    struct ktx2_image
+    {
+        uint32_t format = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<ktx2::level> levels;
+        std::vector<uint8_t> data;
+    };
+
+    // Block and plain formats are taken as stored when a_supported accepts them, nothing is decoded on the
+    // CPU. Basis Universal payloads are transcoded to the first of ASTC 4x4, BC7, ETC2 and RGBA8 the device
+    // supports, which needs a build with NCV_BASISU_ENABLED. Throws when no usable format is left.
+
+    ktx2_image prepare_ktx2(const ktx2& a_container, utilities::span<const uint8_t> a_file,
+        const ktx2::format_filter& a_supported);
+
+}}
+
+#endif //NCV_KTX2_HPP
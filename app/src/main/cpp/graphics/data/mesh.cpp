@@ -0,0 +1,248 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <graphics/data/mesh.hpp>
+#include <graphics/data/mesh_formats.hpp>
+#include <graphics/data/mesh_optimizer.hpp>
+
+#ifdef __ANDROID__
+#include <android/asset_manager.h>
+#endif
+
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    using clock_type = std::chrono::steady_clock;
+
+    double elapsed_ms(clock_type::time_point a_start)
+    {
+        return std::chrono::duration<double, std::milli>(clock_type::now() - a_start).count();
+    }
+
+    class mapped_file
+    {
+    public:
+
+        explicit mapped_file(const std::string& a_path)
+        {
+            int fd = open(a_path.c_str(), O_RDONLY | O_CLOEXEC);
+
+            if(fd < 0)
+                throw std::runtime_error{"Couldn't open mesh file " + a_path + "."};
+
+            struct stat info{};
+
+            if(fstat(fd, &info) != 0 || info.st_size <= 0)
+            {
+                close(fd);
+                throw std::runtime_error{"Couldn't stat mesh file " + a_path + "."};
+            }
+
+            m_size = static_cast<size_t>(info.st_size);
+            m_data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            // The mapping holds its own reference to the file
+
+            close(fd);
+
+            if(m_data == MAP_FAILED)
+                throw std::runtime_error{"Couldn't map mesh file " + a_path + "."};
+
+            madvise(m_data, m_size, MADV_SEQUENTIAL);
+        }
+
+        ~mapped_file()
+        {
+            munmap(m_data, m_size);
+        }
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        const uint8_t* data() const { return static_cast<const uint8_t*>(m_data); }
+        size_t size() const { return m_size; }
+
+    private:
+
+        void* m_data = nullptr;
+        size_t m_size = 0;
+    };
+
+    struct vertex_hash
+    {
+        size_t operator()(const graphics::data::vertex_format& a_vertex) const
+        {
+            // FNV-1a over the bytes, vertex_format has no padding
+
+            auto bytes = reinterpret_cast<const uint8_t*>(&a_vertex);
+            uint64_t hash = 14695981039346656037ull;
+
+            for(size_t i = 0; i < sizeof(a_vertex); ++i)
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+
+            return static_cast<size_t>(hash);
+        }
+    };
+
+    struct vertex_equal
+    {
+        bool operator()(const graphics::data::vertex_format& a_lhs, const graphics::data::vertex_format& a_rhs) const
+        {
+            return memcmp(&a_lhs, &a_rhs, sizeof(a_lhs)) == 0;
+        }
+    };
+
+    static_assert(sizeof(graphics::data::vertex_format) == 10 * sizeof(float), "vertex_format must be unpadded.");
+}
+
+namespace graphics{ namespace data{
+
+#ifdef __ANDROID__
+    mesh::mesh(AAssetManager *a_ass_mgr, const std::string &a_filename)
+    {
+        AAsset* file = AAssetManager_open(a_ass_mgr, a_filename.c_str(), AASSET_MODE_BUFFER);
+
+        if(!file)
+            throw std::runtime_error{"Couldn't open mesh asset " + a_filename + "."};
+
+        auto data = static_cast<const uint8_t*>(AAsset_getBuffer(file));
+
+        if(!data)
+        {
+            AAsset_close(file);
+            throw std::runtime_error{"Couldn't map mesh asset " + a_filename + "."};
+        }
+
+        try
+        {
+            load(data, AAsset_getLength(file));
+        }
+        catch(...)
+        {
+            AAsset_close(file);
+            throw;
+        }
+
+        AAsset_close(file);
+    }
+#endif
+
+    mesh::mesh(const std::string &a_path)
+    {
+        mapped_file file{a_path};
+
+        load(file.data(), file.size());
+    }
+
+    mesh::mesh(utilities::span<const vertex_format> a_vertices, utilities::span<const uint32_t> a_indices)
+    {
+        m_stats.source_bytes = a_vertices.size_bytes() + a_indices.size_bytes();
+
+        build(raw_mesh{{a_vertices.begin(), a_vertices.end()}, {a_indices.begin(), a_indices.end()}});
+    }
+
+    std::vector<uint16_t> mesh::get_indices16() const
+    {
+        if(m_index_width != index_width::bits16)
+            throw std::runtime_error{"Mesh indices don't fit in 16 bits."};
+
+        return std::vector<uint16_t>(m_indices.begin(), m_indices.end());
+    }
+
+    void mesh::load(const uint8_t *a_data, size_t a_size)
+    {
+        auto start = clock_type::now();
+
+        m_stats.source_bytes = a_size;
+
+        auto raw = is_glb(a_data, a_size) ? parse_glb(a_data, a_size) :
+            parse_obj(reinterpret_cast<const char*>(a_data), a_size);
+
+        m_stats.load_ms = elapsed_ms(start);
+
+        build(std::move(raw));
+    }
+
+    void mesh::build(raw_mesh &&a_raw)
+    {
+        auto start = clock_type::now();
+
+        if(a_raw.indices.size() % 3 != 0)
+            throw std::runtime_error{"Mesh index count is not a multiple of three."};
+
+        m_stats.source_vertices = a_raw.vertices.size();
+        m_stats.triangles = a_raw.indices.size() / 3;
+
+        // Deduplicate bitwise equal vertices
+
+        std::unordered_map<vertex_format, uint32_t, vertex_hash, vertex_equal> unique;
+        std::vector<vertex_format> vertices;
+        std::vector<uint32_t> remap(a_raw.vertices.size());
+
+        unique.reserve(a_raw.vertices.size());
+        vertices.reserve(a_raw.vertices.size());
+
+        for(size_t i = 0; i < a_raw.vertices.size(); ++i)
+        {
+            auto found = unique.emplace(a_raw.vertices[i], static_cast<uint32_t>(vertices.size()));
+
+            if(found.second)
+                vertices.push_back(a_raw.vertices[i]);
+
+            remap[i] = found.first->second;
+        }
+
+        for(auto& index : a_raw.indices)
+        {
+            if(index >= remap.size())
+                throw std::runtime_error{"Mesh index out of range."};
+
+            index = remap[index];
+        }
+
+        // Triangle order first, then vertices in order of first use by the reordered triangles
+
+        m_stats.acmr_before = compute_acmr(a_raw.indices);
+
+        m_indices = optimize_vertex_cache(a_raw.indices, vertices.size());
+
+        size_t used_vertices = 0;
+        auto fetch_remap = optimize_vertex_fetch(m_indices, vertices.size(), used_vertices);
+
+        m_vertices = remap_vertices(vertices, fetch_remap, used_vertices);
+
+        m_stats.unique_vertices = m_vertices.size();
+        m_stats.acmr_after = compute_acmr(m_indices);
+
+        // Primitive restart is never enabled, so the whole 16-bit range is usable
+
+        m_index_width = m_vertices.size() <= std::numeric_limits<uint16_t>::max() + size_t{1} ?
+            index_width::bits16 : index_width::bits32;
+
+        m_stats.optimize_ms = elapsed_ms(start);
+    }
+}}
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_MESH_HPP
+#define NCV_MESH_HPP
+
+#include <graphics/data/vertex.hpp>
+#include <utilities/span.hpp>
+
+#include <string>
+#include <vector>
+
+class AAssetManager;
+
+namespace graphics{ namespace data{
+
+    struct raw_mesh;
+
+    // Indexed triangle mesh, ready for upload. Whatever the source, vertices are deduplicated, triangles are
+    // reordered for post-transform cache reuse and vertices for fetch locality. Files are read through a memory
+    // mapping (OBJ or glTF 2.0 binary, detected from the contents).
+
+    class mesh
+    {
+    public:
+
+        enum class index_width : uint8_t
+        {
+            bits16,
+            bits32
+        };
+
+        struct statistics
+        {
+            size_t source_bytes = 0;
+            size_t source_vertices = 0;
+            size_t unique_vertices = 0;
+            size_t triangles = 0;
+            float acmr_before = 0.f;
+            float acmr_after = 0.f;
+            double load_ms = 0.;
+            double optimize_ms = 0.;
+        };
+
+#ifdef __ANDROID__
+        // Assets should be stored uncompressed in the APK, so they are mapped rather than inflated.
+
+        mesh(AAssetManager* a_ass_mgr, const std::string& a_filename);
+#endif
+        explicit mesh(const std::string& a_path);
+        mesh(utilities::span<const vertex_format> a_vertices, utilities::span<const uint32_t> a_indices);
+
+        const std::vector<vertex_format>& get_vertices() const { return m_vertices; }
+        const std::vector<uint32_t>& get_indices() const { return m_indices; }
+        std::vector<uint16_t> get_indices16() const;
+
+        index_width get_index_width() const { return m_index_width; }
+        size_t get_index_count() const { return m_indices.size(); }
+        const statistics& get_statistics() const { return m_stats; }
+
+    private:
+
+        void load(const uint8_t* a_data, size_t a_size);
+        void build(raw_mesh&& a_raw);
+
+        std::vector<vertex_format> m_vertices;
+        std::vector<uint32_t> m_indices;
+        index_width m_index_width = index_width::bits32;
+        statistics m_stats;
+    };
+}}
+
+#endif //NCV_MESH_HPP
@@ -0,0 +1,779 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <graphics/data/mesh_formats.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+    // Minimal text scanner over a non null-terminated buffer
+
+    class scanner
+    {
+    public:
+
+        scanner(const char* a_begin, const char* a_end) : m_pos{a_begin}, m_end{a_end}
+        {}
+
+        bool done() const { return m_pos >= m_end; }
+        char peek() const { return m_pos < m_end ? *m_pos : '\0'; }
+        void advance() { ++m_pos; }
+
+        void skip_blanks()
+        {
+            while(m_pos < m_end && (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\r'))
+                ++m_pos;
+        }
+
+        void skip_whitespace()
+        {
+            while(m_pos < m_end && (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\r' || *m_pos == '\n'))
+                ++m_pos;
+        }
+
+        void skip_line()
+        {
+            while(m_pos < m_end && *m_pos != '\n')
+                ++m_pos;
+            if(m_pos < m_end)
+                ++m_pos;
+        }
+
+        bool at_line_end()
+        {
+            skip_blanks();
+            return m_pos >= m_end || *m_pos == '\n' || *m_pos == '#';
+        }
+
+        bool accept(char a_char)
+        {
+            if(peek() != a_char)
+                return false;
+            ++m_pos;
+            return true;
+        }
+
+        bool accept_word(const char* a_word)
+        {
+            auto length = strlen(a_word);
+
+            if(static_cast<size_t>(m_end - m_pos) < length || memcmp(m_pos, a_word, length) != 0)
+                return false;
+
+            m_pos += length;
+            return true;
+        }
+
+        bool read_integer(int64_t& a_value)
+        {
+            bool negative = accept('-');
+
+            if(!negative)
+                accept('+');
+
+            if(done() || !isdigit(static_cast<unsigned char>(*m_pos)))
+                return false;
+
+            int64_t value = 0;
+
+            while(m_pos < m_end && isdigit(static_cast<unsigned char>(*m_pos)))
+                value = value * 10 + (*m_pos++ - '0');
+
+            a_value = negative ? -value : value;
+            return true;
+        }
+
+        bool read_number(double& a_value)
+        {
+            bool negative = accept('-');
+
+            if(!negative)
+                accept('+');
+
+            double value = 0.;
+            bool digits = false;
+
+            while(m_pos < m_end && isdigit(static_cast<unsigned char>(*m_pos)))
+            {
+                value = value * 10. + (*m_pos++ - '0');
+                digits = true;
+            }
+
+            if(accept('.'))
+            {
+                double scale = .1;
+
+                while(m_pos < m_end && isdigit(static_cast<unsigned char>(*m_pos)))
+                {
+                    value += (*m_pos++ - '0') * scale;
+                    scale *= .1;
+                    digits = true;
+                }
+            }
+
+            if(!digits)
+                return false;
+
+            if(peek() == 'e' || peek() == 'E')
+            {
+                advance();
+
+                int64_t exponent = 0;
+
+                if(!read_integer(exponent))
+                    return false;
+
+                value *= pow(10., static_cast<double>(exponent));
+            }
+
+            a_value = negative ? -value : value;
+            return true;
+        }
+
+        bool read_float(float& a_value)
+        {
+            double value;
+
+            if(!read_number(value))
+                return false;
+
+            a_value = static_cast<float>(value);
+            return true;
+        }
+
+    private:
+
+        const char* m_pos;
+        const char* m_end;
+    };
+
+    // Just enough of a JSON document model for the glTF header
+
+    struct json
+    {
+        enum class kind : uint8_t
+        {
+            null,
+            boolean,
+            number,
+            string,
+            array,
+            object
+        };
+
+        const json* find(const char* a_key) const
+        {
+            for(size_t i = 0; i < keys.size(); ++i)
+                if(keys[i] == a_key)
+                    return &items[i];
+            return nullptr;
+        }
+
+        const json* at(size_t a_index) const
+        {
+            return type == kind::array && a_index < items.size() ? &items[a_index] : nullptr;
+        }
+
+        kind type = kind::null;
+        bool boolean = false;
+        double number = 0.;
+        std::string string;
+        std::vector<std::string> keys;
+        std::vector<json> items;
+    };
+
+    class json_parser
+    {
+    public:
+
+        json_parser(const char* a_begin, const char* a_end) : m_scanner{a_begin, a_end}
+        {}
+
+        json parse()
+        {
+            auto result = parse_value(0);
+
+            m_scanner.skip_whitespace();
+
+            if(!m_scanner.done() && m_scanner.peek() != '\0')
+                fail();
+
+            return result;
+        }
+
+    private:
+
+        constexpr static uint32_t max_depth = 64;
+
+        [[noreturn]] static void fail()
+        {
+            throw std::runtime_error{"Malformed glTF JSON chunk."};
+        }
+
+        json parse_value(uint32_t a_depth)
+        {
+            json result;
+
+            if(a_depth > max_depth)
+                fail();
+
+            m_scanner.skip_whitespace();
+
+            switch(m_scanner.peek())
+            {
+                case '{':
+                    m_scanner.advance();
+                    result.type = json::kind::object;
+                    m_scanner.skip_whitespace();
+                    if(m_scanner.accept('}'))
+                        break;
+                    do
+                    {
+                        m_scanner.skip_whitespace();
+                        result.keys.push_back(parse_string());
+                        m_scanner.skip_whitespace();
+                        if(!m_scanner.accept(':'))
+                            fail();
+                        result.items.push_back(parse_value(a_depth + 1));
+                        m_scanner.skip_whitespace();
+                    }
+                    while(m_scanner.accept(','));
+                    if(!m_scanner.accept('}'))
+                        fail();
+                    break;
+                case '[':
+                    m_scanner.advance();
+                    result.type = json::kind::array;
+                    m_scanner.skip_whitespace();
+                    if(m_scanner.accept(']'))
+                        break;
+                    do
+                    {
+                        result.items.push_back(parse_value(a_depth + 1));
+                        m_scanner.skip_whitespace();
+                    }
+                    while(m_scanner.accept(','));
+                    if(!m_scanner.accept(']'))
+                        fail();
+                    break;
+                case '"':
+                    result.type = json::kind::string;
+                    result.string = parse_string();
+                    break;
+                case 't':
+                case 'f':
+                    result.type = json::kind::boolean;
+                    result.boolean = m_scanner.accept_word("true");
+                    if(!result.boolean && !m_scanner.accept_word("false"))
+                        fail();
+                    break;
+                case 'n':
+                    if(!m_scanner.accept_word("null"))
+                        fail();
+                    break;
+                default:
+                    result.type = json::kind::number;
+                    if(!m_scanner.read_number(result.number))
+                        fail();
+                    break;
+            }
+
+            return result;
+        }
+
+        std::string parse_string()
+        {
+            std::string result;
+
+            if(!m_scanner.accept('"'))
+                fail();
+
+            while(!m_scanner.done() && m_scanner.peek() != '"')
+            {
+                char c = m_scanner.peek();
+                m_scanner.advance();
+
+                if(c != '\\')
+                {
+                    result.push_back(c);
+                    continue;
+                }
+
+                c = m_scanner.peek();
+                m_scanner.advance();
+
+                switch(c)
+                {
+                    case 'b': result.push_back('\b'); break;
+                    case 'f': result.push_back('\f'); break;
+                    case 'n': result.push_back('\n'); break;
+                    case 'r': result.push_back('\r'); break;
+                    case 't': result.push_back('\t'); break;
+                    case 'u':
+                    {
+                        // Only needed for names, encode the code unit as UTF-8 and ignore surrogate pairing
+
+                        uint32_t code = 0;
+
+                        for(int i = 0; i < 4; ++i, m_scanner.advance())
+                        {
+                            char h = m_scanner.peek();
+
+                            if(!isxdigit(static_cast<unsigned char>(h)))
+                                fail();
+
+                            code = code * 16 + (isdigit(static_cast<unsigned char>(h)) ? h - '0' :
+                                (tolower(static_cast<unsigned char>(h)) - 'a' + 10));
+                        }
+
+                        if(code < 0x80)
+                            result.push_back(static_cast<char>(code));
+                        else if(code < 0x800)
+                        {
+                            result.push_back(static_cast<char>(0xC0 | (code >> 6)));
+                            result.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                        }
+                        else
+                        {
+                            result.push_back(static_cast<char>(0xE0 | (code >> 12)));
+                            result.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                            result.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                        }
+                        break;
+                    }
+                    default: result.push_back(c); break;
+                }
+            }
+
+            if(!m_scanner.accept('"'))
+                fail();
+
+            return result;
+        }
+
+        scanner m_scanner;
+    };
+
+    size_t get_uint(const json* a_value, size_t a_default)
+    {
+        if(!a_value || a_value->type != json::kind::number || a_value->number < 0.)
+            return a_default;
+
+        return static_cast<size_t>(a_value->number);
+    }
+
+    // Typed view over the data of a glTF accessor
+
+    struct accessor
+    {
+        constexpr static uint32_t byte_type = 5120, ubyte_type = 5121, short_type = 5122, ushort_type = 5123,
+            uint_type = 5125, float_type = 5126;
+
+        static size_t component_size(uint32_t a_type)
+        {
+            switch(a_type)
+            {
+                case byte_type: case ubyte_type: return 1;
+                case short_type: case ushort_type: return 2;
+                case uint_type: case float_type: return 4;
+                default: return 0;
+            }
+        }
+
+        template<typename T>
+        T read(size_t a_element, uint32_t a_component) const
+        {
+            T value;
+            memcpy(&value, data + a_element * stride + a_component * sizeof(T), sizeof(T));
+            return value;
+        }
+
+        float get_float(size_t a_element, uint32_t a_component) const
+        {
+            if(a_component >= components)
+                return 0.f;
+
+            switch(component_type)
+            {
+                case float_type: return read<float>(a_element, a_component);
+                case ubyte_type: return read<uint8_t>(a_element, a_component) / 255.f;
+                case ushort_type: return read<uint16_t>(a_element, a_component) / 65535.f;
+                case byte_type: return std::max(read<int8_t>(a_element, a_component) / 127.f, -1.f);
+                case short_type: return std::max(read<int16_t>(a_element, a_component) / 32767.f, -1.f);
+                default: return 0.f;
+            }
+        }
+
+        uint32_t get_index(size_t a_element) const
+        {
+            switch(component_type)
+            {
+                case ubyte_type: return read<uint8_t>(a_element, 0);
+                case ushort_type: return read<uint16_t>(a_element, 0);
+                case uint_type: return read<uint32_t>(a_element, 0);
+                default: throw std::runtime_error{"Unsupported index component type."};
+            }
+        }
+
+        const uint8_t* data = nullptr;
+        size_t count = 0;
+        size_t stride = 0;
+        uint32_t component_type = 0;
+        uint32_t components = 0;
+    };
+
+    accessor get_accessor(const json& a_root, size_t a_index, const uint8_t* a_bin, size_t a_bin_size)
+    {
+        auto fail = [](const char* a_reason) {
+            throw std::runtime_error{std::string{"Invalid glTF accessor: "} + a_reason};
+        };
+
+        auto accessors = a_root.find("accessors");
+        auto desc = accessors ? accessors->at(a_index) : nullptr;
+
+        if(!desc)
+            fail("missing");
+
+        if(desc->find("sparse"))
+            fail("sparse accessors are not supported");
+
+        auto views = a_root.find("bufferViews");
+        auto view = views ? views->at(get_uint(desc->find("bufferView"), SIZE_MAX)) : nullptr;
+
+        if(!view)
+            fail("missing buffer view");
+
+        // Only the buffer embedded in the binary container is available
+
+        if(get_uint(view->find("buffer"), SIZE_MAX) != 0)
+            fail("external buffers are not supported");
+
+        auto type = desc->find("type");
+
+        if(!type || type->type != json::kind::string)
+            fail("missing type");
+
+        accessor result;
+
+        if(type->string == "SCALAR") result.components = 1;
+        else if(type->string == "VEC2") result.components = 2;
+        else if(type->string == "VEC3") result.components = 3;
+        else if(type->string == "VEC4") result.components = 4;
+        else fail("unsupported type");
+
+        result.component_type = static_cast<uint32_t>(get_uint(desc->find("componentType"), 0));
+        result.count = get_uint(desc->find("count"), 0);
+
+        auto element_size = accessor::component_size(result.component_type) * result.components;
+
+        if(element_size == 0)
+            fail("unsupported component type");
+
+        auto view_offset = get_uint(view->find("byteOffset"), 0);
+        auto view_length = get_uint(view->find("byteLength"), 0);
+        auto offset = get_uint(desc->find("byteOffset"), 0);
+
+        result.stride = get_uint(view->find("byteStride"), element_size);
+
+        if(result.stride < element_size)
+            fail("stride smaller than element");
+
+        // Written so that no term can overflow, counts come straight from the file
+
+        if(result.count > 0 && (view_offset > a_bin_size || view_length > a_bin_size - view_offset ||
+            offset > view_length || element_size > view_length - offset ||
+            result.count > (view_length - offset - element_size) / result.stride + 1))
+            fail("data out of bounds");
+
+        result.data = a_bin + view_offset + offset;
+
+        return result;
+    }
+}
+
+namespace graphics{ namespace data{
+
+    raw_mesh parse_obj(const char* a_data, size_t a_size)
+    {
+        raw_mesh result;
+
+        std::vector<glm::vec4> positions;
+        std::vector<glm::vec4> colors;
+        std::vector<glm::vec2> tex_coords;
+
+        // A vertex is a distinct (position, texture coordinate) pair
+
+        std::unordered_map<uint64_t, uint32_t> corners;
+        std::vector<uint32_t> polygon;
+
+        scanner scan{a_data, a_data + a_size};
+        size_t line = 0;
+
+        auto fail = [&](const char* a_reason) {
+            throw std::runtime_error{"OBJ parse error at line " + std::to_string(line) + ": " + a_reason};
+        };
+
+        auto resolve = [&](int64_t a_index, size_t a_count) -> uint32_t {
+            auto index = a_index < 0 ? static_cast<int64_t>(a_count) + a_index : a_index - 1;
+            if(index < 0 || index >= static_cast<int64_t>(a_count))
+                fail("index out of range");
+            return static_cast<uint32_t>(index);
+        };
+
+        while(!scan.done())
+        {
+            line++;
+            scan.skip_blanks();
+
+            if(scan.accept_word("v ") || scan.accept_word("v\t"))
+            {
+                float values[7] = {0.f, 0.f, 0.f, 1.f, 1.f, 1.f, 1.f};
+                int count = 0;
+
+                while(count < 7 && !scan.at_line_end())
+                    if(!scan.read_float(values[count++]))
+                        fail("malformed vertex");
+
+                if(count < 3)
+                    fail("vertex with less than three coordinates");
+
+                positions.emplace_back(values[0], values[1], values[2], 1.f);
+
+                if(count >= 6)
+                    colors.emplace_back(values[3], values[4], values[5], 1.f);
+                else
+                    colors.emplace_back(1.f, 1.f, 1.f, 1.f);
+            }
+            else if(scan.accept_word("vt "))
+            {
+                float u = 0.f, v = 0.f;
+
+                if(!scan.read_float(u) || (!scan.at_line_end() && !scan.read_float(v)))
+                    fail("malformed texture coordinate");
+
+                tex_coords.emplace_back(u, 1.f - v);
+            }
+            else if(scan.accept_word("f "))
+            {
+                polygon.clear();
+
+                while(!scan.at_line_end())
+                {
+                    int64_t position = 0, tex_coord = 0, normal = 0;
+
+                    if(!scan.read_integer(position))
+                        fail("malformed face");
+
+                    uint32_t t_index = UINT32_MAX;
+
+                    if(scan.accept('/'))
+                    {
+                        if(scan.peek() != '/')
+                        {
+                            if(!scan.read_integer(tex_coord))
+                                fail("malformed face");
+                            t_index = resolve(tex_coord, tex_coords.size());
+                        }
+
+                        if(scan.accept('/') && !scan.read_integer(normal))
+                            fail("malformed face");
+                    }
+
+                    auto p_index = resolve(position, positions.size());
+                    auto key = (static_cast<uint64_t>(p_index) << 32u) | t_index;
+                    auto found = corners.find(key);
+
+                    if(found == corners.end())
+                    {
+                        found = corners.emplace(key, static_cast<uint32_t>(result.vertices.size())).first;
+                        result.vertices.push_back({positions[p_index], colors[p_index],
+                            t_index != UINT32_MAX ? tex_coords[t_index] : glm::vec2{0.f, 0.f}});
+                    }
+
+                    polygon.push_back(found->second);
+                }
+
+                if(polygon.size() < 3)
+                    fail("face with less than three vertices");
+
+                for(size_t i = 1; i + 1 < polygon.size(); ++i)
+                {
+                    result.indices.push_back(polygon[0]);
+                    result.indices.push_back(polygon[i]);
+                    result.indices.push_back(polygon[i + 1]);
+                }
+            }
+
+            scan.skip_line();
+        }
+
+        if(result.indices.empty())
+            throw std::runtime_error{"OBJ file contains no faces."};
+
+        return result;
+    }
+
+    bool is_glb(const uint8_t* a_data, size_t a_size)
+    {
+        return a_size >= 12 && memcmp(a_data, "glTF", 4) == 0;
+    }
+
+    raw_mesh parse_glb(const uint8_t* a_data, size_t a_size)
+    {
+        constexpr uint32_t json_chunk = 0x4E4F534A, bin_chunk = 0x004E4942;
+
+        auto read_u32 = [&](size_t a_offset) {
+            uint32_t value;
+            memcpy(&value, a_data + a_offset, sizeof(value));
+            return value;
+        };
+
+        if(!is_glb(a_data, a_size) || read_u32(4) != 2)
+            throw std::runtime_error{"Not a glTF 2.0 binary file."};
+
+        size_t length = std::min<size_t>(read_u32(8), a_size);
+
+        const char* json_data = nullptr;
+        size_t json_size = 0;
+        const uint8_t* bin_data = nullptr;
+        size_t bin_size = 0;
+
+        for(size_t offset = 12; offset + 8 <= length;)
+        {
+            auto chunk_size = read_u32(offset);
+            auto chunk_type = read_u32(offset + 4);
+
+            if(offset + 8 + chunk_size > length)
+                throw std::runtime_error{"Truncated glTF chunk."};
+
+            if(chunk_type == json_chunk && !json_data)
+            {
+                json_data = reinterpret_cast<const char*>(a_data + offset + 8);
+                json_size = chunk_size;
+            }
+            else if(chunk_type == bin_chunk && !bin_data)
+            {
+                bin_data = a_data + offset + 8;
+                bin_size = chunk_size;
+            }
+
+            offset += 8 + ((chunk_size + 3u) & ~3u);
+        }
+
+        if(!json_data)
+            throw std::runtime_error{"glTF file has no JSON chunk."};
+
+        auto root = json_parser{json_data, json_data + json_size}.parse();
+
+        raw_mesh result;
+
+        auto meshes = root.find("meshes");
+
+        for(size_t m = 0; meshes && m < meshes->items.size(); ++m)
+        {
+            auto primitives = meshes->items[m].find("primitives");
+
+            for(size_t p = 0; primitives && p < primitives->items.size(); ++p)
+            {
+                auto& primitive = primitives->items[p];
+                auto attributes = primitive.find("attributes");
+
+                // Only triangle lists, the default mode
+
+                if(get_uint(primitive.find("mode"), 4) != 4 || !attributes || !attributes->find("POSITION"))
+                    continue;
+
+                auto positions = get_accessor(root, get_uint(attributes->find("POSITION"), 0), bin_data,
+                    bin_size);
+
+                if(positions.components != 3 || positions.component_type != accessor::float_type)
+                    throw std::runtime_error{"glTF positions must be float triplets."};
+
+                auto uv_index = attributes->find("TEXCOORD_0");
+                auto color_index = attributes->find("COLOR_0");
+
+                accessor uvs, colors;
+
+                if(uv_index)
+                    uvs = get_accessor(root, get_uint(uv_index, 0), bin_data, bin_size);
+                if(color_index)
+                    colors = get_accessor(root, get_uint(color_index, 0), bin_data, bin_size);
+
+                if((uv_index && uvs.count != positions.count) || (color_index && colors.count != positions.count))
+                    throw std::runtime_error{"glTF attribute counts don't match."};
+
+                auto base = static_cast<uint32_t>(result.vertices.size());
+
+                for(size_t i = 0; i < positions.count; ++i)
+                {
+                    vertex_format vertex{
+                        {positions.get_float(i, 0), positions.get_float(i, 1), positions.get_float(i, 2), 1.f},
+                        {1.f, 1.f, 1.f, 1.f},
+                        {0.f, 0.f}
+                    };
+
+                    if(uv_index)
+                        vertex.tex_coords = {uvs.get_float(i, 0), uvs.get_float(i, 1)};
+
+                    if(color_index)
+                        vertex.color = {colors.get_float(i, 0), colors.get_float(i, 1), colors.get_float(i, 2),
+                            colors.components == 4 ? colors.get_float(i, 3) : 1.f};
+
+                    result.vertices.push_back(vertex);
+                }
+
+                if(auto indices_index = primitive.find("indices"))
+                {
+                    auto indices = get_accessor(root, get_uint(indices_index, 0), bin_data, bin_size);
+
+                    if(indices.components != 1 || (indices.component_type != accessor::ubyte_type &&
+                        indices.component_type != accessor::ushort_type &&
+                        indices.component_type != accessor::uint_type))
+                        throw std::runtime_error{"glTF indices must be unsigned integers."};
+
+                    for(size_t i = 0; i + 2 < indices.count; i += 3)
+                        for(size_t k = 0; k < 3; ++k)
+                        {
+                            auto index = indices.get_index(i + k);
+
+                            if(index >= positions.count)
+                                throw std::runtime_error{"glTF index out of range."};
+
+                            result.indices.push_back(base + index);
+                        }
+                }
+                else
+                {
+                    for(size_t i = 0; i + 2 < positions.count; i += 3)
+                        for(uint32_t k = 0; k < 3; ++k)
+                            result.indices.push_back(base + static_cast<uint32_t>(i) + k);
+                }
+            }
+        }
+
+        if(result.indices.empty())
+            throw std::runtime_error{"glTF file contains no triangle primitives."};
+
+        return result;
+    }
+}}
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_MESH_FORMATS_HPP
+#define NCV_MESH_FORMATS_HPP
+
+#include <graphics/data/vertex.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace graphics{ namespace data{
+
+    // Indexed triangle list as read from a file, before any deduplication or reordering
+
+    struct raw_mesh
+    {
+        std::vector<vertex_format> vertices;
+        std::vector<uint32_t> indices;
+    };
+
+    // Wavefront OBJ. Positions (with the common "v x y z r g b" color extension), texture coordinates and
+    // polygonal faces (fan triangulated) are read, everything else is ignored. Texture coordinates are flipped
+    // to the Vulkan convention (origin at the top left).
+
+    raw_mesh parse_obj(const char* a_data, size_t a_size);
+
+    // glTF 2.0 binary container. Every triangle primitive of every mesh is read (POSITION, TEXCOORD_0, COLOR_0
+    // and indices) from the embedded buffer, node transforms are not applied.
+
+    raw_mesh parse_glb(const uint8_t* a_data, size_t a_size);
+
+    bool is_glb(const uint8_t* a_data, size_t a_size);
+}}
+
+#endif //NCV_MESH_FORMATS_HPP
@@ -0,0 +1,252 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <graphics/data/mesh_optimizer.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    // Scoring constants as proposed in the original paper
+
+    constexpr float cache_decay_power = 1.5f;
+    constexpr float last_triangle_score = .75f;
+    constexpr float valence_boost_scale = 2.f;
+    constexpr float valence_boost_power = .5f;
+
+    constexpr uint32_t no_triangle = UINT32_MAX;
+
+    float vertex_score(int32_t a_cache_position, uint32_t a_active_triangles)
+    {
+        using graphics::data::vertex_cache_size;
+
+        // No triangle needs this vertex anymore
+
+        if(a_active_triangles == 0)
+            return -1.f;
+
+        float score = 0.f;
+
+        if(a_cache_position >= 0)
+        {
+            // The last triangle's vertices get a fixed score, to discourage picking it again in a strip-like way
+
+            if(a_cache_position < 3)
+                score = last_triangle_score;
+            else
+                score = powf(1.f - static_cast<float>(a_cache_position - 3) / (vertex_cache_size - 3),
+                    cache_decay_power);
+        }
+
+        // Vertices with few triangles left get a boost, so that they are finished off and evicted early
+
+        score += valence_boost_scale * powf(static_cast<float>(a_active_triangles), -valence_boost_power);
+
+        return score;
+    }
+}
+
+namespace graphics{ namespace data{
+
+    float compute_acmr(const std::vector<uint32_t>& a_indices, size_t a_cache_size)
+    {
+        if(a_indices.size() < 3)
+            return 0.f;
+
+        std::vector<uint32_t> cache;
+        size_t misses = 0;
+
+        cache.reserve(a_cache_size);
+
+        for(auto index : a_indices)
+        {
+            if(std::find(cache.begin(), cache.end(), index) != cache.end())
+                continue;
+
+            misses++;
+
+            if(cache.size() == a_cache_size)
+                cache.erase(cache.begin());
+
+            cache.push_back(index);
+        }
+
+        return static_cast<float>(misses) / static_cast<float>(a_indices.size() / 3);
+    }
+
+    std::vector<uint32_t> optimize_vertex_cache(const std::vector<uint32_t>& a_indices, size_t a_vertex_count)
+    {
+        auto triangle_count = a_indices.size() / 3;
+
+        if(a_indices.size() % 3 != 0)
+            throw std::runtime_error{"Index count is not a multiple of three."};
+
+        // Triangles adjacent to each vertex, as ranges in a single array. Entries of emitted triangles are
+        // swapped out of the active part of the range.
+
+        std::vector<uint32_t> active(a_vertex_count, 0);
+
+        for(auto index : a_indices)
+        {
+            if(index >= a_vertex_count)
+                throw std::runtime_error{"Index out of range."};
+
+            active[index]++;
+        }
+
+        std::vector<uint32_t> offsets(a_vertex_count + 1, 0);
+
+        for(size_t i = 0; i < a_vertex_count; ++i)
+            offsets[i + 1] = offsets[i] + active[i];
+
+        std::vector<uint32_t> adjacency(a_indices.size());
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+
+        for(size_t t = 0; t < triangle_count; ++t)
+            for(size_t k = 0; k < 3; ++k)
+                adjacency[fill[a_indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+
+        std::vector<int32_t> cache_position(a_vertex_count, -1);
+        std::vector<float> v_scores(a_vertex_count);
+        std::vector<float> t_scores(triangle_count);
+        std::vector<bool> emitted(triangle_count, false);
+
+        for(size_t v = 0; v < a_vertex_count; ++v)
+            v_scores[v] = vertex_score(-1, active[v]);
+
+        uint32_t best = no_triangle;
+        float best_score = -1.f;
+
+        for(size_t t = 0; t < triangle_count; ++t)
+        {
+            t_scores[t] = v_scores[a_indices[t * 3]] + v_scores[a_indices[t * 3 + 1]] +
+                v_scores[a_indices[t * 3 + 2]];
+
+            if(t_scores[t] > best_score)
+            {
+                best_score = t_scores[t];
+                best = static_cast<uint32_t>(t);
+            }
+        }
+
+        std::vector<uint32_t> result;
+        std::vector<uint32_t> cache, next_cache;
+        size_t cursor = 0;
+
+        result.reserve(a_indices.size());
+        cache.reserve(vertex_cache_size + 3);
+        next_cache.reserve(vertex_cache_size + 3);
+
+        for(size_t emitted_count = 0; emitted_count < triangle_count; ++emitted_count)
+        {
+            // Dead end, none of the cached vertices has triangles left. Continue with the next triangle in
+            // input order, which keeps the restart linear.
+
+            if(best == no_triangle)
+            {
+                while(emitted[cursor])
+                    cursor++;
+
+                best = static_cast<uint32_t>(cursor);
+            }
+
+            const uint32_t* tri = &a_indices[best * 3];
+
+            result.insert(result.end(), tri, tri + 3);
+            emitted[best] = true;
+
+            for(size_t k = 0; k < 3; ++k)
+            {
+                auto v = tri[k];
+                auto begin = adjacency.begin() + offsets[v];
+                auto end = begin + active[v];
+
+                std::iter_swap(std::find(begin, end, best), end - 1);
+                active[v]--;
+            }
+
+            // Emitted vertices go to the front, the rest keep their relative order and may be pushed out
+
+            next_cache.assign(tri, tri + 3);
+
+            for(auto v : cache)
+                if(v != tri[0] && v != tri[1] && v != tri[2])
+                    next_cache.push_back(v);
+
+            for(size_t i = 0; i < next_cache.size(); ++i)
+            {
+                auto v = next_cache[i];
+
+                cache_position[v] = i < vertex_cache_size ? static_cast<int32_t>(i) : -1;
+                v_scores[v] = vertex_score(cache_position[v], active[v]);
+            }
+
+            // Only triangles touching the cache have changed scores, the next pick is the best among them
+
+            best = no_triangle;
+            best_score = -1.f;
+
+            for(auto v : next_cache)
+            {
+                for(uint32_t i = 0; i < active[v]; ++i)
+                {
+                    auto t = adjacency[offsets[v] + i];
+
+                    t_scores[t] = v_scores[a_indices[t * 3]] + v_scores[a_indices[t * 3 + 1]] +
+                        v_scores[a_indices[t * 3 + 2]];
+
+                    if(t_scores[t] > best_score)
+                    {
+                        best_score = t_scores[t];
+                        best = t;
+                    }
+                }
+            }
+
+            if(next_cache.size() > vertex_cache_size)
+                next_cache.resize(vertex_cache_size);
+
+            std::swap(cache, next_cache);
+        }
+
+        return result;
+    }
+
+    std::vector<uint32_t> optimize_vertex_fetch(std::vector<uint32_t>& a_indices, size_t a_vertex_count,
+        size_t& a_used_vertex_count)
+    {
+        std::vector<uint32_t> remap(a_vertex_count, UINT32_MAX);
+        uint32_t next = 0;
+
+        for(auto& index : a_indices)
+        {
+            if(index >= a_vertex_count)
+                throw std::runtime_error{"Index out of range."};
+
+            if(remap[index] == UINT32_MAX)
+                remap[index] = next++;
+
+            index = remap[index];
+        }
+
+        a_used_vertex_count = next;
+
+        return remap;
+    }
+}}
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_MESH_OPTIMIZER_HPP
+#define NCV_MESH_OPTIMIZER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace graphics{ namespace data{
+
+    // Triangle list reordering and vertex cache statistics. Free of platform dependencies, all functions
+    // operate on 32-bit triangle list indices.
+
+    constexpr size_t vertex_cache_size = 32;
+
+    // Average number of vertex shader invocations per triangle for a FIFO post-transform cache of the given
+    // size. Ranges from 0.5 (ideal, large regular grids) to 3 (no reuse at all).
+
+    float compute_acmr(const std::vector<uint32_t>& a_indices, size_t a_cache_size = vertex_cache_size);
+
+    // Reorders the triangles for post-transform cache reuse, using Tom Forsyth's linear-speed vertex cache
+    // optimization. Triangle winding is preserved.
+
+    std::vector<uint32_t> optimize_vertex_cache(const std::vector<uint32_t>& a_indices, size_t a_vertex_count);
+
+    // Numbers the vertices in order of first use, so that fetches walk the vertex buffer linearly. Returns
+    // the remap table (old index to new index, unused vertices are dropped) and rewrites the indices.
+
+    std::vector<uint32_t> optimize_vertex_fetch(std::vector<uint32_t>& a_indices, size_t a_vertex_count,
+        size_t& a_used_vertex_count);
+
+    template<typename T>
+    std::vector<T> remap_vertices(const std::vector<T>& a_vertices, const std::vector<uint32_t>& a_remap,
+        size_t a_used_vertex_count)
+    {
+        std::vector<T> result(a_used_vertex_count);
+
+        for(size_t i = 0; i < a_remap.size(); ++i)
+            if(a_remap[i] != UINT32_MAX)
+                result[a_remap[i]] = a_vertices[i];
+
+        return result;
+    }
+}}
+
+#endif //NCV_MESH_OPTIMIZER_HPP
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <graphics/data/mip_chain.hpp>
+
+#include <algorithm>
+#include <cstddef>
+
+namespace graphics{ namespace data{
+
+    uint32_t mip_count(uint32_t a_width, uint32_t a_height)
+    {
+        uint32_t levels = 1;
+
+        for(auto size = std::max(a_width, a_height); size > 1; size /= 2)
+            levels++;
+
+        return levels;
+    }
+
+    void downsample(const uint8_t *a_src, uint32_t a_width, uint32_t a_height, uint32_t a_channels, uint8_t *a_dst)
+    {
+        auto width = std::max(a_width / 2, 1u), height = std::max(a_height / 2, 1u);
+
+        // Odd edges and 1 texel wide levels reuse the last row/column instead of reading past it
+
+        for(uint32_t y = 0; y < height; ++y)
+        {
+            auto row0 = a_src + static_cast<size_t>(std::min(y * 2, a_height - 1)) * a_width * a_channels;
+            auto row1 = a_src + static_cast<size_t>(std::min(y * 2 + 1, a_height - 1)) * a_width * a_channels;
+
+            for(uint32_t x = 0; x < width; ++x)
+            {
+                auto x0 = std::min(x * 2, a_width - 1) * a_channels;
+                auto x1 = std::min(x * 2 + 1, a_width - 1) * a_channels;
+
+                for(uint32_t c = 0; c < a_channels; ++c)
+                {
+                    auto sum = row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+                    *a_dst++ = static_cast<uint8_t>((sum + 2) / 4);
+                }
+            }
+        }
+    }
+}}
@@ -0,0 +1,37 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_MIP_CHAIN_HPP
+#define NCV_MIP_CHAIN_HPP
+
+#include <cstdint>
+
+namespace graphics{ namespace data{
+
+    // CPU side of mipmapping, for formats the device can't blit. Free of platform dependencies.
+
+    // Levels of a full chain down to 1x1
+
+    uint32_t mip_count(uint32_t a_width, uint32_t a_height);
+
+    // 2x2 box filter of 8 bit channels into a (max(w/2,1) x max(h/2,1)) image. Values are averaged as
+    // stored, sRGB data darkens slightly compared to filtering in linear space.
+
+    void downsample(const uint8_t* a_src, uint32_t a_width, uint32_t a_height, uint32_t a_channels, uint8_t* a_dst);
+}}
+
+#endif //NCV_MIP_CHAIN_HPP
@@ -0,0 +1,174 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <graphics/data/scene_graph.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace graphics{ namespace data{
+
+    void scene_graph::dirty_range::merge(const dirty_range &a_other)
+    {
+        if(a_other.empty())
+            return;
+
+        if(empty())
+        {
+            *this = a_other;
+            return;
+        }
+
+        first = std::min(first, a_other.first);
+        last = std::max(last, a_other.last);
+    }
+
+    scene_graph::node_id scene_graph::add_node(node_id a_parent)
+    {
+        if(a_parent != no_parent && a_parent >= size())
+            throw std::runtime_error{"Scene node parent doesn't exist."};
+
+        auto node = static_cast<node_id>(size());
+
+        m_parents.push_back(a_parent);
+        m_flags.push_back(local_dirty);
+        m_local.emplace_back(1.f);
+        m_world.emplace_back(1.f);
+        m_locals.resize(size());
+
+        m_first_dirty = std::min(m_first_dirty, node);
+
+        return node;
+    }
+
+    void scene_graph::clear()
+    {
+        m_locals.resize(0);
+        m_parents.clear();
+        m_flags.clear();
+        m_local.clear();
+        m_world.clear();
+        m_first_dirty = no_parent;
+    }
+
+    void scene_graph::set(node_id a_node, const glm::vec3 &a_translation, const glm::quat &a_rotation,
+        const glm::vec3 &a_scale)
+    {
+        m_locals.set(a_node, a_translation, a_rotation, a_scale);
+        mark_dirty(a_node);
+    }
+
+    void scene_graph::set_translation(node_id a_node, const glm::vec3 &a_translation)
+    {
+        m_locals.set_translation(a_node, a_translation);
+        mark_dirty(a_node);
+    }
+
+    void scene_graph::set_rotation(node_id a_node, const glm::quat &a_rotation)
+    {
+        m_locals.set_rotation(a_node, a_rotation);
+        mark_dirty(a_node);
+    }
+
+    void scene_graph::set_scale(node_id a_node, const glm::vec3 &a_scale)
+    {
+        m_locals.set_scale(a_node, a_scale);
+        mark_dirty(a_node);
+    }
+
+    void scene_graph::mark_dirty(node_id a_node)
+    {
+        m_flags[a_node] = local_dirty;
+        m_first_dirty = std::min(m_first_dirty, a_node);
+    }
+
+    scene_graph::dirty_range scene_graph::update()
+    {
+        m_stats.updates++;
+
+        if(m_first_dirty >= size())
+        {
+            m_stats.clean_updates++;
+            return {};
+        }
+
+        auto count = static_cast<node_id>(size());
+        dirty_range changed{m_first_dirty, m_first_dirty};
+
+        // Flag pass: children of dirty nodes inherit, parents precede children so one pass is enough. Runs of
+        // locally dirty nodes are composed together.
+
+        node_id run_first = no_parent;
+
+        for(node_id i = m_first_dirty; i <= count; ++i)
+        {
+            bool local = i < count && m_flags[i] == local_dirty;
+
+            if(local && run_first == no_parent)
+                run_first = i;
+            else if(!local && run_first != no_parent)
+            {
+                m_locals.compute_models(&m_local[run_first][0][0], run_first, i - run_first);
+                m_stats.locals_computed += i - run_first;
+                run_first = no_parent;
+            }
+
+            if(i == count)
+                break;
+
+            auto parent = m_parents[i];
+
+            if(m_flags[i] == clean && parent != no_parent && m_flags[parent] != clean)
+                m_flags[i] = parent_dirty;
+
+            if(m_flags[i] != clean)
+                changed.last = i + 1;
+        }
+
+        // World pass, flags are cleared behind it. Parents are visited first, so their flags are still
+        // readable when their children need them.
+
+        for(node_id i = m_first_dirty; i < changed.last; ++i)
+        {
+            if(m_flags[i] == clean)
+                continue;
+
+            auto parent = m_parents[i];
+
+            m_world[i] = parent == no_parent ? m_local[i] : m_world[parent] * m_local[i];
+            m_stats.worlds_computed++;
+        }
+
+        std::fill(m_flags.begin() + m_first_dirty, m_flags.begin() + changed.last, clean);
+        m_first_dirty = no_parent;
+
+        return changed;
+    }
+
+    void scene_graph::copy_world(const dirty_range &a_range, glm::mat4 *a_dst) const
+    {
+        if(a_range.empty())
+            return;
+
+        if(a_range.last > size())
+            throw std::runtime_error{"Scene range out of bounds."};
+
+        memcpy(a_dst + a_range.first, m_world.data() + a_range.first,
+            (a_range.last - a_range.first) * sizeof(glm::mat4));
+    }
+}}
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_SCENE_GRAPH_HPP
+#define NCV_SCENE_GRAPH_HPP
+
+#include <graphics/data/transform_batch.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace graphics{ namespace data{
+
+    // Node hierarchy with local (TRS) and world transforms. Nodes live in flat arrays, a parent is always
+    // created before its children so a single forward pass propagates changes. Setters only flag nodes,
+    // update() recomputes dirty locals with the batch kernels and world matrices of dirty subtrees, and returns
+    // the range of world matrices that changed. Nothing dirty means update() returns right away.
+
+    class scene_graph
+    {
+    public:
+
+        using node_id = uint32_t;
+
+        static constexpr node_id no_parent = std::numeric_limits<node_id>::max();
+
+        // Half open [first, last) span of node indices, merged by consumers that upload at their own pace
+        // (e.g. one instance buffer per swapchain image).
+
+        struct dirty_range
+        {
+            node_id first = 0;
+            node_id last = 0;
+
+            static dirty_range all(size_t a_count) { return {0, static_cast<node_id>(a_count)}; }
+
+            bool empty() const { return first >= last; }
+            bool contains(node_id a_node) const { return a_node >= first && a_node < last; }
+            void clear() { first = last = 0; }
+            void merge(const dirty_range& a_other);
+        };
+
+        struct statistics
+        {
+            uint64_t updates = 0;
+            uint64_t clean_updates = 0;
+            uint64_t locals_computed = 0;
+            uint64_t worlds_computed = 0;
+        };
+
+        node_id add_node(node_id a_parent = no_parent);
+        size_t size() const { return m_parents.size(); }
+        void clear();
+
+        void set(node_id a_node, const glm::vec3& a_translation, const glm::quat& a_rotation,
+            const glm::vec3& a_scale);
+        void set_translation(node_id a_node, const glm::vec3& a_translation);
+        void set_rotation(node_id a_node, const glm::quat& a_rotation);
+        void set_scale(node_id a_node, const glm::vec3& a_scale);
+
+        dirty_range update();
+
+        node_id get_parent(node_id a_node) const { return m_parents[a_node]; }
+        const glm::mat4& get_world(node_id a_node) const { return m_world[a_node]; }
+        const std::vector<glm::mat4>& get_worlds() const { return m_world; }
+        const statistics& get_statistics() const { return m_stats; }
+
+        // Writes the world matrices of a_range to a_dst, indexed by node, e.g. a mapped instance buffer
+
+        void copy_world(const dirty_range& a_range, glm::mat4* a_dst) const;
+
+    private:
+
+        enum flag : uint8_t
+        {
+            clean = 0,
+            local_dirty = 1,
+            parent_dirty = 2
+        };
+
+        void mark_dirty(node_id a_node);
+
+        transform_batch m_locals;
+        std::vector<node_id> m_parents;
+        std::vector<uint8_t> m_flags;
+        std::vector<glm::mat4> m_local;
+        std::vector<glm::mat4> m_world;
+        node_id m_first_dirty = no_parent;
+        statistics m_stats;
+    };
+}}
+
+#endif //NCV_SCENE_GRAPH_HPP
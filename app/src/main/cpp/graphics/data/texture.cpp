@@ -17,45 +17,165 @@
 
 #include <graphics/data/texture.hpp>
 
+#include <android_native_app_glue.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include <unistd.h>
+
+namespace
+{
+    // Image sized allocations (decoded pixels) start and end on page boundaries, so they can be imported as
+    // device memory without sharing pages with unrelated heap data. Decoder scratch stays on plain malloc, and
+    // since posix_memalign memory is released by free/realloc, the other two hooks don't care which one they get.
+
+    constexpr size_t aligned_threshold = 64 * 1024;
+
+    void* stbi_aligned_malloc(size_t a_size)
+    {
+        if(a_size < aligned_threshold)
+            return malloc(a_size);
+
+        static const auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+        void* result = nullptr;
+
+        if(posix_memalign(&result, page_size, (a_size + page_size - 1) & ~(page_size - 1)))
+            return nullptr;
+
+        return result;
+    }
+}
+
 #define STB_IMAGE_IMPLEMENTATION
+#define STBI_MALLOC(sz) stbi_aligned_malloc(sz)
+#define STBI_REALLOC(p, newsz) realloc(p, newsz)
+#define STBI_FREE(p) free(p)
 
 #include <stb/stb_image.h>
-#include <android_native_app_glue.h>
 
 namespace graphics{ namespace data{
 
-    texture::texture(AAssetManager *a_ass_mgr, const std::string &a_filename)
+    texture::texture(AAssetManager *a_ass_mgr, const std::string &a_filename,
+        const ktx2::format_filter& a_supported)
     {
+        auto start = std::chrono::steady_clock::now();
+
         AAsset* file = AAssetManager_open(a_ass_mgr, a_filename.c_str(), AASSET_MODE_BUFFER);
 
         if(!file)
             throw std::runtime_error{"Unknown error. Couldn't open texture file."};
 
-        auto file_data = std::vector<stbi_uc>(AAsset_getLength(file));
+        std::shared_ptr<AAsset> asset{file, &AAsset_close};
 
-        if(AAsset_read(file, file_data.data(), file_data.size()) != file_data.size())
-        {
-            AAsset_close(file);
+        // Decode straight out of the asset's buffer (mapped when the asset is stored uncompressed)
+
+        auto file_data = static_cast<const uint8_t*>(AAsset_getBuffer(file));
+
+        if(!file_data)
             throw std::runtime_error{"Unknown error. Couldn't read from texture file."};
-        }
 
-        AAsset_close(file);
+        load({file_data, static_cast<size_t>(AAsset_getLength(file))}, asset, !AAsset_isAllocated(file), a_supported);
+
+        m_decode_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    texture::texture(std::shared_ptr<const asset_pack> a_pack, const std::string &a_name,
+        const ktx2::format_filter &a_supported)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<uint8_t> storage;
+        auto contents = a_pack->read(a_name, storage);
+
+        // Moving the vector keeps its buffer, so contents stays valid with either owner. Without it the contents
+        // are the pack's mapping.
+
+        std::shared_ptr<const void> owner = a_pack;
+        auto mapped = storage.empty();
+
+        if(!mapped)
+            owner = std::make_shared<std::vector<uint8_t>>(std::move(storage));
+
+        load(contents, owner, mapped, a_supported);
+
+        m_decode_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    texture::texture(uint32_t a_width, uint32_t a_height, uint32_t a_rgba)
+    {
+        auto count = static_cast<size_t>(a_width) * a_height;
+
+        // Same allocator stb_image uses, so both kinds share the deleter
+
+        auto pixels = static_cast<stbi_uc*>(STBI_MALLOC(count * 4));
+
+        if(!pixels)
+            throw std::runtime_error{"Could not allocate texture."};
+
+        m_data.reset(pixels, &free_pixels);
+
+        for(size_t i = 0; i < count; ++i)
+            memcpy(pixels + i * 4, &a_rgba, 4);
+
+        m_extent = {a_width, a_height, 1};
+        m_levels.push_back({0, count * 4, m_extent});
+    }
+
+    utilities::span<const texture::stbi_uc> texture::get_level(size_t a_level) const
+    {
+        if(!m_data || a_level >= m_levels.size())
+            return {};
+
+        return {m_data.get() + m_levels[a_level].offset, m_levels[a_level].size};
+    }
+
+    void texture::load(utilities::span<const uint8_t> a_contents, std::shared_ptr<const void> a_owner, bool a_mapped,
+        const ktx2::format_filter &a_supported)
+    {
+        if(ktx2::is_ktx2(a_contents))
+        {
+            auto image = prepare_ktx2(ktx2{a_contents}, a_contents, a_supported);
+
+            // Levels uploaded as stored point into the contents, whose owner is kept until release()
+
+            if(image.data.empty())
+            {
+                m_data = std::shared_ptr<const stbi_uc>{a_owner, a_contents.data()};
+                m_file_mapped = a_mapped;
+            }
+            else
+            {
+                auto transcoded = std::make_shared<std::vector<uint8_t>>(std::move(image.data));
+                m_data = std::shared_ptr<const stbi_uc>{transcoded, transcoded->data()};
+            }
+
+            for(auto& level : image.levels)
+                m_levels.push_back({level.offset, level.size, {level.width, level.height, 1}});
+
+            m_format = image.format;
+            m_extent = {image.width, image.height, 1};
+            return;
+        }
 
         int tex_width, tex_height, tex_channels;
 
-        auto cvt_data = stbi_load_from_memory(file_data.data(), file_data.size(), &tex_height, &tex_width,
-            &tex_channels, STBI_rgb_alpha);
+        auto cvt_data = stbi_load_from_memory(a_contents.data(), static_cast<int>(a_contents.size()), &tex_width,
+            &tex_height, &tex_channels, STBI_rgb_alpha);
 
         if(!cvt_data)
             throw std::runtime_error{"Could not convert loaded texture."};
 
         m_extent = {static_cast<uint32_t>(tex_width), static_cast<uint32_t>(tex_height), 1};
+        m_data.reset(cvt_data, &free_pixels);
+        m_levels.push_back({0, static_cast<size_t>(tex_width) * tex_height * 4, m_extent});
+    }
 
-        m_data.resize(tex_width * tex_height * 4);
-
-        memcpy(m_data.data(), cvt_data, m_data.size());
-
-        stbi_image_free(cvt_data);
+    void texture::free_pixels(stbi_uc *a_pixels)
+    {
+        stbi_image_free(a_pixels);
     }
 
-}}
\ No newline at end of file
+}}
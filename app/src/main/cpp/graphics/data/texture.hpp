@@ -18,6 +18,12 @@
 #ifndef NCV_TEXTURE_HPP
 #define NCV_TEXTURE_HPP
 
+#include <graphics/data/asset_pack.hpp>
+#include <graphics/data/ktx2.hpp>
+#include <utilities/span.hpp>
+
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -25,6 +31,11 @@ class AAssetManager;
 
 namespace graphics{ namespace data{
 
+    // Texture data ready for upload. Images are decoded to RGBA8 by stb_image and kept in the decoder's own
+    // page aligned allocation (no further copies), KTX2 files keep their stored levels, referenced straight out
+    // of the asset's buffer or the pack's mapping unless they had to be transcoded. Either way the data is held
+    // until the GPU has it.
+
     class texture
     {
     public:
@@ -36,12 +47,64 @@ namespace graphics{ namespace data{
             uint32_t depth;
         } extent3d;
 
-        texture(AAssetManager* a_ass_mgr, const std::string& a_filename);
-        std::vector<stbi_uc>& get_data() { return m_data; }
+        struct level
+        {
+            size_t offset;
+            size_t size;
+            extent3d extent;
+        };
+
+        // VkFormat of the data, R8G8B8A8 sRGB for decoded images
+
+        static constexpr uint32_t rgba8_srgb = 43;
+
+        // a_supported picks among the formats a KTX2 file can be uploaded in, it runs on the loading thread
+
+        texture(AAssetManager* a_ass_mgr, const std::string& a_filename,
+            const ktx2::format_filter& a_supported = nullptr);
+        texture(std::shared_ptr<const asset_pack> a_pack, const std::string& a_name,
+            const ktx2::format_filter& a_supported = nullptr);
+
+        // Single colour texture (a_rgba packed as 0xAABBGGRR), stands in while the real one is decoded
+
+        texture(uint32_t a_width, uint32_t a_height, uint32_t a_rgba);
+
+        // Base level
+
+        utilities::span<const stbi_uc> get_data() const { return get_level(0); }
+        utilities::span<const stbi_uc> get_level(size_t a_level) const;
+        const std::vector<level>& get_levels() const { return m_levels; }
+        uint32_t get_format() const { return m_format; }
         extent3d get_extent() { return m_extent; }
+        double get_decode_ms() const { return m_decode_ms; }
+
+        // Shares ownership of the data independently of release(), for uploads that read it in place
+
+        std::shared_ptr<const void> get_owner() const { return m_data; }
+
+        // The data views a read only file mapping (KTX2 levels out of the pack or an uncompressed asset), which
+        // can't be imported as a host allocation
+
+        bool is_file_mapped() const { return m_file_mapped; }
+
+        // Drops the data once the GPU owns a copy, extent, format and level layout stay valid
+
+        void release() { m_data.reset(); }
     private:
-        std::vector<stbi_uc> m_data;
+        static void free_pixels(stbi_uc* a_pixels);
+
+        // a_owner keeps a_contents alive, KTX2 levels taken as stored are viewed in place. a_mapped tells
+        // whether a_contents lie in a file mapping.
+
+        void load(utilities::span<const uint8_t> a_contents, std::shared_ptr<const void> a_owner, bool a_mapped,
+            const ktx2::format_filter& a_supported);
+
+        std::shared_ptr<const stbi_uc> m_data;
+        std::vector<level> m_levels;
+        uint32_t m_format = rgba8_srgb;
         extent3d m_extent;
+        double m_decode_ms = 0.0;
+        bool m_file_mapped = false;
     };
 
 }}
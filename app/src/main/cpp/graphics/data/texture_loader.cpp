@@ -0,0 +1,161 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <graphics/data/texture_loader.hpp>
+
+namespace graphics{ namespace data{
+
+    texture_loader::texture_loader(AAssetManager *a_ass_mgr, ktx2::format_filter a_supported,
+        std::shared_ptr<const asset_pack> a_pack, uint32_t a_threads)
+        : m_ass_mgr{a_ass_mgr}, m_supported{std::move(a_supported)}, m_pack{std::move(a_pack)}
+    {
+        if(!a_threads)
+        {
+            auto cores = std::thread::hardware_concurrency();
+            a_threads = cores > 1 ? cores - 1 : 1;
+        }
+
+        try
+        {
+            for(uint32_t i = 0; i < a_threads; ++i)
+                m_workers.emplace_back(&texture_loader::work, this);
+        }
+        catch(...)
+        {
+            {
+                std::lock_guard<std::mutex> lock{m_mutex};
+                m_stop = true;
+            }
+            m_wake.notify_all();
+
+            for(auto& worker : m_workers)
+                worker.join();
+
+            throw;
+        }
+    }
+
+    texture_loader::~texture_loader()
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_stop = true;
+            m_jobs.clear();
+        }
+
+        m_wake.notify_all();
+
+        for(auto& worker : m_workers)
+            worker.join();
+    }
+
+    void texture_loader::load(const std::string &a_filename, callback a_done, prepare a_prepare)
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_jobs.push_back({a_filename, std::move(a_done), std::move(a_prepare)});
+        }
+
+        m_wake.notify_one();
+    }
+
+    void texture_loader::work()
+    {
+        for(;;)
+        {
+            job next;
+
+            {
+                std::unique_lock<std::mutex> lock{m_mutex};
+
+                m_wake.wait(lock, [this]{ return m_stop || !m_jobs.empty(); });
+
+                if(m_stop)
+                    return;
+
+                next = std::move(m_jobs.front());
+                m_jobs.pop_front();
+                m_running++;
+            }
+
+            result done{nullptr, nullptr, std::move(next.done)};
+
+            try
+            {
+                if(m_pack && m_pack->contains(next.filename))
+                    done.data = std::make_shared<texture>(m_pack, next.filename, m_supported);
+                else
+                    done.data = std::make_shared<texture>(m_ass_mgr, next.filename, m_supported);
+
+                if(next.after_decode)
+                    next.after_decode(*done.data);
+            }
+            catch(...)
+            {
+                done.data.reset();
+                done.error = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock{m_mutex};
+
+            m_running--;
+
+            if(done.data)
+            {
+                auto extent = done.data->get_extent();
+
+                m_stats.decoded++;
+                m_stats.pixels += static_cast<uint64_t>(extent.width) * extent.height;
+                m_stats.decode_ms += done.data->get_decode_ms();
+            }
+            else
+                m_stats.failed++;
+
+            m_results.push_back(std::move(done));
+        }
+    }
+
+    size_t texture_loader::poll()
+    {
+        std::vector<result> finished;
+
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            finished.swap(m_results);
+        }
+
+        for(auto& done : finished)
+            done.done(std::move(done.data), done.error);
+
+        return finished.size();
+    }
+
+    size_t texture_loader::get_pending() const
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+
+        return m_jobs.size() + m_running + m_results.size();
+    }
+
+    texture_loader::statistics texture_loader::get_statistics() const
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+
+        return m_stats;
+    }
+
+}}
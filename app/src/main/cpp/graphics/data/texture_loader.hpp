@@ -0,0 +1,113 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_TEXTURE_LOADER_HPP
+#define NCV_TEXTURE_LOADER_HPP
+
+#include <graphics/data/texture.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace graphics{ namespace data{
+
+    // Decodes textures on worker threads. Finished decodes wait until the owner polls, their callbacks then
+    // run on the polling thread, which is where GPU uploads have to be issued from. Decodes still queued or
+    // running when the loader is destroyed are dropped without a callback.
+
+    class texture_loader
+    {
+    public:
+
+        // a_error is set (and a_texture null) when loading failed
+
+        using callback = std::function<void(std::shared_ptr<texture> a_texture, std::exception_ptr a_error)>;
+
+        // Runs on the worker right after a successful decode, for work that can follow it off the polling
+        // thread. Throwing fails the load.
+
+        using prepare = std::function<void(texture& a_texture)>;
+
+        struct statistics
+        {
+            uint64_t decoded = 0;
+            uint64_t failed = 0;
+            uint64_t pixels = 0;
+            double decode_ms = 0.0;
+        };
+
+        // 0 threads picks one less than the core count (the render thread keeps its core), at least one.
+        // a_supported is handed to every KTX2 load and called from the workers. Files found in a_pack are read
+        // from it, the rest through the asset manager.
+
+        explicit texture_loader(AAssetManager* a_ass_mgr, ktx2::format_filter a_supported = nullptr,
+            std::shared_ptr<const asset_pack> a_pack = nullptr, uint32_t a_threads = 0);
+        ~texture_loader();
+
+        texture_loader(const texture_loader&) = delete;
+        texture_loader& operator=(const texture_loader&) = delete;
+
+        void load(const std::string& a_filename, callback a_done, prepare a_prepare = nullptr);
+
+        // Runs the callbacks of finished decodes on the calling thread, returns how many ran
+
+        size_t poll();
+
+        size_t get_pending() const;
+        size_t get_thread_count() const { return m_workers.size(); }
+        statistics get_statistics() const;
+
+    private:
+
+        struct job
+        {
+            std::string filename;
+            callback done;
+            prepare after_decode;
+        };
+
+        struct result
+        {
+            std::shared_ptr<texture> data;
+            std::exception_ptr error;
+            callback done;
+        };
+
+        void work();
+
+        AAssetManager* m_ass_mgr = nullptr;
+        ktx2::format_filter m_supported;
+        std::shared_ptr<const asset_pack> m_pack;
+        std::vector<std::thread> m_workers;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::deque<job> m_jobs;
+        std::vector<result> m_results;
+        size_t m_running = 0;
+        bool m_stop = false;
+        statistics m_stats;
+    };
+
+}}
+
+#endif //NCV_TEXTURE_LOADER_HPP
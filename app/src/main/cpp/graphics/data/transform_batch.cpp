@@ -0,0 +1,346 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <graphics/data/transform_batch.hpp>
+
+#include <stdexcept>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+    // Each lane type holds one matrix element of `width` instances and knows how to scatter the 16 elements
+    // back to `width` consecutive column major matrices. Loads are unaligned, the arrays come from std::vector.
+
+    struct lanes_scalar
+    {
+        static constexpr size_t width = 1;
+
+        float v;
+
+        static lanes_scalar load(const float* a_src) { return {*a_src}; }
+        static lanes_scalar set(float a_value) { return {a_value}; }
+
+        friend lanes_scalar operator+(lanes_scalar a_lhs, lanes_scalar a_rhs) { return {a_lhs.v + a_rhs.v}; }
+        friend lanes_scalar operator-(lanes_scalar a_lhs, lanes_scalar a_rhs) { return {a_lhs.v - a_rhs.v}; }
+        friend lanes_scalar operator*(lanes_scalar a_lhs, lanes_scalar a_rhs) { return {a_lhs.v * a_rhs.v}; }
+
+        static void store(const lanes_scalar (&a_matrix)[16], float* a_dst)
+        {
+            for(size_t i = 0; i < 16; ++i)
+                a_dst[i] = a_matrix[i].v;
+        }
+    };
+
+#if defined(__AVX__)
+    struct lanes_avx
+    {
+        static constexpr size_t width = 8;
+
+        __m256 v;
+
+        static lanes_avx load(const float* a_src) { return {_mm256_loadu_ps(a_src)}; }
+        static lanes_avx set(float a_value) { return {_mm256_set1_ps(a_value)}; }
+
+        friend lanes_avx operator+(lanes_avx a_lhs, lanes_avx a_rhs) { return {_mm256_add_ps(a_lhs.v, a_rhs.v)}; }
+        friend lanes_avx operator-(lanes_avx a_lhs, lanes_avx a_rhs) { return {_mm256_sub_ps(a_lhs.v, a_rhs.v)}; }
+        friend lanes_avx operator*(lanes_avx a_lhs, lanes_avx a_rhs) { return {_mm256_mul_ps(a_lhs.v, a_rhs.v)}; }
+
+        static void store(const lanes_avx (&a_matrix)[16], float* a_dst)
+        {
+            // Transpose each column's four rows in two 4x4 halves, instances 0-3 and 4-7
+
+            for(size_t c = 0; c < 4; ++c)
+            {
+                for(size_t half = 0; half < 2; ++half)
+                {
+                    __m128 r0, r1, r2, r3;
+
+                    if(half == 0)
+                    {
+                        r0 = _mm256_castps256_ps128(a_matrix[c * 4 + 0].v);
+                        r1 = _mm256_castps256_ps128(a_matrix[c * 4 + 1].v);
+                        r2 = _mm256_castps256_ps128(a_matrix[c * 4 + 2].v);
+                        r3 = _mm256_castps256_ps128(a_matrix[c * 4 + 3].v);
+                    }
+                    else
+                    {
+                        r0 = _mm256_extractf128_ps(a_matrix[c * 4 + 0].v, 1);
+                        r1 = _mm256_extractf128_ps(a_matrix[c * 4 + 1].v, 1);
+                        r2 = _mm256_extractf128_ps(a_matrix[c * 4 + 2].v, 1);
+                        r3 = _mm256_extractf128_ps(a_matrix[c * 4 + 3].v, 1);
+                    }
+
+                    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+                    float* dst = a_dst + half * 64 + c * 4;
+
+                    _mm_storeu_ps(dst, r0);
+                    _mm_storeu_ps(dst + 16, r1);
+                    _mm_storeu_ps(dst + 32, r2);
+                    _mm_storeu_ps(dst + 48, r3);
+                }
+            }
+        }
+    };
+
+    using lanes_simd = lanes_avx;
+    constexpr const char* isa_name = "avx";
+#elif defined(__SSE2__)
+    struct lanes_sse
+    {
+        static constexpr size_t width = 4;
+
+        __m128 v;
+
+        static lanes_sse load(const float* a_src) { return {_mm_loadu_ps(a_src)}; }
+        static lanes_sse set(float a_value) { return {_mm_set1_ps(a_value)}; }
+
+        friend lanes_sse operator+(lanes_sse a_lhs, lanes_sse a_rhs) { return {_mm_add_ps(a_lhs.v, a_rhs.v)}; }
+        friend lanes_sse operator-(lanes_sse a_lhs, lanes_sse a_rhs) { return {_mm_sub_ps(a_lhs.v, a_rhs.v)}; }
+        friend lanes_sse operator*(lanes_sse a_lhs, lanes_sse a_rhs) { return {_mm_mul_ps(a_lhs.v, a_rhs.v)}; }
+
+        static void store(const lanes_sse (&a_matrix)[16], float* a_dst)
+        {
+            for(size_t c = 0; c < 4; ++c)
+            {
+                __m128 r0 = a_matrix[c * 4 + 0].v, r1 = a_matrix[c * 4 + 1].v;
+                __m128 r2 = a_matrix[c * 4 + 2].v, r3 = a_matrix[c * 4 + 3].v;
+
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+                _mm_storeu_ps(a_dst + c * 4, r0);
+                _mm_storeu_ps(a_dst + 16 + c * 4, r1);
+                _mm_storeu_ps(a_dst + 32 + c * 4, r2);
+                _mm_storeu_ps(a_dst + 48 + c * 4, r3);
+            }
+        }
+    };
+
+    using lanes_simd = lanes_sse;
+    constexpr const char* isa_name = "sse2";
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    struct lanes_neon
+    {
+        static constexpr size_t width = 4;
+
+        float32x4_t v;
+
+        static lanes_neon load(const float* a_src) { return {vld1q_f32(a_src)}; }
+        static lanes_neon set(float a_value) { return {vdupq_n_f32(a_value)}; }
+
+        friend lanes_neon operator+(lanes_neon a_lhs, lanes_neon a_rhs) { return {vaddq_f32(a_lhs.v, a_rhs.v)}; }
+        friend lanes_neon operator-(lanes_neon a_lhs, lanes_neon a_rhs) { return {vsubq_f32(a_lhs.v, a_rhs.v)}; }
+        friend lanes_neon operator*(lanes_neon a_lhs, lanes_neon a_rhs) { return {vmulq_f32(a_lhs.v, a_rhs.v)}; }
+
+        static void store(const lanes_neon (&a_matrix)[16], float* a_dst)
+        {
+            for(size_t c = 0; c < 4; ++c)
+            {
+                // (r0, r1, r2, r3) over instances to one column per instance
+
+                float32x4x2_t p01 = vtrnq_f32(a_matrix[c * 4 + 0].v, a_matrix[c * 4 + 1].v);
+                float32x4x2_t p23 = vtrnq_f32(a_matrix[c * 4 + 2].v, a_matrix[c * 4 + 3].v);
+
+                vst1q_f32(a_dst + c * 4, vcombine_f32(vget_low_f32(p01.val[0]), vget_low_f32(p23.val[0])));
+                vst1q_f32(a_dst + 16 + c * 4, vcombine_f32(vget_low_f32(p01.val[1]), vget_low_f32(p23.val[1])));
+                vst1q_f32(a_dst + 32 + c * 4, vcombine_f32(vget_high_f32(p01.val[0]), vget_high_f32(p23.val[0])));
+                vst1q_f32(a_dst + 48 + c * 4, vcombine_f32(vget_high_f32(p01.val[1]), vget_high_f32(p23.val[1])));
+            }
+        }
+    };
+
+    using lanes_simd = lanes_neon;
+    constexpr const char* isa_name = "neon";
+#else
+    using lanes_simd = lanes_scalar;
+    constexpr const char* isa_name = "scalar";
+#endif
+
+    // Source arrays in order tx, ty, tz, qx, qy, qz, qw, sx, sy, sz
+
+    using sources = const float* const*;
+
+    // Composes instances [a_first, a_first + a_count) a whole register at a time, returns how many it did.
+    // M = T * R(q) * S has columns (R0 sx, R1 sy, R2 sz, t), with an optional view projection applied on the
+    // left. VP elements are broadcast and the zero bottom row of M is skipped.
+
+    template<typename Lanes>
+    size_t compose(sources a_src, size_t a_first, size_t a_count, const float* a_vp, float* a_out)
+    {
+        size_t done = 0;
+
+        for(; done + Lanes::width <= a_count; done += Lanes::width)
+        {
+            size_t i = a_first + done;
+
+            Lanes qx = Lanes::load(a_src[3] + i), qy = Lanes::load(a_src[4] + i);
+            Lanes qz = Lanes::load(a_src[5] + i), qw = Lanes::load(a_src[6] + i);
+
+            Lanes one = Lanes::set(1.f), two = Lanes::set(2.f), zero = Lanes::set(0.f);
+
+            Lanes x2 = qx * two, y2 = qy * two, z2 = qz * two;
+            Lanes xx = qx * x2, yy = qy * y2, zz = qz * z2;
+            Lanes xy = qx * y2, xz = qx * z2, yz = qy * z2;
+            Lanes wx = qw * x2, wy = qw * y2, wz = qw * z2;
+
+            Lanes sx = Lanes::load(a_src[7] + i), sy = Lanes::load(a_src[8] + i), sz = Lanes::load(a_src[9] + i);
+
+            Lanes m[16] = {
+                (one - (yy + zz)) * sx, (xy + wz) * sx, (xz - wy) * sx, zero,
+                (xy - wz) * sy, (one - (xx + zz)) * sy, (yz + wx) * sy, zero,
+                (xz + wy) * sz, (yz - wx) * sz, (one - (xx + yy)) * sz, zero,
+                Lanes::load(a_src[0] + i), Lanes::load(a_src[1] + i), Lanes::load(a_src[2] + i), one
+            };
+
+            if(a_vp)
+            {
+                Lanes r[16];
+
+                for(size_t c = 0; c < 4; ++c)
+                {
+                    for(size_t row = 0; row < 4; ++row)
+                    {
+                        r[c * 4 + row] = Lanes::set(a_vp[row]) * m[c * 4] +
+                            Lanes::set(a_vp[4 + row]) * m[c * 4 + 1] +
+                            Lanes::set(a_vp[8 + row]) * m[c * 4 + 2];
+                    }
+                }
+
+                for(size_t row = 0; row < 4; ++row)
+                    r[12 + row] = r[12 + row] + Lanes::set(a_vp[12 + row]);
+
+                Lanes::store(r, a_out + done * 16);
+            }
+            else
+                Lanes::store(m, a_out + done * 16);
+        }
+
+        return done;
+    }
+
+    void compose_range(sources a_src, size_t a_first, size_t a_count, const float* a_vp, float* a_out)
+    {
+        size_t done = compose<lanes_simd>(a_src, a_first, a_count, a_vp, a_out);
+
+        // Tail that doesn't fill a register
+
+        if(done < a_count)
+            compose<lanes_scalar>(a_src, a_first + done, a_count - done, a_vp, a_out + done * 16);
+    }
+}
+
+namespace graphics{ namespace data{
+
+    transform_batch::transform_batch(size_t a_count)
+    {
+        resize(a_count);
+    }
+
+    void transform_batch::resize(size_t a_count)
+    {
+        // New instances start as identity
+
+        for(size_t i = 0; i < component_count; ++i)
+            m_components[i].resize(a_count, (i == qw || i >= sx) ? 1.f : 0.f);
+    }
+
+    void transform_batch::set(size_t a_index, const glm::vec3 &a_translation, const glm::quat &a_rotation,
+        const glm::vec3 &a_scale)
+    {
+        set_translation(a_index, a_translation);
+        set_rotation(a_index, a_rotation);
+        set_scale(a_index, a_scale);
+    }
+
+    void transform_batch::set_translation(size_t a_index, const glm::vec3 &a_translation)
+    {
+        m_components[tx][a_index] = a_translation.x;
+        m_components[ty][a_index] = a_translation.y;
+        m_components[tz][a_index] = a_translation.z;
+    }
+
+    void transform_batch::set_rotation(size_t a_index, const glm::quat &a_rotation)
+    {
+        auto rotation = glm::normalize(a_rotation);
+
+        m_components[qx][a_index] = rotation.x;
+        m_components[qy][a_index] = rotation.y;
+        m_components[qz][a_index] = rotation.z;
+        m_components[qw][a_index] = rotation.w;
+    }
+
+    void transform_batch::set_scale(size_t a_index, const glm::vec3 &a_scale)
+    {
+        m_components[sx][a_index] = a_scale.x;
+        m_components[sy][a_index] = a_scale.y;
+        m_components[sz][a_index] = a_scale.z;
+    }
+
+    void transform_batch::compute_models(float *a_out, size_t a_first, size_t a_count) const
+    {
+        if(a_first + a_count > size())
+            throw std::runtime_error{"Transform range out of bounds."};
+
+        const float* src[component_count];
+
+        for(size_t i = 0; i < component_count; ++i)
+            src[i] = m_components[i].data();
+
+        compose_range(src, a_first, a_count, nullptr, a_out);
+    }
+
+    void transform_batch::compute_mvps(const glm::mat4 &a_view_projection, float *a_out, size_t a_first,
+        size_t a_count) const
+    {
+        if(a_first + a_count > size())
+            throw std::runtime_error{"Transform range out of bounds."};
+
+        const float* src[component_count];
+
+        for(size_t i = 0; i < component_count; ++i)
+            src[i] = m_components[i].data();
+
+        compose_range(src, a_first, a_count, &a_view_projection[0][0], a_out);
+    }
+
+    const char* transform_batch::get_isa()
+    {
+        return isa_name;
+    }
+
+    glm::mat4 compose_transform(const glm::vec3 &a_translation, const glm::quat &a_rotation,
+        const glm::vec3 &a_scale)
+    {
+        const float src[] = {
+            a_translation.x, a_translation.y, a_translation.z,
+            a_rotation.x, a_rotation.y, a_rotation.z, a_rotation.w,
+            a_scale.x, a_scale.y, a_scale.z
+        };
+        const float* ptrs[] = {src, src + 1, src + 2, src + 3, src + 4, src + 5, src + 6, src + 7, src + 8, src + 9};
+
+        glm::mat4 result;
+
+        compose<lanes_scalar>(ptrs, 0, 1, nullptr, &result[0][0]);
+
+        return result;
+    }
+}}
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_TRANSFORM_BATCH_HPP
+#define NCV_TRANSFORM_BATCH_HPP
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <array>
+#include <vector>
+
+namespace graphics{ namespace data{
+
+    // Translation, rotation and scale of many instances, stored as structure of arrays so the kernels can
+    // compose several instances per SIMD register (NEON on ARM, SSE or AVX on x86, scalar elsewhere).
+    // Output is one column major mat4 per instance, written to any float destination, typically a mapped
+    // instance buffer. Rotations are expected to be unit quaternions, set() normalizes them.
+
+    class transform_batch
+    {
+    public:
+
+        explicit transform_batch(size_t a_count = 0);
+
+        void resize(size_t a_count);
+        size_t size() const { return m_components[0].size(); }
+
+        void set(size_t a_index, const glm::vec3& a_translation, const glm::quat& a_rotation,
+            const glm::vec3& a_scale);
+        void set_translation(size_t a_index, const glm::vec3& a_translation);
+        void set_rotation(size_t a_index, const glm::quat& a_rotation);
+        void set_scale(size_t a_index, const glm::vec3& a_scale);
+
+        // a_out receives 16 floats per instance, instance a_first lands at a_out[0]
+
+        void compute_models(float* a_out) const { compute_models(a_out, 0, size()); }
+        void compute_models(float* a_out, size_t a_first, size_t a_count) const;
+
+        void compute_mvps(const glm::mat4& a_view_projection, float* a_out) const
+        {
+            compute_mvps(a_view_projection, a_out, 0, size());
+        }
+        void compute_mvps(const glm::mat4& a_view_projection, float* a_out, size_t a_first, size_t a_count) const;
+
+        // Name of the instruction set the kernels were compiled for
+
+        static const char* get_isa();
+
+    private:
+
+        enum component : size_t
+        {
+            tx, ty, tz,
+            qx, qy, qz, qw,
+            sx, sy, sz,
+            component_count
+        };
+
+        std::array<std::vector<float>, component_count> m_components;
+    };
+
+    // Single instance T * R * S, same kernel as the batch without the five intermediate matrices
+
+    glm::mat4 compose_transform(const glm::vec3& a_translation, const glm::quat& a_rotation,
+        const glm::vec3& a_scale);
+}}
+
+#endif //NCV_TRANSFORM_BATCH_HPP
@@ -24,7 +24,9 @@ namespace graphics { namespace data {
   typedef uint16_t index_format;
   class model_view_projection;
   class vertex_format;
+  struct compact_vertex;
   class texture;
+  class texture_loader;
   typedef unsigned char stbi_uc;
 }}
 
@@ -18,10 +18,88 @@
 #ifndef NCV_VERTEX_HPP
 #define NCV_VERTEX_HPP
 
+#include <vulkan_hpp/vulkan.hpp>
 #include <glm/glm.hpp>
-#include <vector>
+
+#include <array>
+#include <cstddef>
 
 namespace graphics{ namespace data{
+
+    struct vertex_attribute
+    {
+        uint32_t location;
+        vk::Format format;
+        uint32_t offset;
+        uint32_t binding = 0;
+    };
+
+    struct vertex_binding
+    {
+        uint32_t binding;
+        uint32_t stride;
+    };
+
+    // Vertex input layout of a vertex structure, specialized for every structure fed to a pipeline. Shader
+    // locations are matched against it by reflection (see graphics/shaders/reflection.hpp).
+
+    template<typename T>
+    struct vertex_layout;
+
+    // Attribute format of a member type, specialized for every type that may appear in a vertex structure.
+
+    template<typename T>
+    struct attribute_format;
+
+    template<>
+    struct attribute_format<float>
+    {
+        constexpr static vk::Format value = vk::Format::eR32Sfloat;
+    };
+
+    template<>
+    struct attribute_format<glm::vec2>
+    {
+        constexpr static vk::Format value = vk::Format::eR32G32Sfloat;
+    };
+
+    template<>
+    struct attribute_format<glm::vec3>
+    {
+        constexpr static vk::Format value = vk::Format::eR32G32B32Sfloat;
+    };
+
+    template<>
+    struct attribute_format<glm::vec4>
+    {
+        constexpr static vk::Format value = vk::Format::eR32G32B32A32Sfloat;
+    };
+
+    template<typename Member>
+    constexpr vertex_attribute make_attribute(uint32_t a_location, size_t a_offset, uint32_t a_binding = 0)
+    {
+        return {a_location, attribute_format<Member>::value, static_cast<uint32_t>(a_offset), a_binding};
+    }
+
+    // Type erased view of a vertex_layout, for code that selects the layout at run time.
+
+    struct vertex_input
+    {
+        const vertex_binding* bindings = nullptr;
+        uint32_t binding_count = 0;
+        const vertex_attribute* attributes = nullptr;
+        uint32_t attribute_count = 0;
+    };
+
+    template<typename T>
+    constexpr vertex_input make_vertex_input()
+    {
+        using layout = vertex_layout<T>;
+
+        return {layout::bindings.data(), static_cast<uint32_t>(layout::bindings.size()),
+            layout::attributes.data(), static_cast<uint32_t>(layout::attributes.size())};
+    }
+
     struct vertex_format
     {
         glm::vec4 position;
@@ -29,37 +107,15 @@ namespace graphics{ namespace data{
         glm::vec2 tex_coords;
     };
 
-    static const std::vector<vertex_format> vertex_set = std::vector<vertex_format>
+    template<>
+    struct vertex_layout<vertex_format>
     {
-        {{-1.0f, 1.0f,  1.0f, 1.0f}, {1.f,  0.0f, 0.0f, 1.0f}, {1.0f, 0.0f}},
-        {{1.0f, 1.0f,  1.0f, 1.0f}, {0.0f, 0.0f, 1.0f, 1.0f}, {0.0f, 0.0f}},
-        {{1.0f, -1.0f, 1.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f}},
-        {{-1.0f, -1.0f, 1.0f, 1.0f}, {1.0f, 1.0f, 0.0f, 1.0f}, {1.0f, 1.0f}},
-
-        {{-1.0f, 1.0f,  -1.0f, 1.0f}, {1.f,  0.0f, 0.0f, 1.0f}, {0.0f, 0.0f}},
-        {{1.0f, 1.0f,  -1.0f, 1.0f}, {0.0f, 0.0f, 1.0f, 1.0f}, {1.0f, 0.0f}},
-        {{1.0f, -1.0f, -1.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {1.0f, 1.0f}},
-        {{-1.0f, -1.0f, -1.0f, 1.0f}, {1.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f}},
-
-        {{1.0f, 1.0f,  1.0f, 1.0f}, {0.0f, 0.0f, 1.0f, 1.0f}, {1.0f, 0.0f}},
-        {{1.0f, 1.0f,  -1.0f, 1.0f}, {0.0f, 0.0f, 1.0f, 1.0f}, {0.0f, 0.0f}},
-        {{1.0f, -1.0f, -1.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f}},
-        {{1.0f, -1.0f, 1.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {1.0f, 1.0f}},
-
-        {{-1.0f, 1.0f,  -1.0f, 1.0f}, {1.f,  0.0f, 0.0f, 1.0f}, {1.0f, 0.0f}},
-        {{-1.0f, 1.0f,  1.0f, 1.0f}, {1.f,  0.0f, 0.0f, 1.0f}, {0.0f, 0.0f}},
-        {{-1.0f, -1.0f, 1.0f, 1.0f}, {1.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f}},
-        {{-1.0f, -1.0f, -1.0f, 1.0f}, {1.0f, 1.0f, 0.0f, 1.0f}, {1.0f, 1.0f}},
-
-        {{-1.0f, 1.0f,  -1.0f, 1.0f}, {1.f,  0.0f, 0.0f, 1.0f}, {0.0f, 0.0f}},
-        {{1.0f, 1.0f,  -1.0f, 1.0f}, {0.0f, 0.0f, 1.0f, 1.0f}, {0.0f, 1.0f}},
-        {{1.0f, 1.0f,  1.0f, 1.0f}, {0.0f, 0.0f, 1.0f, 1.0f}, {1.0f, 1.0f}},
-        {{-1.0f, 1.0f,  1.0f, 1.0f}, {1.f,  0.0f, 0.0f, 1.0f}, {1.0f, 0.0f}},
-
-        {{-1.0f, -1.0f, 1.0f, 1.0f}, {1.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 0.0f}},
-        {{1.0f, -1.0f, 1.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f}},
-        {{1.0f, -1.0f, -1.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {1.0f, 1.0f}},
-        {{-1.0f, -1.0f, -1.0f, 1.0f}, {1.0f, 1.0f, 0.0f, 1.0f}, {1.0f, 0.0f}}
+        constexpr static std::array<vertex_binding, 1> bindings = {{{0, sizeof(vertex_format)}}};
+        constexpr static std::array<vertex_attribute, 3> attributes = {{
+            make_attribute<decltype(vertex_format::position)>(0, offsetof(vertex_format, position)),
+            make_attribute<decltype(vertex_format::color)>(1, offsetof(vertex_format, color)),
+            make_attribute<decltype(vertex_format::tex_coords)>(2, offsetof(vertex_format, tex_coords))
+        }};
     };
 }}
 
@@ -17,120 +17,210 @@
 
 #include <graphics/pipeline.hpp>
 #include <graphics/data/vertex.hpp>
-#include <android_native_app_glue.h>
+#include <graphics/shaders/reflection.hpp>
+#include <graphics/shaders/spirv.hpp>
 #include <utilities/log.hpp>
 
+#include <algorithm>
+
 using namespace ::std;
 using namespace ::vk;
 using namespace ::utilities;
 
+static const ::graphics::shaders::spirv_module& find_module(const string& a_name)
+{
+    for(auto& module : ::graphics::shaders::modules)
+        if(a_name == module.name)
+            return module;
+
+    throw runtime_error{"Shader " + a_name + " is not embedded in the binary."};
+}
+
 namespace graphics
 {
-    pipeline::pipeline(const parameters &a_params, const shaders_info &a_shaders_info)
-        : m_params{a_params}, m_shaders_info{a_shaders_info}
+    pipeline::shader_stage::shader_stage(Device a_device, const string& a_name) : m_device{a_device}
     {
-        AAsset* file = AAssetManager_open(m_params.ass_mgr,
-            ("shaders/" + m_shaders_info.vert_filename + ".spv").c_str(), AASSET_MODE_BUFFER);
+        // Modules are created straight from the SPIR-V embedded at build time
 
-        if(!file)
-            throw runtime_error{"Unknown error. Couldn't open shader file."};
+        auto& module = find_module(a_name);
 
-        vector<char> file_contents(AAsset_getLength(file));
+        m_reflection = shaders::reflect(module.code, module.size / sizeof(uint32_t));
 
-        if(AAsset_read(file, file_contents.data(), file_contents.size()) != file_contents.size())
-        {
-            AAsset_close(file);
-            throw runtime_error{"Unknown error. Couldn't load shader file contents."};
-        }
+        if(!m_reflection.valid)
+            throw runtime_error{"Couldn't reflect shader " + a_name + "."};
 
         ShaderModuleCreateInfo shader_info;
 
-        shader_info.codeSize = file_contents.size();
-        shader_info.pCode = reinterpret_cast<const uint32_t*>(file_contents.data());
+        shader_info.codeSize = module.size;
+        shader_info.pCode = module.code;
 
-        m_vertex_shader = m_params.device.createShaderModule(shader_info);
+        m_module = m_device.createShaderModule(shader_info);
 
-        AAsset_close(file);
+        if constexpr(__ncv_logging_enabled)
+            _log_android(log_level::info) << "Shader " << a_name << " loaded with success, shader module created.";
+    }
 
-        file = AAssetManager_open(m_params.ass_mgr,
-            ("shaders/" + m_shaders_info.frag_filename + ".spv").c_str(), AASSET_MODE_BUFFER);
+    pipeline::shader_stage::~shader_stage()
+    {
+        m_device.destroyShaderModule(m_module);
+    }
 
-        if(!file)
-            throw runtime_error{"Unknown error. Couldn't open shader file."};
+    pipeline::layout::layout(Device a_device, const shader_stage& a_vertex, const shader_stage& a_fragment,
+        Sampler a_immut_sampler) : m_device{a_device}
+    {
+        // Bindings of both stages are merged and must agree on type and count, combined image samplers get the
+        // immutable sampler when one is given.
 
-        file_contents.resize(AAsset_getLength(file));
+        vector<DescriptorSetLayoutBinding> desc_bindings;
+        vector<PushConstantRange> push_constant_ranges;
 
-        if(AAsset_read(file, file_contents.data(), file_contents.size()) != file_contents.size())
+        for(auto refl : {&a_vertex.get_reflection(), &a_fragment.get_reflection()})
         {
-            AAsset_close(file);
-            throw runtime_error{"Unknown error. Couldn't load shader file contents."};
+            for(auto& binding : refl->bindings)
+            {
+                if(binding.set != 0)
+                    throw runtime_error{"Only descriptor set 0 is supported."};
+
+                auto existing = find_if(desc_bindings.begin(), desc_bindings.end(),
+                    [&](auto& a_binding) { return a_binding.binding == binding.binding; });
+
+                if(existing != desc_bindings.end())
+                {
+                    if(existing->descriptorType != binding.type || existing->descriptorCount != binding.count)
+                        throw runtime_error{"Descriptor binding " + to_string(binding.binding) +
+                            " differs between shader stages."};
+
+                    existing->stageFlags |= refl->stage;
+                    continue;
+                }
+
+                DescriptorSetLayoutBinding layout_binding;
+
+                layout_binding.binding = binding.binding;
+                layout_binding.descriptorType = binding.type;
+                layout_binding.descriptorCount = binding.count;
+                layout_binding.stageFlags = refl->stage;
+                layout_binding.pImmutableSamplers =
+                    binding.type == DescriptorType::eCombinedImageSampler && a_immut_sampler ?
+                        &a_immut_sampler : nullptr;
+
+                desc_bindings.push_back(layout_binding);
+            }
+
+            if(refl->push_constant_size > 0)
+                push_constant_ranges.push_back({refl->stage, 0, refl->push_constant_size});
         }
 
-        shader_info.codeSize = file_contents.size();
-        shader_info.pCode = reinterpret_cast<const uint32_t*>(file_contents.data());
+        DescriptorSetLayoutCreateInfo desc_set_layout_info;
 
-        m_fragment_shader = m_params.device.createShaderModule(shader_info);
+        desc_set_layout_info.bindingCount = desc_bindings.size();
+        desc_set_layout_info.pBindings = desc_bindings.data();
 
-        AAsset_close(file);
+        m_desc_set_layout = m_device.createDescriptorSetLayout(desc_set_layout_info);
 
-        if constexpr(__ncv_logging_enabled)
-            _log_android(log_level::info) << "Shaders loaded with success, shader modules created.";
+        PipelineLayoutCreateInfo pipeline_layout_info;
+
+        pipeline_layout_info.setLayoutCount = 1;
+        pipeline_layout_info.pSetLayouts = &m_desc_set_layout;
+        pipeline_layout_info.pushConstantRangeCount = push_constant_ranges.size();
+        pipeline_layout_info.pPushConstantRanges = push_constant_ranges.data();
+
+        try
+        {
+            m_pipeline_layout = m_device.createPipelineLayout(pipeline_layout_info);
+        }
+        catch(exception const &e)
+        {
+            destroy_resources();
+            throw e;
+        }
+    }
+
+    pipeline::layout::~layout()
+    {
+        destroy_resources();
+    }
+
+    void pipeline::layout::destroy_resources() noexcept
+    {
+        m_device.destroyPipelineLayout(m_pipeline_layout);
+        m_device.destroyDescriptorSetLayout(m_desc_set_layout);
+    }
+
+    pipeline::pipeline(const parameters &a_params, const shaders_info &a_shaders_info)
+        : pipeline{a_params, a_shaders_info,
+            make_shared<const shader_stage>(a_params.device, a_shaders_info.vert_filename),
+            make_shared<const shader_stage>(a_params.device, a_shaders_info.frag_filename),
+            nullptr}
+    {}
+
+    pipeline::pipeline(const parameters &a_params, const shaders_info &a_shaders_info,
+        shared_ptr<const shader_stage> a_vertex, shared_ptr<const shader_stage> a_fragment,
+        shared_ptr<const layout> a_layout)
+        : m_params{a_params}, m_shaders_info{a_shaders_info}, m_vertex_shader{move(a_vertex)},
+          m_fragment_shader{move(a_fragment)}, m_layout{move(a_layout)}
+    {
+        if(!m_layout)
+            m_layout = make_shared<const layout>(m_params.device, *m_vertex_shader, *m_fragment_shader,
+                m_params.immut_sampler);
 
         // Shaders stage creation info
 
         PipelineShaderStageCreateInfo vertex_shader_stage_info;
         PipelineShaderStageCreateInfo fragment_shader_stage_info;
 
+        auto to_spec_info = [](const specialization& a_spec) {
+            SpecializationInfo result;
+            result.mapEntryCount = a_spec.entries.size();
+            result.pMapEntries = a_spec.entries.data();
+            result.dataSize = a_spec.data.size();
+            result.pData = a_spec.data.data();
+            return result;
+        };
+
+        auto vertex_spec_info = to_spec_info(m_shaders_info.vert_constants);
+        auto fragment_spec_info = to_spec_info(m_shaders_info.frag_constants);
+
         vertex_shader_stage_info.stage = ShaderStageFlagBits::eVertex;
-        vertex_shader_stage_info.module = m_vertex_shader;
+        vertex_shader_stage_info.module = m_vertex_shader->get();
         vertex_shader_stage_info.pName = "main";
+        vertex_shader_stage_info.pSpecializationInfo =
+            m_shaders_info.vert_constants.entries.empty() ? nullptr : &vertex_spec_info;
 
         fragment_shader_stage_info.stage = ShaderStageFlagBits::eFragment;
-        fragment_shader_stage_info.module = m_fragment_shader;
+        fragment_shader_stage_info.module = m_fragment_shader->get();
         fragment_shader_stage_info.pName = "main";
+        fragment_shader_stage_info.pSpecializationInfo =
+            m_shaders_info.frag_constants.entries.empty() ? nullptr : &fragment_spec_info;
 
         vector<PipelineShaderStageCreateInfo> shader_stages_info;
 
         shader_stages_info.push_back(vertex_shader_stage_info);
         shader_stages_info.push_back(fragment_shader_stage_info);
 
-        // Acquire vertex-related information (Input and Assembly)
+        // Acquire vertex-related information (Input and Assembly). Locations come from the vertex shader, formats,
+        // offsets and streams from the layout of the vertex structures feeding it.
+
+        auto& vertex_input = m_params.vertex_input;
+        auto attributes_end = vertex_input.attributes + vertex_input.attribute_count;
 
         vector<VertexInputBindingDescription> bind_descs;
         vector<VertexInputAttributeDescription> attr_descs;
 
-        VertexInputBindingDescription vertex_bind_desc;
+        for(uint32_t i = 0; i < vertex_input.binding_count; ++i)
+            bind_descs.push_back({vertex_input.bindings[i].binding, vertex_input.bindings[i].stride,
+                VertexInputRate::eVertex});
 
-        vertex_bind_desc.binding = 0;
-        vertex_bind_desc.stride = sizeof(data::vertex_format);
-        vertex_bind_desc.inputRate = VertexInputRate::eVertex;
-
-        bind_descs.push_back(vertex_bind_desc);
-
-        VertexInputAttributeDescription vertex_geom_desc;
-
-        vertex_geom_desc.location = 0;
-        vertex_geom_desc.binding = vertex_bind_desc.binding;
-        vertex_geom_desc.format = Format::eR32G32B32A32Sfloat;
-        vertex_geom_desc.offset = offsetof(data::vertex_format, position);
-
-        VertexInputAttributeDescription vertex_color_desc;
-
-        vertex_color_desc.location = 1;
-        vertex_color_desc.binding = vertex_bind_desc.binding;
-        vertex_color_desc.format = Format::eR32G32B32A32Sfloat;
-        vertex_color_desc.offset = offsetof(data::vertex_format, color);
-
-        VertexInputAttributeDescription vertex_tex_coords;
+        for(auto& input : m_vertex_shader->get_reflection().inputs)
+        {
+            auto attribute = find_if(vertex_input.attributes, attributes_end,
+                [&](auto& a_attribute) { return a_attribute.location == input.location; });
 
-        vertex_tex_coords.location = 2;
-        vertex_tex_coords.binding = vertex_bind_desc.binding;
-        vertex_tex_coords.format = Format::eR32G32Sfloat;
-        vertex_tex_coords.offset = offsetof(data::vertex_format, tex_coords);
+            if(attribute == attributes_end)
+                throw runtime_error{"No vertex attribute feeds input location " + to_string(input.location) + "."};
 
-        attr_descs.push_back(vertex_geom_desc);
-        attr_descs.push_back(vertex_color_desc);
-        attr_descs.push_back(vertex_tex_coords);
+            attr_descs.push_back({attribute->location, attribute->binding, attribute->format, attribute->offset});
+        }
 
         PipelineVertexInputStateCreateInfo vertex_input_info;
 
@@ -235,59 +325,8 @@ namespace graphics
 
         // NO dynamic state is defined so just pass nullptr to pipeline creation
 
-        // Setup pipeline layout
-
-        DescriptorSetLayoutBinding ubo_layout_binding;
-
-        ubo_layout_binding.binding = 0;
-        ubo_layout_binding.descriptorType = DescriptorType::eUniformBuffer;
-        ubo_layout_binding.descriptorCount = 1;
-        ubo_layout_binding.stageFlags = ShaderStageFlagBits::eVertex;
-        ubo_layout_binding.pImmutableSamplers = nullptr;
-
-        array<DescriptorSetLayoutBinding, 1> sampler_binding;
-
-        if(a_params.immut_sampler)
-        {
-            sampler_binding[0].binding = 1;
-            sampler_binding[0].descriptorCount = 1;
-            sampler_binding[0].descriptorType = DescriptorType::eCombinedImageSampler;
-            sampler_binding[0].stageFlags = ShaderStageFlagBits::eFragment;
-            sampler_binding[0].pImmutableSamplers = &a_params.immut_sampler;
-        }
-        else
-        {
-            sampler_binding[0].binding = 1;
-            sampler_binding[0].descriptorCount = 1;
-            sampler_binding[0].descriptorType = DescriptorType::eCombinedImageSampler;
-            sampler_binding[0].stageFlags = ShaderStageFlagBits::eFragment;
-            sampler_binding[0].pImmutableSamplers = nullptr;
-        }
-
-        array<DescriptorSetLayoutBinding, 2> desc_bindings = {
-                ubo_layout_binding, sampler_binding[0]
-        };
-
-        DescriptorSetLayoutCreateInfo desc_set_layout_info;
-
-        desc_set_layout_info.bindingCount = desc_bindings.size();
-        desc_set_layout_info.pBindings = desc_bindings.data();
-
-        m_desc_set_layout = m_params.device.createDescriptorSetLayout(desc_set_layout_info);
-
-        PipelineLayoutCreateInfo pipeline_layout_info;
-
-        pipeline_layout_info.setLayoutCount = 1;
-        pipeline_layout_info.pSetLayouts = &m_desc_set_layout;
-        pipeline_layout_info.pushConstantRangeCount = 0;
-        pipeline_layout_info.pPushConstantRanges = nullptr;
-
         //-- Instantiate graphics pipeline with all of the above
 
-        // Create pipeline layout
-
-        m_pipeline_layout = m_params.device.createPipelineLayout(pipeline_layout_info);
-
         // Create graphics pipeline
 
         GraphicsPipelineCreateInfo graphics_pipeline_info;
@@ -302,50 +341,38 @@ namespace graphics
         graphics_pipeline_info.pDepthStencilState = &depth_stencil_info;
         graphics_pipeline_info.pColorBlendState = &color_blend_info;
         graphics_pipeline_info.pDynamicState = nullptr;
-        graphics_pipeline_info.layout = m_pipeline_layout;
+        graphics_pipeline_info.layout = m_layout->get();
         graphics_pipeline_info.renderPass = m_params.render_pass;
         graphics_pipeline_info.subpass = 0;
         graphics_pipeline_info.basePipelineHandle = nullptr;
         graphics_pipeline_info.basePipelineIndex = -1;
 
-        auto call_result = m_params.device.createGraphicsPipeline(nullptr, graphics_pipeline_info);
+        auto call_result = m_params.device.createGraphicsPipeline(m_params.cache, graphics_pipeline_info);
 
         if(call_result.result != Result::eSuccess)
-        {
-            destroy_resources();
             throw runtime_error{"Result is: " + to_string(call_result.result) +
                 " Couldn't create graphics pipeline."};
-        }
 
         m_graphics_pipeline = call_result.value;
     }
 
     pipeline::~pipeline()
     {
-        destroy_resources();
+        m_params.device.destroyPipeline(m_graphics_pipeline);
     }
 
-    Pipeline& pipeline::get()
+    Pipeline pipeline::get() const
     {
         return m_graphics_pipeline;
     }
 
-    DescriptorSetLayout& pipeline::get_desc_set()
+    DescriptorSetLayout pipeline::get_desc_set() const
     {
-        return m_desc_set_layout;
+        return m_layout->get_desc_set();
     }
 
-    PipelineLayout& pipeline::get_layout()
+    PipelineLayout pipeline::get_layout() const
     {
-        return m_pipeline_layout;
-    }
-
-    void pipeline::destroy_resources() noexcept
-    {
-        m_params.device.destroyDescriptorSetLayout(m_desc_set_layout);
-        m_params.device.destroyPipelineLayout(m_pipeline_layout);
-        m_params.device.destroyPipeline(m_graphics_pipeline);
-        m_params.device.destroyShaderModule(m_fragment_shader);
-        m_params.device.destroyShaderModule(m_vertex_shader);
+        return m_layout->get();
     }
-}
\ No newline at end of file
+}
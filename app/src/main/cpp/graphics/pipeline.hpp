@@ -18,50 +18,137 @@
 #ifndef NCV_GRAPHICS_PIPELINE_HPP
 #define NCV_GRAPHICS_PIPELINE_HPP
 
+#include <graphics/data/vertex.hpp>
+#include <graphics/shaders/reflection.hpp>
 #include <vulkan_hpp/vulkan.hpp>
 
-class AAssetManager;
+#include <memory>
+#include <type_traits>
 
 namespace graphics
 {
     class pipeline
     {
     public:
-        
+
+        // Values for the specialization constants of a shader stage, packed in declaration order.
+
+        struct specialization
+        {
+            template<typename T>
+            specialization& set(uint32_t a_constant_id, const T& a_value)
+            {
+                static_assert(std::is_trivially_copyable<T>::value, "Constant must be trivially copyable.");
+
+                auto pt = reinterpret_cast<const uint8_t*>(&a_value);
+
+                entries.push_back({a_constant_id, static_cast<uint32_t>(data.size()), sizeof(T)});
+                data.insert(data.end(), pt, pt + sizeof(T));
+
+                return *this;
+            }
+
+            bool operator==(const specialization& a_other) const
+            {
+                return entries == a_other.entries && data == a_other.data;
+            }
+
+            std::vector<vk::SpecializationMapEntry> entries;
+            std::vector<uint8_t> data;
+        };
+
         struct shaders_info
         {
             const std::string vert_filename;
             const std::string frag_filename;
+            specialization vert_constants = {};
+            specialization frag_constants = {};
         };
 
         struct parameters
         {
-            AAssetManager* ass_mgr;
             vk::Device device;
             vk::Extent2D surface_extent;
             vk::RenderPass render_pass;
             vk::Sampler immut_sampler;
+            vk::PipelineCache cache = nullptr;
+            data::vertex_input vertex_input = data::make_vertex_input<data::vertex_format>();
+        };
+
+        // Shader module of an embedded SPIR-V binary, along with its reflection.
+
+        class shader_stage
+        {
+        public:
+
+            shader_stage(vk::Device a_device, const std::string& a_name);
+            ~shader_stage();
+
+            shader_stage(const shader_stage&) = delete;
+            shader_stage& operator=(const shader_stage&) = delete;
+
+            vk::ShaderModule get() const { return m_module; }
+            const shaders::reflection& get_reflection() const { return m_reflection; }
+
+        private:
+
+            vk::Device m_device;
+            vk::ShaderModule m_module = nullptr;
+            shaders::reflection m_reflection;
         };
 
+        // Descriptor set and pipeline layouts derived from the reflection of a vertex and a fragment stage.
+
+        class layout
+        {
+        public:
+
+            layout(vk::Device a_device, const shader_stage& a_vertex, const shader_stage& a_fragment,
+                vk::Sampler a_immut_sampler);
+            ~layout();
+
+            layout(const layout&) = delete;
+            layout& operator=(const layout&) = delete;
+
+            vk::DescriptorSetLayout get_desc_set() const { return m_desc_set_layout; }
+            vk::PipelineLayout get() const { return m_pipeline_layout; }
+
+        private:
+
+            void destroy_resources() noexcept;
+
+            vk::Device m_device;
+            vk::DescriptorSetLayout m_desc_set_layout = nullptr;
+            vk::PipelineLayout m_pipeline_layout = nullptr;
+        };
+
+        // Standalone pipeline, owns its stages and layout.
+
         pipeline(const parameters& a_params, const shaders_info& a_shaders_info);
 
+        // Pipeline built from stages and a layout that may be shared with other pipelines.
+
+        pipeline(const parameters& a_params, const shaders_info& a_shaders_info,
+            std::shared_ptr<const shader_stage> a_vertex, std::shared_ptr<const shader_stage> a_fragment,
+            std::shared_ptr<const layout> a_layout);
+
         ~pipeline();
 
-        vk::Pipeline& get();
-        vk::DescriptorSetLayout& get_desc_set();
-        vk::PipelineLayout& get_layout();
+        pipeline(const pipeline&) = delete;
+        pipeline& operator=(const pipeline&) = delete;
 
-    private:
+        vk::Pipeline get() const;
+        vk::DescriptorSetLayout get_desc_set() const;
+        vk::PipelineLayout get_layout() const;
 
-        void destroy_resources() noexcept;
+    private:
 
         parameters m_params;
         shaders_info m_shaders_info;
 
-        vk::ShaderModule m_vertex_shader = nullptr;
-        vk::ShaderModule m_fragment_shader = nullptr;
-        vk::DescriptorSetLayout m_desc_set_layout = nullptr;
-        vk::PipelineLayout m_pipeline_layout = nullptr;
+        std::shared_ptr<const shader_stage> m_vertex_shader;
+        std::shared_ptr<const shader_stage> m_fragment_shader;
+        std::shared_ptr<const layout> m_layout;
         vk::Pipeline m_graphics_pipeline = nullptr;
     };
 
@@ -0,0 +1,265 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <graphics/pipeline_registry.hpp>
+#include <utilities/log.hpp>
+
+using namespace ::std;
+using namespace ::vk;
+using namespace ::utilities;
+
+namespace
+{
+    void hash_combine(size_t& a_seed, size_t a_value)
+    {
+        a_seed ^= a_value + 0x9e3779b9 + (a_seed << 6u) + (a_seed >> 2u);
+    }
+
+    void hash_specialization(size_t& a_seed, const ::graphics::pipeline::specialization& a_spec)
+    {
+        for(auto& entry : a_spec.entries)
+        {
+            hash_combine(a_seed, entry.constantID);
+            hash_combine(a_seed, entry.offset);
+            hash_combine(a_seed, entry.size);
+        }
+
+        for(auto byte : a_spec.data)
+            hash_combine(a_seed, byte);
+    }
+
+    void hash_vertex_input(size_t& a_seed, const ::graphics::data::vertex_input& a_input)
+    {
+        for(uint32_t i = 0; i < a_input.binding_count; ++i)
+        {
+            hash_combine(a_seed, a_input.bindings[i].binding);
+            hash_combine(a_seed, a_input.bindings[i].stride);
+        }
+
+        for(uint32_t i = 0; i < a_input.attribute_count; ++i)
+        {
+            hash_combine(a_seed, a_input.attributes[i].location);
+            hash_combine(a_seed, static_cast<size_t>(a_input.attributes[i].format));
+            hash_combine(a_seed, a_input.attributes[i].offset);
+            hash_combine(a_seed, a_input.attributes[i].binding);
+        }
+    }
+
+    bool equal_vertex_inputs(const ::graphics::data::vertex_input& a_lhs,
+        const ::graphics::data::vertex_input& a_rhs)
+    {
+        if(a_lhs.binding_count != a_rhs.binding_count || a_lhs.attribute_count != a_rhs.attribute_count)
+            return false;
+
+        for(uint32_t i = 0; i < a_lhs.binding_count; ++i)
+            if(a_lhs.bindings[i].binding != a_rhs.bindings[i].binding ||
+                a_lhs.bindings[i].stride != a_rhs.bindings[i].stride)
+                return false;
+
+        for(uint32_t i = 0; i < a_lhs.attribute_count; ++i)
+            if(a_lhs.attributes[i].location != a_rhs.attributes[i].location ||
+                a_lhs.attributes[i].format != a_rhs.attributes[i].format ||
+                a_lhs.attributes[i].offset != a_rhs.attributes[i].offset ||
+                a_lhs.attributes[i].binding != a_rhs.attributes[i].binding)
+                return false;
+
+        return true;
+    }
+}
+
+namespace graphics
+{
+    size_t pipeline_registry::request_hash::operator()(const request& a_request) const
+    {
+        size_t seed = 0;
+
+        hash_combine(seed, hash<string>{}(a_request.shaders.vert_filename));
+        hash_combine(seed, hash<string>{}(a_request.shaders.frag_filename));
+        hash_specialization(seed, a_request.shaders.vert_constants);
+        hash_specialization(seed, a_request.shaders.frag_constants);
+        hash_combine(seed, a_request.surface_extent.width);
+        hash_combine(seed, a_request.surface_extent.height);
+        hash_combine(seed, hash<VkRenderPass>{}(static_cast<VkRenderPass>(a_request.render_pass)));
+        hash_combine(seed, hash<VkSampler>{}(static_cast<VkSampler>(a_request.immut_sampler)));
+        hash_vertex_input(seed, a_request.vertex_input);
+
+        return seed;
+    }
+
+    bool pipeline_registry::request_equal::operator()(const request& a_lhs, const request& a_rhs) const
+    {
+        return a_lhs.shaders.vert_filename == a_rhs.shaders.vert_filename &&
+            a_lhs.shaders.frag_filename == a_rhs.shaders.frag_filename &&
+            a_lhs.shaders.vert_constants == a_rhs.shaders.vert_constants &&
+            a_lhs.shaders.frag_constants == a_rhs.shaders.frag_constants &&
+            a_lhs.surface_extent == a_rhs.surface_extent &&
+            a_lhs.render_pass == a_rhs.render_pass &&
+            a_lhs.immut_sampler == a_rhs.immut_sampler &&
+            equal_vertex_inputs(a_lhs.vertex_input, a_rhs.vertex_input);
+    }
+
+    size_t pipeline_registry::layout_key_hash::operator()(const layout_key& a_key) const
+    {
+        size_t seed = 0;
+
+        hash_combine(seed, hash<string>{}(get<0>(a_key)));
+        hash_combine(seed, hash<string>{}(get<1>(a_key)));
+        hash_combine(seed, hash<VkSampler>{}(get<2>(a_key)));
+
+        return seed;
+    }
+
+    pipeline_registry::pipeline_registry(Device a_device) : m_device{a_device}
+    {
+        m_cache = m_device.createPipelineCache(PipelineCacheCreateInfo{});
+    }
+
+    pipeline_registry::~pipeline_registry()
+    {
+        if constexpr(__ncv_logging_enabled)
+            _log_android(log_level::debug) << "Destroying pipeline registry (requests: " << m_stats.requests
+                << ", pipelines: " << m_stats.pipelines_created << ", layouts: " << m_stats.layouts_created
+                << ", stages: " << m_stats.stages_created << ").";
+
+        m_pipelines.clear();
+        m_layouts.clear();
+        m_stages.clear();
+        m_device.destroyPipelineCache(m_cache);
+    }
+
+    shared_ptr<pipeline> pipeline_registry::get(const request& a_request)
+    {
+        m_stats.requests++;
+
+        auto found = m_pipelines.find(a_request);
+
+        if(found != m_pipelines.end())
+            return found->second;
+
+        auto vertex = get_stage(a_request.shaders.vert_filename);
+        auto fragment = get_stage(a_request.shaders.frag_filename);
+
+        auto params = pipeline::parameters{
+            m_device,
+            a_request.surface_extent,
+            a_request.render_pass,
+            a_request.immut_sampler,
+            m_cache,
+            a_request.vertex_input
+        };
+
+        auto result = make_shared<pipeline>(params, a_request.shaders, vertex, fragment, get_layout(a_request));
+
+        m_stats.pipelines_created++;
+        m_pipelines.emplace(a_request, result);
+
+        return result;
+    }
+
+    size_t pipeline_registry::prewarm(const vector<request>& a_manifest)
+    {
+        auto created = m_stats.pipelines_created;
+
+        for(auto& entry : a_manifest)
+            get(entry);
+
+        created = m_stats.pipelines_created - created;
+
+        if constexpr(__ncv_logging_enabled)
+            _log_android(log_level::debug) << "Pipeline registry prewarmed, " << created << " of "
+                << a_manifest.size() << " manifest entries compiled.";
+
+        return created;
+    }
+
+    void pipeline_registry::trim()
+    {
+        // Pipelines go first since they hold references to layouts and stages
+
+        auto drop_unused = [](auto& a_map) {
+            for(auto it = a_map.begin(); it != a_map.end();)
+                it = it->second.use_count() == 1 ? a_map.erase(it) : next(it);
+        };
+
+        drop_unused(m_pipelines);
+        drop_unused(m_layouts);
+        drop_unused(m_stages);
+    }
+
+    void pipeline_registry::release(RenderPass a_render_pass)
+    {
+        for(auto it = m_pipelines.begin(); it != m_pipelines.end();)
+            it = it->first.render_pass == a_render_pass ? m_pipelines.erase(it) : next(it);
+
+        trim();
+    }
+
+    void pipeline_registry::release(Sampler a_sampler)
+    {
+        for(auto it = m_pipelines.begin(); it != m_pipelines.end();)
+            it = it->first.immut_sampler == a_sampler ? m_pipelines.erase(it) : next(it);
+
+        for(auto it = m_layouts.begin(); it != m_layouts.end();)
+            it = get<2>(it->first) == static_cast<VkSampler>(a_sampler) ? m_layouts.erase(it) : next(it);
+
+        trim();
+    }
+
+    shared_ptr<const pipeline::shader_stage> pipeline_registry::get_stage(const string& a_name)
+    {
+        auto& stage = m_stages[a_name];
+
+        if(!stage)
+        {
+            try
+            {
+                stage = make_shared<const pipeline::shader_stage>(m_device, a_name);
+            }
+            catch(exception const &e)
+            {
+                m_stages.erase(a_name);
+                throw e;
+            }
+
+            m_stats.stages_created++;
+        }
+
+        return stage;
+    }
+
+    shared_ptr<const pipeline::layout> pipeline_registry::get_layout(const request& a_request)
+    {
+        // Layouts only depend on the reflected stages and the immutable sampler, specialization and fixed
+        // function state don't affect them.
+
+        auto key = layout_key{a_request.shaders.vert_filename, a_request.shaders.frag_filename,
+            static_cast<VkSampler>(a_request.immut_sampler)};
+
+        auto found = m_layouts.find(key);
+
+        if(found != m_layouts.end())
+            return found->second;
+
+        auto result = make_shared<const pipeline::layout>(m_device, *get_stage(get<0>(key)),
+            *get_stage(get<1>(key)), a_request.immut_sampler);
+
+        m_stats.layouts_created++;
+        m_layouts.emplace(key, result);
+
+        return result;
+    }
+}
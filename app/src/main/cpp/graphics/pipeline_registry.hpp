@@ -0,0 +1,116 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_GRAPHICS_PIPELINE_REGISTRY_HPP
+#define NCV_GRAPHICS_PIPELINE_REGISTRY_HPP
+
+#include <graphics/pipeline.hpp>
+
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace graphics
+{
+    // Hands out pipelines, layouts and shader modules shared between every request for an equal state. Objects
+    // are keyed by a hash of the state they are built from and created on first request, so the number of
+    // pipeline compiles scales with the unique states rather than with the requests. All pipelines are created
+    // through a common pipeline cache.
+
+    class pipeline_registry
+    {
+    public:
+
+        // Full state of a pipeline, everything but the device
+
+        struct request
+        {
+            pipeline::shaders_info shaders;
+            vk::Extent2D surface_extent;
+            vk::RenderPass render_pass;
+            vk::Sampler immut_sampler;
+            data::vertex_input vertex_input = data::make_vertex_input<data::vertex_format>();
+        };
+
+        struct statistics
+        {
+            size_t requests = 0;
+            size_t pipelines_created = 0;
+            size_t layouts_created = 0;
+            size_t stages_created = 0;
+        };
+
+        explicit pipeline_registry(vk::Device a_device);
+        ~pipeline_registry();
+
+        pipeline_registry(const pipeline_registry&) = delete;
+        pipeline_registry& operator=(const pipeline_registry&) = delete;
+
+        std::shared_ptr<pipeline> get(const request& a_request);
+
+        // Creates ahead of time every pipeline listed, returns the number of pipelines actually compiled.
+
+        size_t prewarm(const std::vector<request>& a_manifest);
+
+        // Drops the objects nobody holds a reference to besides the registry.
+
+        void trim();
+
+        // Objects are keyed on raw handles, and a destroyed render pass or sampler may have its handle reused by
+        // a new one. Whoever destroys one calls this first, so that no later request matches what was built
+        // against it. Pipelines still held elsewhere stay alive but leave the registry.
+
+        void release(vk::RenderPass a_render_pass);
+        void release(vk::Sampler a_sampler);
+
+        const statistics& get_statistics() const { return m_stats; }
+
+    private:
+
+        struct request_hash
+        {
+            size_t operator()(const request& a_request) const;
+        };
+
+        struct request_equal
+        {
+            bool operator()(const request& a_lhs, const request& a_rhs) const;
+        };
+
+        using layout_key = std::tuple<std::string, std::string, VkSampler>;
+
+        struct layout_key_hash
+        {
+            size_t operator()(const layout_key& a_key) const;
+        };
+
+        std::shared_ptr<const pipeline::shader_stage> get_stage(const std::string& a_name);
+        std::shared_ptr<const pipeline::layout> get_layout(const request& a_request);
+
+        vk::Device m_device;
+        vk::PipelineCache m_cache = nullptr;
+
+        std::unordered_map<std::string, std::shared_ptr<const pipeline::shader_stage>> m_stages;
+        std::unordered_map<layout_key, std::shared_ptr<const pipeline::layout>, layout_key_hash> m_layouts;
+        std::unordered_map<request, std::shared_ptr<pipeline>, request_hash, request_equal> m_pipelines;
+
+        statistics m_stats;
+    };
+}
+
+#endif //NCV_GRAPHICS_PIPELINE_REGISTRY_HPP
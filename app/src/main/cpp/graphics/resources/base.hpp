@@ -18,31 +18,28 @@
 #ifndef NCV_RESOURCES_BASE_HPP
 #define NCV_RESOURCES_BASE_HPP
 
-#include <vulkan_hpp/vulkan.hpp>
+#include <graphics/resources/deletion_queue.hpp>
+#include <graphics/resources/memory_allocator.hpp>
 
 namespace graphics{ namespace resources{
 
+    // Resources take their memory from a shared allocator and hand their objects to a shared deletion queue
+    // when destroyed, both have to outlive them.
+
     class base
     {
     public:
 
-        enum class memory_location
-        {
-            device,
-            host,
-            external
-        };
-
-        base(const vk::PhysicalDevice& a_gpu, const vk::UniqueDevice& a_device);
+        base(memory_allocator& a_allocator, deletion_queue& a_deletions);
 
         size_t data_size() { return m_data_size; }
+        vk::DeviceSize memory_size() { return m_size; }
 
     protected:
 
-        int get_memory_index(uint32_t a_memory_type_bits, memory_location a_location) noexcept;
-
+        memory_allocator& m_allocator;
+        deletion_queue& m_deletions;
         vk::Device m_device = nullptr;
-        vk::PhysicalDeviceMemoryProperties m_mem_props;
         size_t m_data_size = 0;
         vk::DeviceSize m_size = 0;
     };
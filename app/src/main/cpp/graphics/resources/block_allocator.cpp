@@ -0,0 +1,145 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <graphics/resources/block_allocator.hpp>
+
+#include <stdexcept>
+
+using namespace ::std;
+
+namespace graphics{ namespace resources{
+
+    buddy_allocator::buddy_allocator(uint64_t a_capacity, uint64_t a_min_size) : m_min_size{a_min_size}
+    {
+        if(a_min_size == 0 || (a_min_size & (a_min_size - 1)) || a_capacity < a_min_size)
+            throw runtime_error{"Invalid buddy allocator geometry."};
+
+        // Capacity is rounded down to a power of two multiple of the minimum size
+
+        m_max_order = 0;
+
+        while((m_min_size << (m_max_order + 1)) <= a_capacity)
+            m_max_order++;
+
+        m_free.resize(m_max_order + 1);
+        m_free[m_max_order].insert(0);
+    }
+
+    uint32_t buddy_allocator::order_of(uint64_t a_size) const
+    {
+        uint32_t order = 0;
+
+        while((m_min_size << order) < a_size)
+            order++;
+
+        return order;
+    }
+
+    bool buddy_allocator::allocate(uint64_t a_size, uint64_t a_alignment, block_range &a_range)
+    {
+        uint64_t size = a_size > a_alignment ? a_size : a_alignment;
+
+        if(size > get_capacity())
+            return false;
+
+        auto order = order_of(size);
+        auto found = order;
+
+        while(found <= m_max_order && m_free[found].empty())
+            found++;
+
+        if(found > m_max_order)
+            return false;
+
+        auto offset = *m_free[found].begin();
+
+        m_free[found].erase(m_free[found].begin());
+
+        // Split down to the requested order, upper halves become free buddies
+
+        while(found > order)
+        {
+            found--;
+            m_free[found].insert(offset + (m_min_size << found));
+        }
+
+        a_range.offset = offset;
+        a_range.size = m_min_size << order;
+        m_used += a_range.size;
+
+        return true;
+    }
+
+    void buddy_allocator::free(const block_range &a_range)
+    {
+        auto order = order_of(a_range.size);
+        auto offset = a_range.offset;
+
+        m_used -= m_min_size << order;
+
+        // Merge with free buddies as far up as they go
+
+        while(order < m_max_order)
+        {
+            auto buddy = offset ^ (m_min_size << order);
+            auto it = m_free[order].find(buddy);
+
+            if(it == m_free[order].end())
+                break;
+
+            m_free[order].erase(it);
+            offset &= ~(m_min_size << order);
+            order++;
+        }
+
+        m_free[order].insert(offset);
+    }
+
+    uint64_t buddy_allocator::get_largest_free() const
+    {
+        for(auto order = m_max_order + 1; order-- > 0;)
+            if(!m_free[order].empty())
+                return m_min_size << order;
+
+        return 0;
+    }
+
+    bool linear_allocator::allocate(uint64_t a_size, uint64_t a_alignment, block_range &a_range)
+    {
+        uint64_t offset = (m_head + a_alignment - 1) & ~(a_alignment - 1);
+
+        if(offset + a_size > m_capacity)
+            return false;
+
+        a_range.offset = offset;
+        a_range.size = a_size;
+
+        m_head = offset + a_size;
+        m_used += a_size;
+        m_live++;
+
+        return true;
+    }
+
+    void linear_allocator::free(const block_range &a_range)
+    {
+        m_used -= a_range.size;
+
+        if(--m_live == 0)
+            m_head = 0;
+    }
+}}
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_RESOURCES_BLOCK_ALLOCATOR_HPP
+#define NCV_RESOURCES_BLOCK_ALLOCATOR_HPP
+
+#include <cstdint>
+#include <set>
+#include <vector>
+
+namespace graphics{ namespace resources{
+
+    // Offset bookkeeping inside a single memory block, no Vulkan involved. Alignments must be powers of two.
+
+    struct block_range
+    {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+    };
+
+    // Power of two buddy system. Every range is naturally aligned to its size, so any alignment up to the
+    // rounded size comes for free. Lowest offsets are handed out first, which keeps the tail of the block free
+    // for large requests.
+
+    class buddy_allocator
+    {
+    public:
+
+        explicit buddy_allocator(uint64_t a_capacity, uint64_t a_min_size = 256);
+
+        bool allocate(uint64_t a_size, uint64_t a_alignment, block_range& a_range);
+        void free(const block_range& a_range);
+
+        uint64_t get_capacity() const { return m_min_size << m_max_order; }
+        uint64_t get_used() const { return m_used; }
+        uint64_t get_largest_free() const;
+        bool empty() const { return m_used == 0; }
+
+    private:
+
+        uint32_t order_of(uint64_t a_size) const;
+
+        uint64_t m_min_size;
+        uint32_t m_max_order;
+        uint64_t m_used = 0;
+        std::vector<std::set<uint64_t>> m_free;
+    };
+
+    // Bump pointer for allocations that die together (staging). Freed ranges are only counted, the whole
+    // block rewinds once the last one is gone.
+
+    class linear_allocator
+    {
+    public:
+
+        explicit linear_allocator(uint64_t a_capacity) : m_capacity{a_capacity}
+        {}
+
+        bool allocate(uint64_t a_size, uint64_t a_alignment, block_range& a_range);
+        void free(const block_range& a_range);
+
+        uint64_t get_capacity() const { return m_capacity; }
+        uint64_t get_used() const { return m_used; }
+        uint64_t get_largest_free() const { return m_capacity - m_head; }
+        bool empty() const { return m_live == 0; }
+
+    private:
+
+        uint64_t m_capacity;
+        uint64_t m_head = 0;
+        uint64_t m_used = 0;
+        uint64_t m_live = 0;
+    };
+}}
+
+#endif //NCV_RESOURCES_BLOCK_ALLOCATOR_HPP
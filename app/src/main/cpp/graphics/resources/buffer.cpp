@@ -24,15 +24,55 @@ namespace graphics{ namespace resources{
 
     void buffer_base::destroy_resources() noexcept
     {
-        if(!!m_buffer)
-            m_device.destroyBuffer(m_buffer);
-        if(!!m_memory)
-            m_device.freeMemory(m_memory);
+        if(!m_buffer && !m_memory)
+            return;
+
+        m_deletions.retire([device = m_device, buffer = m_buffer, memory = m_memory,
+            &allocator = m_allocator]() mutable
+        {
+            if(!!buffer)
+                device.destroyBuffer(buffer);
+            allocator.free(memory);
+        });
+
+        m_buffer = nullptr;
+        m_memory = allocation{};
     }
 
-    buffer<device>::buffer(const PhysicalDevice &a_gpu, const UniqueDevice &a_device,
-        BufferUsageFlags a_usage, SharingMode a_sharing, uint32_t a_size)
-        : buffer_base{a_gpu, a_device}
+    upload_manager::buffer_region buffer_base::upload_target(const Buffer &a_buffer, BufferUsageFlags a_usage)
+    {
+        upload_manager::buffer_region target;
+
+        target.buffer = a_buffer;
+        target.dst_stage = PipelineStageFlags{};
+        target.dst_access = AccessFlags{};
+
+        if(a_usage & BufferUsageFlagBits::eVertexBuffer)
+        {
+            target.dst_stage |= PipelineStageFlagBits::eVertexInput;
+            target.dst_access |= AccessFlagBits::eVertexAttributeRead;
+        }
+        if(a_usage & BufferUsageFlagBits::eIndexBuffer)
+        {
+            target.dst_stage |= PipelineStageFlagBits::eVertexInput;
+            target.dst_access |= AccessFlagBits::eIndexRead;
+        }
+        if(a_usage & BufferUsageFlagBits::eUniformBuffer)
+        {
+            target.dst_stage |= PipelineStageFlagBits::eVertexShader | PipelineStageFlagBits::eFragmentShader;
+            target.dst_access |= AccessFlagBits::eUniformRead;
+        }
+        if(!target.dst_stage)
+        {
+            target.dst_stage = PipelineStageFlagBits::eAllCommands;
+            target.dst_access = AccessFlagBits::eMemoryRead;
+        }
+
+        return target;
+    }
+
+    buffer<device>::buffer(memory_allocator &a_allocator, deletion_queue &a_deletions, BufferUsageFlags a_usage,
+        SharingMode a_sharing, uint32_t a_size) : buffer_base{a_allocator, a_deletions}
     {
         BufferCreateInfo device_buffer_info;
 
@@ -44,18 +84,9 @@ namespace graphics{ namespace resources{
 
         m_buffer = m_device.createBuffer(device_buffer_info);
 
-        auto mem_reqs = m_device.getBufferMemoryRequirements(m_buffer);
-
-        m_size = mem_reqs.size;
-
-        MemoryAllocateInfo mem_info;
-
-        mem_info.memoryTypeIndex = get_memory_index(mem_reqs.memoryTypeBits, memory_location::device);
-        mem_info.allocationSize = mem_reqs.size;
-
         try
         {
-            m_memory = m_device.allocateMemory(mem_info);
+            m_memory = m_allocator.allocate(m_buffer, memory_location::device);
         }
         catch(exception const &e)
         {
@@ -63,14 +94,6 @@ namespace graphics{ namespace resources{
             throw e;
         }
 
-        try
-        {
-            m_device.bindBufferMemory(m_buffer, m_memory, 0);
-        }
-        catch(exception const &e)
-        {
-            destroy_resources();
-            throw e;
-        }
+        m_size = m_memory.size;
     }
 }}
@@ -20,6 +20,8 @@
 
 #include <graphics/resources/base.hpp>
 #include <graphics/resources/types.hpp>
+#include <graphics/resources/upload_manager.hpp>
+#include <utilities/span.hpp>
 
 namespace graphics{ namespace resources
 {
@@ -27,8 +29,8 @@ namespace graphics{ namespace resources
     {
     public:
 
-        buffer_base(const vk::PhysicalDevice& a_gpu, const vk::UniqueDevice& a_device)
-            : base{a_gpu, a_device}
+        buffer_base(memory_allocator& a_allocator, deletion_queue& a_deletions)
+            : base{a_allocator, a_deletions}
         {}
 
         virtual ~buffer_base() { destroy_resources(); }
@@ -39,7 +41,11 @@ namespace graphics{ namespace resources
 
         virtual void destroy_resources() noexcept;
 
-        vk::DeviceMemory m_memory = nullptr;
+        // Consumer stages and accesses an upload has to be made visible to, derived from the usage
+
+        static upload_manager::buffer_region upload_target(const vk::Buffer& a_buffer, vk::BufferUsageFlags a_usage);
+
+        allocation m_memory;
         vk::Buffer m_buffer = nullptr;
     };
 
@@ -50,50 +56,60 @@ namespace graphics{ namespace resources
     template<typename DataFormat>
     class buffer<external, DataFormat> {};
 
+    // Host buffers stay mapped for their whole lifetime, so updates are a plain copy (flushed when the memory
+    // isn't coherent) and can be issued as late as right before the submission that consumes them.
+
     template<typename DataFormat>
     class buffer<host, DataFormat> : public buffer_base
     {
     public:
-        buffer(const vk::PhysicalDevice& a_gpu, const vk::UniqueDevice& a_device,
-            vk::BufferUsageFlags a_usage, vk::SharingMode a_sharing, const std::vector<DataFormat>& a_data);
-        void update(const std::vector<DataFormat>& a_data);
+        buffer(memory_allocator& a_allocator, deletion_queue& a_deletions, vk::BufferUsageFlags a_usage,
+            vk::SharingMode a_sharing, utilities::span<const DataFormat> a_data);
+        void update(utilities::span<const DataFormat> a_data);
+        void update(const DataFormat& a_data, size_t a_index = 0);
+
+        // Direct access for producers that can write their output in place (e.g. instance transforms), the
+        // written elements have to be flushed afterwards.
+
+        DataFormat* get_mapped() { return reinterpret_cast<DataFormat*>(m_memory.mapped); }
+        void flush(size_t a_first, size_t a_count);
     };
 
     template<>
     class buffer<device> : public buffer_base
     {
     public:
-        buffer(const vk::PhysicalDevice& a_gpu, const vk::UniqueDevice& a_device,
-            vk::BufferUsageFlags a_usage, vk::SharingMode a_sharing, uint32_t a_size);
+        buffer(memory_allocator& a_allocator, deletion_queue& a_deletions, vk::BufferUsageFlags a_usage,
+            vk::SharingMode a_sharing, uint32_t a_size);
     };
 
+    // Device local buffers filled through the upload manager. Contents become visible to the consumers of the
+    // usage flags once the batch holding the upload has been submitted. On unified memory the buffer is mapped
+    // and written in place instead, no copy is recorded and the ticket stays 0. Either way, updates must not
+    // race with submissions still reading the buffer.
+
     template<typename DataFormat>
     class buffer<device_upload, DataFormat> : public buffer_base
     {
     public:
-        buffer(const vk::PhysicalDevice& a_gpu, const vk::UniqueDevice& a_device,
-            vk::BufferUsageFlags a_usage, vk::SharingMode a_sharing, const std::vector<DataFormat>& a_data);
-        ~buffer() { destroy_resources(); }
-        void update_staging(const std::vector<DataFormat>& a_data);
-        vk::Buffer& get_staging() { return m_staging_buffer; }
-        vk::DeviceSize size_staging() { return m_staging_size; }
+        buffer(memory_allocator& a_allocator, deletion_queue& a_deletions, upload_manager& a_uploader,
+            vk::BufferUsageFlags a_usage, vk::SharingMode a_sharing, utilities::span<const DataFormat> a_data);
+        void update(utilities::span<const DataFormat> a_data);
+        upload_manager::ticket get_ticket() const { return m_ticket; }
     private:
 
-        void destroy_resources() noexcept override;
-
-        vk::DeviceSize m_staging_size = 0;
-        vk::DeviceMemory m_staging_memory = nullptr;
-        vk::Buffer m_staging_buffer = nullptr;
+        upload_manager& m_uploader;
+        upload_manager::buffer_region m_target;
+        upload_manager::ticket m_ticket = 0;
     };
 
     template<typename DataFormat>
-    buffer<host, DataFormat>::buffer(const vk::PhysicalDevice &a_gpu, const vk::UniqueDevice &a_device,
-        vk::BufferUsageFlags a_usage, vk::SharingMode a_sharing, const std::vector<DataFormat> &a_data)
-        : buffer_base{a_gpu, a_device}
+    buffer<host, DataFormat>::buffer(memory_allocator &a_allocator, deletion_queue &a_deletions,
+        vk::BufferUsageFlags a_usage, vk::SharingMode a_sharing, utilities::span<const DataFormat> a_data)
+        : buffer_base{a_allocator, a_deletions}
     {
         using namespace ::vk;
         using std::exception;
-        using std::runtime_error;
 
         BufferCreateInfo device_buffer_info;
 
@@ -105,18 +121,9 @@ namespace graphics{ namespace resources
 
         m_buffer = m_device.createBuffer(device_buffer_info);
 
-        auto mem_reqs = m_device.getBufferMemoryRequirements(m_buffer);
-
-        m_size = mem_reqs.size;
-
-        MemoryAllocateInfo mem_info;
-
-        mem_info.memoryTypeIndex = get_memory_index(mem_reqs.memoryTypeBits, memory_location::host);
-        mem_info.allocationSize = mem_reqs.size;
-
         try
         {
-            m_memory = m_device.allocateMemory(mem_info);
+            m_memory = m_allocator.allocate(m_buffer, memory_location::host);
         }
         catch(exception const &e)
         {
@@ -124,120 +131,49 @@ namespace graphics{ namespace resources
             throw e;
         }
 
-        uint8_t* pt;
-        MemoryMapFlags map_flags {0};
-
-        auto result = m_device.mapMemory(m_memory, 0, mem_reqs.size, map_flags,
-            reinterpret_cast<void**>(&pt));
+        m_size = m_memory.size;
 
-        if(result == Result::eSuccess)
-        {
-            memcpy(pt, a_data.data(), m_size);
-        }
-        else
-        {
-            destroy_resources();
-            throw runtime_error{"Result is: " + to_string(result) + ". Could not copy host data."};
-        }
-
-        m_device.unmapMemory(m_memory);
-
-        try
-        {
-            m_device.bindBufferMemory(m_buffer, m_memory, 0);
-        }
-        catch(exception const &e)
-        {
-            destroy_resources();
-            throw e;
-        }
+        memcpy(m_memory.mapped, a_data.data(), m_data_size);
+        m_allocator.flush(m_memory, 0, m_data_size);
     }
 
     template<typename DataFormat>
-    inline void buffer<host, DataFormat>::update(const std::vector<DataFormat> &a_data)
+    inline void buffer<host, DataFormat>::update(utilities::span<const DataFormat> a_data)
     {
         if(a_data.size() * sizeof(DataFormat) != m_data_size)
             throw std::runtime_error{"Data size differs. Cannot update buffer."};
 
-        uint8_t* pt;
-        vk::MemoryMapFlags map_flags {0};
+        memcpy(m_memory.mapped, a_data.data(), m_data_size);
+        m_allocator.flush(m_memory, 0, m_data_size);
+    }
 
-        auto result = m_device.mapMemory(m_memory, 0, m_size, map_flags, reinterpret_cast<void**>(&pt));
+    template<typename DataFormat>
+    inline void buffer<host, DataFormat>::update(const DataFormat &a_data, size_t a_index)
+    {
+        if((a_index + 1) * sizeof(DataFormat) > m_data_size)
+            throw std::runtime_error{"Index out of range. Cannot update buffer."};
 
-        if(result == vk::Result::eSuccess)
-            memcpy(pt, a_data.data(), m_size);
-        else
-            throw std::runtime_error{"Result is: " + to_string(result) + ". Could not copy host data."};
+        memcpy(m_memory.mapped + a_index * sizeof(DataFormat), &a_data, sizeof(DataFormat));
+        m_allocator.flush(m_memory, a_index * sizeof(DataFormat), sizeof(DataFormat));
+    }
 
-        m_device.unmapMemory(m_memory);
+    template<typename DataFormat>
+    inline void buffer<host, DataFormat>::flush(size_t a_first, size_t a_count)
+    {
+        m_allocator.flush(m_memory, a_first * sizeof(DataFormat), a_count * sizeof(DataFormat));
     }
 
     template<typename DataFormat>
-    buffer<device_upload, DataFormat>::buffer(const vk::PhysicalDevice &a_gpu, const vk::UniqueDevice &a_device,
-        vk::BufferUsageFlags a_usage, vk::SharingMode a_sharing, const std::vector<DataFormat> &a_data)
-        : buffer_base{a_gpu, a_device}
+    buffer<device_upload, DataFormat>::buffer(memory_allocator &a_allocator, deletion_queue &a_deletions,
+        upload_manager &a_uploader, vk::BufferUsageFlags a_usage, vk::SharingMode a_sharing,
+        utilities::span<const DataFormat> a_data)
+        : buffer_base{a_allocator, a_deletions}, m_uploader{a_uploader}
     {
         using namespace ::vk;
         using std::exception;
-        using std::runtime_error;
-
-        BufferCreateInfo staging_buffer_info;
 
         m_data_size = a_data.size() * sizeof(DataFormat);
 
-        staging_buffer_info.usage = BufferUsageFlagBits::eTransferSrc;
-        staging_buffer_info.size = m_data_size;
-        staging_buffer_info.sharingMode = a_sharing;
-
-        m_staging_buffer = m_device.createBuffer(staging_buffer_info);
-
-        auto mem_reqs = m_device.getBufferMemoryRequirements(m_staging_buffer);
-
-        m_staging_size = mem_reqs.size;
-
-        MemoryAllocateInfo mem_info;
-
-        mem_info.memoryTypeIndex = get_memory_index(mem_reqs.memoryTypeBits, memory_location::host);
-        mem_info.allocationSize = mem_reqs.size;
-
-        try
-        {
-            m_staging_memory = m_device.allocateMemory(mem_info);
-        }
-        catch(exception const &e)
-        {
-            destroy_resources();
-            throw e;
-        }
-
-        uint8_t* pt;
-        MemoryMapFlags map_flags {0};
-
-        auto result = m_device.mapMemory(m_staging_memory, 0, m_staging_size, map_flags,
-             reinterpret_cast<void**>(&pt));
-
-        if(result == Result::eSuccess)
-        {
-            memcpy(pt, a_data.data(), m_staging_size);
-        }
-        else
-        {
-            destroy_resources();
-            throw runtime_error{"Result is: " + to_string(result) + ". Could not copy host data."};
-        }
-
-        m_device.unmapMemory(m_staging_memory);
-
-        try
-        {
-            m_device.bindBufferMemory(m_staging_buffer, m_staging_memory, 0);
-        }
-        catch(exception const &e)
-        {
-            destroy_resources();
-            throw e;
-        }
-
         BufferCreateInfo device_buffer_info;
 
         device_buffer_info.usage = BufferUsageFlagBits::eTransferDst | a_usage;
@@ -247,59 +183,39 @@ namespace graphics{ namespace resources
         try
         {
             m_buffer = m_device.createBuffer(device_buffer_info);
-        }
-        catch (exception const &e)
-        {
-            destroy_resources();
-            throw e;
-        }
-
-        mem_reqs = m_device.getBufferMemoryRequirements(m_buffer);
-
-        m_size = mem_reqs.size;
+            m_memory = m_allocator.allocate(m_buffer, memory_location::unified);
+            m_target = upload_target(m_buffer, a_usage);
 
-        mem_info.memoryTypeIndex = get_memory_index(mem_reqs.memoryTypeBits, memory_location::device);
-        mem_info.allocationSize = mem_reqs.size;
-
-        try
-        {
-            m_memory = m_device.allocateMemory(mem_info);
-            m_device.bindBufferMemory(m_buffer, m_memory,0);
+            if(m_memory.mapped)
+            {
+                memcpy(m_memory.mapped, a_data.data(), m_data_size);
+                m_allocator.flush(m_memory, 0, m_data_size);
+            }
+            else
+                m_ticket = m_uploader.enqueue(m_target, a_data.data(), m_data_size);
         }
         catch (exception const &e)
         {
             destroy_resources();
             throw e;
         }
-    }
 
-    template<typename DataFormat>
-    inline void buffer<device_upload, DataFormat>::destroy_resources() noexcept
-    {
-        if(!!m_staging_buffer)
-            m_device.destroyBuffer(m_staging_buffer);
-        if(!!m_staging_memory)
-            m_device.freeMemory(m_staging_memory);
+        m_size = m_memory.size;
     }
 
     template<typename DataFormat>
-    inline void buffer<device_upload, DataFormat>::update_staging(const std::vector<DataFormat> &a_data)
+    inline void buffer<device_upload, DataFormat>::update(utilities::span<const DataFormat> a_data)
     {
         if(a_data.size() * sizeof(DataFormat) != m_data_size)
             throw std::runtime_error{"Data size differs. Cannot update buffer."};
 
-        uint8_t* pt;
-        vk::MemoryMapFlags map_flags {0};
-
-        auto result = m_device.mapMemory(m_staging_memory, 0, m_staging_size, map_flags,
-            reinterpret_cast<void**>(&pt));
-
-        if(result == vk::Result::eSuccess)
-            memcpy(pt, a_data.data(), m_staging_size);
+        if(m_memory.mapped)
+        {
+            memcpy(m_memory.mapped, a_data.data(), m_data_size);
+            m_allocator.flush(m_memory, 0, m_data_size);
+        }
         else
-            throw std::runtime_error{"Result is: " + to_string(result) + ". Could not copy host data."};
-
-        m_device.unmapMemory(m_staging_memory);
+            m_ticket = m_uploader.enqueue(m_target, a_data.data(), m_data_size);
     }
 }}
 
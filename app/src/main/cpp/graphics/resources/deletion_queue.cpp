@@ -0,0 +1,93 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <graphics/resources/deletion_queue.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using namespace ::std;
+
+namespace graphics{ namespace resources{
+
+    void deletion_queue::retire(function<void()> a_destroy)
+    {
+        lock_guard<mutex> lock{m_mutex};
+
+        m_pending.push_back({m_current, move(a_destroy)});
+        m_stats.retired++;
+        m_stats.peak_pending = std::max<uint64_t>(m_stats.peak_pending, m_pending.size());
+    }
+
+    deletion_queue::frame deletion_queue::advance()
+    {
+        lock_guard<mutex> lock{m_mutex};
+
+        return m_current++;
+    }
+
+    void deletion_queue::collect(frame a_completed)
+    {
+        // Destructions run outside of the lock, they may retire further objects
+
+        vector<function<void()>> ready;
+
+        {
+            lock_guard<mutex> lock{m_mutex};
+
+            while(!m_pending.empty() && m_pending.front().stamp <= a_completed)
+            {
+                ready.push_back(move(m_pending.front().destroy));
+                m_pending.pop_front();
+            }
+
+            m_stats.destroyed += ready.size();
+        }
+
+        for(auto& destroy : ready)
+            destroy();
+    }
+
+    void deletion_queue::flush()
+    {
+        for(;;)
+        {
+            {
+                lock_guard<mutex> lock{m_mutex};
+
+                if(m_pending.empty())
+                    return;
+            }
+
+            collect(UINT64_MAX);
+        }
+    }
+
+    deletion_queue::frame deletion_queue::get_current() const
+    {
+        lock_guard<mutex> lock{m_mutex};
+
+        return m_current;
+    }
+
+    deletion_queue::statistics deletion_queue::get_statistics() const
+    {
+        lock_guard<mutex> lock{m_mutex};
+
+        return m_stats;
+    }
+}}
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_RESOURCES_DELETION_QUEUE_HPP
+#define NCV_RESOURCES_DELETION_QUEUE_HPP
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace graphics{ namespace resources{
+
+    // Objects the GPU may still be using are not destroyed on the spot, their destruction is stamped with the
+    // frame being recorded and runs once that frame is known to be complete. Frames are numbered in submission
+    // order, so completion of one implies completion of every earlier frame (and of every earlier submission
+    // on the same queue, uploads included).
+
+    class deletion_queue
+    {
+    public:
+
+        using frame = uint64_t;
+
+        struct statistics
+        {
+            uint64_t retired = 0;
+            uint64_t destroyed = 0;
+            uint64_t peak_pending = 0;
+        };
+
+        deletion_queue() = default;
+
+        // Whatever is left runs here, the owner has to make sure the device is idle by then
+
+        ~deletion_queue() { flush(); }
+
+        deletion_queue(const deletion_queue&) = delete;
+        deletion_queue& operator=(const deletion_queue&) = delete;
+
+        void retire(std::function<void()> a_destroy);
+
+        // Closes the frame being recorded (call after its submission) and returns its number
+
+        frame advance();
+
+        // Runs the destructions of every frame up to and including a_completed
+
+        void collect(frame a_completed);
+
+        // Runs everything, for use after a device wide wait
+
+        void flush();
+
+        frame get_current() const;
+        statistics get_statistics() const;
+
+    private:
+
+        struct entry
+        {
+            frame stamp;
+            std::function<void()> destroy;
+        };
+
+        mutable std::mutex m_mutex;
+        std::deque<entry> m_pending;
+        frame m_current = 1;
+        statistics m_stats;
+    };
+}}
+
+#endif //NCV_RESOURCES_DELETION_QUEUE_HPP
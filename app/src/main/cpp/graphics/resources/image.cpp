@@ -18,25 +18,34 @@
 #include <graphics/resources/image.hpp>
 #include <android_native_app_glue.h>
 
+#include <algorithm>
+
 using namespace ::vk;
 
 namespace graphics{ namespace resources{
 
     void image_base::destroy_resources() noexcept
     {
-        if(!!m_img_view)
-            m_device.destroyImageView(m_img_view);
-        if(!!m_image)
-            m_device.destroyImage(m_image);
-        if(!!m_memory)
-            m_device.freeMemory(m_memory);
+        if(!m_img_view && !m_image && !m_memory)
+            return;
+
+        m_deletions.retire([device = m_device, view = m_img_view, image = m_image, memory = m_memory,
+            &allocator = m_allocator]() mutable
+        {
+            if(!!view)
+                device.destroyImageView(view);
+            if(!!image)
+                device.destroyImage(image);
+            allocator.free(memory);
+        });
+
         m_img_view = nullptr;
         m_image = nullptr;
-        m_memory = nullptr;
+        m_memory = allocation{};
     }
 
-    image<external, void>::image(const PhysicalDevice &a_gpu, const UniqueDevice &a_device,
-        AHardwareBuffer *a_buffer) : image_base{a_gpu, a_device}
+    image<external, void>::image(memory_allocator &a_allocator, deletion_queue &a_deletions, AHardwareBuffer *a_buffer)
+        : image_base{a_allocator, a_deletions}
     {
         AHardwareBuffer_Desc buffer_desc;
         AHardwareBuffer_describe(a_buffer, &buffer_desc);
@@ -111,19 +120,28 @@ namespace graphics{ namespace resources{
 
     void image<external, void>::destroy_resources() noexcept
     {
-        if(!!m_sampler)
-            m_device.destroySampler(m_sampler);
-        if(!!m_conversion)
-            m_device.destroySamplerYcbcrConversion(m_conversion);
+        if(!m_sampler && !m_conversion)
+            return;
+
+        m_deletions.retire([device = m_device, sampler = m_sampler, conversion = m_conversion]()
+        {
+            if(!!sampler)
+                device.destroySampler(sampler);
+            if(!!conversion)
+                device.destroySamplerYcbcrConversion(conversion);
+        });
+
+        m_sampler = nullptr;
+        m_conversion = nullptr;
     }
 
     void image<external, void>::update(ImageUsageFlags a_usage, SharingMode a_sharing,
         AHardwareBuffer *a_buffer)
     {
-        // No exception handling is required inside this body because resources are freed as soon as
-        // control enters this function member.
+        // The previous image may still be sampled by frames in flight, it is handed to the deletion queue
+        // rather than waiting for the device. No exception handling is required inside this body because
+        // resources are released as soon as control enters this function member.
 
-        m_device.waitIdle();
         image_base::destroy_resources();
 
         AHardwareBuffer_Desc buffer_desc;
@@ -196,15 +214,15 @@ namespace graphics{ namespace resources{
 
         m_size = properties_info.allocationSize;
 
-        mem_info.memoryTypeIndex = get_memory_index(properties_info.memoryTypeBits,
+        mem_info.memoryTypeIndex = m_allocator.get_memory_index(properties_info.memoryTypeBits,
             memory_location::external);
 
-        m_memory = m_device.allocateMemory(mem_info);
+        m_memory = m_allocator.import(mem_info);
 
         BindImageMemoryInfo bind_info;
 
         bind_info.image = m_image;
-        bind_info.memory = m_memory;
+        bind_info.memory = m_memory.memory;
         bind_info.memoryOffset = 0;
 
         m_device.bindImageMemory2KHR(bind_info);
@@ -248,9 +266,8 @@ namespace graphics{ namespace resources{
         m_img_view = m_device.createImageView(img_view_info);
     }
     
-    image<device>::image(const PhysicalDevice &a_gpu, const UniqueDevice &a_device,
-        ImageUsageFlags a_usage, SharingMode a_sharing, const Extent2D &a_extent)
-        : image_base{a_gpu, a_device}
+    image<device>::image(memory_allocator &a_allocator, deletion_queue &a_deletions, ImageUsageFlags a_usage,
+        SharingMode a_sharing, const Extent2D &a_extent) : image_base{a_allocator, a_deletions}
     {
         ImageCreateInfo image_info;
 
@@ -270,16 +287,6 @@ namespace graphics{ namespace resources{
 
         m_image = m_device.createImage(image_info);
 
-        auto mem_reqs = m_device.getImageMemoryRequirements(m_image);
-
-        MemoryAllocateInfo mem_info;
-
-        mem_info.memoryTypeIndex = get_memory_index(mem_reqs.memoryTypeBits, memory_location::device);
-        mem_info.allocationSize = mem_reqs.size;
-
-        m_size = mem_reqs.size;
-        m_data_size = static_cast<size_t>(m_size);
-
         ImageViewCreateInfo img_view_info;
 
         img_view_info.image = m_image;
@@ -294,8 +301,7 @@ namespace graphics{ namespace resources{
 
         try
         {
-            m_memory = m_device.allocateMemory(mem_info);
-            m_device.bindImageMemory(m_image, m_memory, 0);
+            m_memory = m_allocator.allocate(m_image, memory_location::device);
             m_img_view = m_device.createImageView(img_view_info);
         }
         catch(std::exception const &e)
@@ -303,5 +309,8 @@ namespace graphics{ namespace resources{
             destroy_resources();
             throw e;
         }
+
+        m_size = m_memory.size;
+        m_data_size = static_cast<size_t>(m_size);
     }
 }}
\ No newline at end of file
@@ -18,8 +18,14 @@
 #ifndef NCV_RESOURCES_IMAGE_HPP
 #define NCV_RESOURCES_IMAGE_HPP
 
+#include <graphics/data/mip_chain.hpp>
 #include <graphics/resources/base.hpp>
 #include <graphics/resources/types.hpp>
+#include <graphics/resources/upload_manager.hpp>
+#include <utilities/span.hpp>
+
+#include <algorithm>
+#include <vector>
 
 namespace graphics{ namespace resources{
 
@@ -27,20 +33,23 @@ namespace graphics{ namespace resources{
     {
     public:
 
-        image_base(const vk::PhysicalDevice& a_gpu, const vk::UniqueDevice& a_device)
-            : base{a_gpu, a_device}
+        image_base(memory_allocator& a_allocator, deletion_queue& a_deletions)
+            : base{a_allocator, a_deletions}
         {}
 
         virtual ~image_base()  { destroy_resources(); }
 
         vk::Image& get() { return m_image; }
         vk::ImageView& get_img_view() { return m_img_view; }
+        uint32_t get_mip_levels() const { return m_mip_levels; }
 
     protected:
 
         virtual void destroy_resources() noexcept;
 
-        vk::DeviceMemory m_memory = nullptr;
+        uint32_t m_mip_levels = 1;
+
+        allocation m_memory;
         vk::Image m_image = nullptr;
         vk::ImageView m_img_view = nullptr;
     };
@@ -53,7 +62,7 @@ namespace graphics{ namespace resources{
     class image<external> : public image_base
     {
     public:
-        image(const vk::PhysicalDevice& a_gpu, const vk::UniqueDevice& a_device, AHardwareBuffer* a_buffer);
+        image(memory_allocator& a_allocator, deletion_queue& a_deletions, AHardwareBuffer* a_buffer);
         ~image() { destroy_resources(); }
         void update(vk::ImageUsageFlags a_usage, vk::SharingMode a_sharing, AHardwareBuffer* a_buffer);
         vk::Sampler& get_sampler() { return m_sampler; }
@@ -72,35 +81,63 @@ namespace graphics{ namespace resources{
     class image<device> : public image_base
     {
     public:
-        image(const vk::PhysicalDevice& a_gpu, const vk::UniqueDevice& a_device,
-            vk::ImageUsageFlags a_usage, vk::SharingMode a_sharing, const vk::Extent2D& a_extent);
+        image(memory_allocator& a_allocator, deletion_queue& a_deletions, vk::ImageUsageFlags a_usage,
+            vk::SharingMode a_sharing, const vk::Extent2D& a_extent);
     };
 
+    // Sampled images filled through the upload manager, they are in shader read only layout once the batch
+    // holding the upload has been submitted. Mipmapped images get a full chain, generated with blits on the
+    // GPU when the format supports linear blits and on the CPU otherwise. Prebuilt chains (block compressed
+    // formats included) are uploaded level by level as given. When the upload manager can host copy the format,
+    // the constructors write the image from the CPU right away (get_ticket() stays 0, and mipmaps are generated
+    // on the CPU), which makes them safe to run on worker threads. Updates always go through the ring.
+    //
+    // a_owner, when given, keeps the data alive until the upload completes so the upload manager may copy from it
+    // in place (host import) rather than through the ring.
+
     template<typename ImageDataFormat>
     class image<device_upload, ImageDataFormat> : public image_base
     {
     public:
-        image(const vk::PhysicalDevice& a_gpu, const vk::UniqueDevice& a_device,
-            vk::ImageUsageFlags a_usage, vk::SharingMode a_sharing, vk::Extent3D& a_extent,
-            vk::Format a_format, const std::vector<ImageDataFormat>& a_data);
-        ~image() { destroy_resources(); }
-        void update_staging(const std::vector<ImageDataFormat>& a_data);
-        vk::Buffer& get_staging() { return m_staging_buffer; }
-        vk::DeviceSize size_staging() { return m_staging_size; }
-    private:
+        image(memory_allocator& a_allocator, deletion_queue& a_deletions, upload_manager& a_uploader,
+            vk::ImageUsageFlags a_usage, vk::SharingMode a_sharing, vk::Extent3D& a_extent, vk::Format a_format,
+            utilities::span<const ImageDataFormat> a_data, bool a_mipmapped = false,
+            std::shared_ptr<const void> a_owner = nullptr);
 
-        void destroy_resources() noexcept override;
+        // a_levels[0] is the base level, each following one half the size of the one above
+
+        image(memory_allocator& a_allocator, deletion_queue& a_deletions, upload_manager& a_uploader,
+            vk::ImageUsageFlags a_usage, vk::SharingMode a_sharing, vk::Extent3D& a_extent, vk::Format a_format,
+            const std::vector<utilities::span<const ImageDataFormat>>& a_levels,
+            std::shared_ptr<const void> a_owner = nullptr);
 
-        vk::DeviceSize m_staging_size = 0;
-        vk::DeviceMemory m_staging_memory = nullptr;
-        vk::Buffer m_staging_buffer = nullptr;
+        // Single level and generated chains only
+
+        void update(utilities::span<const ImageDataFormat> a_data);
+        upload_manager::ticket get_ticket() const { return m_ticket; }
+    private:
+
+        void create(vk::ImageUsageFlags a_usage, vk::SharingMode a_sharing, const vk::Extent3D& a_extent,
+            vk::Format a_format);
+        void enqueue(utilities::span<const ImageDataFormat> a_data, bool a_host_copy,
+            const std::shared_ptr<const void>& a_owner = nullptr);
+        void write(const upload_manager::image_region& a_region, const void* a_data, vk::DeviceSize a_size,
+            bool a_host_copy, const std::shared_ptr<const void>& a_owner = nullptr);
+
+        upload_manager& m_uploader;
+        uint32_t m_channels = 0;
+        bool m_cpu_mips = false;
+        bool m_prebuilt = false;
+        upload_manager::image_region m_target;
+        upload_manager::ticket m_ticket = 0;
     };
 
     template<typename ImageDataFormat>
-    image<device_upload, ImageDataFormat>::image(const vk::PhysicalDevice &a_gpu,
-        const vk::UniqueDevice &a_device, vk::ImageUsageFlags a_usage, vk::SharingMode a_sharing,
-        vk::Extent3D &a_extent, vk::Format a_format, const std::vector<ImageDataFormat> &a_data)
-        : image_base{a_gpu, a_device}
+    image<device_upload, ImageDataFormat>::image(memory_allocator &a_allocator, deletion_queue &a_deletions,
+        upload_manager &a_uploader, vk::ImageUsageFlags a_usage, vk::SharingMode a_sharing, vk::Extent3D &a_extent,
+        vk::Format a_format, utilities::span<const ImageDataFormat> a_data, bool a_mipmapped,
+        std::shared_ptr<const void> a_owner)
+        : image_base{a_allocator, a_deletions}, m_uploader{a_uploader}
     {
         using namespace ::vk;
 
@@ -125,61 +162,102 @@ namespace graphics{ namespace resources{
 
         m_data_size = a_extent.width * a_extent.height * num_channels;
 
-        BufferCreateInfo staging_buffer_info;
+        if(a_data.size() * sizeof(ImageDataFormat) != m_data_size)
+            throw std::runtime_error{"Data size differs from image extent."};
 
-        staging_buffer_info.usage = BufferUsageFlagBits::eTransferSrc;
-        staging_buffer_info.size = m_data_size;
-        staging_buffer_info.sharingMode = a_sharing;
+        m_channels = num_channels;
 
-        m_staging_buffer = m_device.createBuffer(staging_buffer_info);
+        auto usage = ImageUsageFlagBits::eTransferDst | a_usage;
+        auto host_usage = m_uploader.get_host_copy_usage(a_format, usage);
 
-        auto mem_reqs = m_device.getBufferMemoryRequirements(m_staging_buffer);
+        if(host_usage)
+            usage = *host_usage;
 
-        m_staging_size = mem_reqs.size;
+        if(a_mipmapped)
+        {
+            m_mip_levels = data::mip_count(a_extent.width, a_extent.height);
+
+            auto blit_features = FormatFeatureFlagBits::eBlitSrc | FormatFeatureFlagBits::eBlitDst |
+                FormatFeatureFlagBits::eSampledImageFilterLinear;
+            auto features = m_allocator.get_physical_device().getFormatProperties(a_format).optimalTilingFeatures;
 
-        MemoryAllocateInfo mem_info;
+            // Host copies have no command buffer to blit in
 
-        mem_info.memoryTypeIndex = get_memory_index(mem_reqs.memoryTypeBits, memory_location::host);
-        mem_info.allocationSize = mem_reqs.size;
+            m_cpu_mips = m_mip_levels > 1 && (host_usage || (features & blit_features) != blit_features);
+
+            if(!m_cpu_mips && !host_usage)
+                usage |= ImageUsageFlagBits::eTransferSrc;
+        }
+
+        create(usage, a_sharing, a_extent, a_format);
 
         try
         {
-            m_staging_memory = m_device.allocateMemory(mem_info);
+            m_target.image = m_image;
+            m_target.extent = a_extent;
+            m_target.mip_levels = m_cpu_mips ? 1 : m_mip_levels;
+            m_target.block_size = m_channels;
+
+            if(host_usage)
+                m_uploader.host_transition(m_image, m_mip_levels, m_target.final_layout);
+
+            enqueue(a_data, host_usage.has_value(), a_owner);
         }
-        catch (std::exception const &e)
+        catch(std::exception const &e)
         {
             destroy_resources();
             throw e;
         }
+    }
 
-        uint8_t* pt;
-        MemoryMapFlags map_flags {0};
+    template<typename ImageDataFormat>
+    image<device_upload, ImageDataFormat>::image(memory_allocator &a_allocator, deletion_queue &a_deletions,
+        upload_manager &a_uploader, vk::ImageUsageFlags a_usage, vk::SharingMode a_sharing, vk::Extent3D &a_extent,
+        vk::Format a_format, const std::vector<utilities::span<const ImageDataFormat>>& a_levels,
+        std::shared_ptr<const void> a_owner)
+        : image_base{a_allocator, a_deletions}, m_uploader{a_uploader}, m_prebuilt{true}
+    {
+        if(a_levels.empty() || a_levels.size() > data::mip_count(a_extent.width, a_extent.height))
+            throw std::runtime_error{"Level count doesn't fit the image extent."};
 
-        auto mresult = m_device.mapMemory(m_staging_memory, 0, mem_reqs.size, map_flags,
-            reinterpret_cast<void**>(&pt));
+        m_mip_levels = static_cast<uint32_t>(a_levels.size());
 
-        if(mresult == Result::eSuccess)
-        {
-            memcpy(pt, a_data.data(), m_staging_size);
-        }
-        else
-        {
-            destroy_resources();
-            throw std::runtime_error{"Result is: " + to_string(mresult) +
-                ". Could not copy image data to staging buffer."};
-        }
+        for(auto& level : a_levels)
+            m_data_size += level.size() * sizeof(ImageDataFormat);
+
+        auto usage = vk::ImageUsageFlagBits::eTransferDst | a_usage;
+        auto host_usage = m_uploader.get_host_copy_usage(a_format, usage);
 
-        m_device.unmapMemory(m_staging_memory);
+        create(host_usage ? *host_usage : usage, a_sharing, a_extent, a_format);
 
         try
         {
-            m_device.bindBufferMemory(m_staging_buffer, m_staging_memory, 0);
+            m_target.image = m_image;
+
+            if(host_usage)
+                m_uploader.host_transition(m_image, m_mip_levels, m_target.final_layout);
+
+            for(uint32_t level = 0; level < m_mip_levels; ++level)
+            {
+                m_target.subresource.mipLevel = level;
+                m_target.extent = vk::Extent3D{std::max(a_extent.width >> level, 1u),
+                    std::max(a_extent.height >> level, 1u), 1};
+                write(m_target, a_levels[level].data(), a_levels[level].size() * sizeof(ImageDataFormat),
+                    host_usage.has_value(), a_owner);
+            }
         }
-        catch (std::exception const &e)
+        catch(std::exception const &e)
         {
             destroy_resources();
             throw e;
         }
+    }
+
+    template<typename ImageDataFormat>
+    void image<device_upload, ImageDataFormat>::create(vk::ImageUsageFlags a_usage, vk::SharingMode a_sharing,
+        const vk::Extent3D& a_extent, vk::Format a_format)
+    {
+        using namespace ::vk;
 
         ImageCreateInfo image_info;
 
@@ -189,11 +267,11 @@ namespace graphics{ namespace resources{
         image_info.extent.width = a_extent.width;
         image_info.extent.height = a_extent.height;
         image_info.extent.depth = a_extent.depth;
-        image_info.mipLevels = 1;
+        image_info.mipLevels = m_mip_levels;
         image_info.arrayLayers = 1;
         image_info.samples = SampleCountFlagBits::e1;
         image_info.tiling = ImageTiling::eOptimal;
-        image_info.usage = ImageUsageFlagBits::eTransferDst | a_usage;
+        image_info.usage = a_usage;
         image_info.sharingMode = a_sharing;
         image_info.queueFamilyIndexCount = 0;
         image_info.pQueueFamilyIndices = nullptr;
@@ -201,13 +279,6 @@ namespace graphics{ namespace resources{
 
         m_image = m_device.createImage(image_info);
 
-        mem_reqs = m_device.getImageMemoryRequirements(m_image);
-
-        mem_info.memoryTypeIndex = get_memory_index(mem_reqs.memoryTypeBits, memory_location::device);
-        mem_info.allocationSize = mem_reqs.size;
-
-        m_size = mem_reqs.size;
-
         ImageViewCreateInfo img_view_info;
 
         img_view_info.image = m_image;
@@ -216,14 +287,13 @@ namespace graphics{ namespace resources{
         //img_view_info.components
         img_view_info.subresourceRange.aspectMask = ImageAspectFlagBits::eColor;
         img_view_info.subresourceRange.baseMipLevel = 0;
-        img_view_info.subresourceRange.levelCount = 1;
+        img_view_info.subresourceRange.levelCount = m_mip_levels;
         img_view_info.subresourceRange.baseArrayLayer = 0;
         img_view_info.subresourceRange.layerCount = 1;
 
         try
         {
-            m_memory = m_device.allocateMemory(mem_info);
-            m_device.bindImageMemory(m_image, m_memory, 0);
+            m_memory = m_allocator.allocate(m_image, memory_location::device);
             m_img_view = m_device.createImageView(img_view_info);
         }
         catch(std::exception const &e)
@@ -231,35 +301,64 @@ namespace graphics{ namespace resources{
             destroy_resources();
             throw e;
         }
+
+        m_size = m_memory.size;
     }
 
     template<typename ImageDataFormat>
-    void image<device_upload, ImageDataFormat>::destroy_resources() noexcept
+    void image<device_upload, ImageDataFormat>::update(utilities::span<const ImageDataFormat> a_data)
     {
-        if(!!m_staging_buffer)
-            m_device.destroyBuffer(m_staging_buffer);
-        if(!!m_staging_memory)
-            m_device.freeMemory(m_staging_memory);
+        if(m_prebuilt)
+            throw std::runtime_error{"Prebuilt mip chains cannot be updated."};
+
+        if(a_data.size() * sizeof(ImageDataFormat) != m_data_size)
+            throw std::runtime_error{"Data size differs. Cannot update image."};
+
+        enqueue(a_data, false);
     }
 
     template<typename ImageDataFormat>
-    void image<device_upload, ImageDataFormat>::update_staging(const std::vector<ImageDataFormat> &a_data)
+    void image<device_upload, ImageDataFormat>::enqueue(utilities::span<const ImageDataFormat> a_data,
+        bool a_host_copy, const std::shared_ptr<const void>& a_owner)
     {
-        if(a_data.size() * sizeof(ImageDataFormat) != m_data_size)
-            throw std::runtime_error{"Data size differs. Cannot update buffer."};
+        write(m_target, a_data.data(), m_data_size, a_host_copy, a_owner);
 
-        uint8_t* pt;
-        vk::MemoryMapFlags map_flags {0};
+        if(!m_cpu_mips)
+            return;
 
-        auto result = m_device.mapMemory(m_staging_memory, 0, m_staging_size, map_flags,
-            reinterpret_cast<void**>(&pt));
+        // Every level is filtered from the one above it and uploaded on its own, from scratch memory (no owner)
 
-        if(result == vk::Result::eSuccess)
-            memcpy(pt, a_data.data(), m_staging_size);
-        else
-            throw std::runtime_error{"Result is: " + to_string(result) + ". Could not copy host data."};
+        auto region = m_target;
+        auto width = region.extent.width, height = region.extent.height;
+        auto above = reinterpret_cast<const uint8_t*>(a_data.data());
+        std::vector<uint8_t> current, next;
+
+        for(uint32_t level = 1; level < m_mip_levels; ++level)
+        {
+            auto level_width = std::max(width / 2, 1u), level_height = std::max(height / 2, 1u);
+
+            next.resize(static_cast<size_t>(level_width) * level_height * m_channels);
+            data::downsample(above, width, height, m_channels, next.data());
+
+            region.subresource.mipLevel = level;
+            region.extent = vk::Extent3D{level_width, level_height, 1};
+            write(region, next.data(), next.size(), a_host_copy);
 
-        m_device.unmapMemory(m_staging_memory);
+            current.swap(next);
+            above = current.data();
+            width = level_width;
+            height = level_height;
+        }
+    }
+
+    template<typename ImageDataFormat>
+    void image<device_upload, ImageDataFormat>::write(const upload_manager::image_region &a_region,
+        const void *a_data, vk::DeviceSize a_size, bool a_host_copy, const std::shared_ptr<const void>& a_owner)
+    {
+        if(a_host_copy)
+            m_uploader.host_copy(a_region, a_data, a_size);
+        else
+            m_ticket = m_uploader.enqueue(a_region, a_data, a_size, a_owner);
     }
 }}
 
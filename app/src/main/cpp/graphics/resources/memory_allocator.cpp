@@ -0,0 +1,532 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <graphics/resources/memory_allocator.hpp>
+#include <utilities/log.hpp>
+
+using namespace ::std;
+using namespace ::vk;
+using namespace ::utilities;
+
+namespace
+{
+    uint32_t count_bits(uint32_t a_bits)
+    {
+        uint32_t count = 0;
+
+        for(; a_bits; a_bits &= a_bits - 1)
+            count++;
+
+        return count;
+    }
+
+    DeviceSize largest_device_heap(const PhysicalDeviceMemoryProperties &a_props)
+    {
+        DeviceSize largest = 0;
+
+        for(uint32_t i = 0; i < a_props.memoryHeapCount; ++i)
+            if(a_props.memoryHeaps[i].flags & MemoryHeapFlagBits::eDeviceLocal)
+                largest = std::max(largest, a_props.memoryHeaps[i].size);
+
+        return largest;
+    }
+}
+
+namespace graphics{ namespace resources{
+
+    optional<uint32_t> find_memory_type(const PhysicalDeviceMemoryProperties &a_props, uint32_t a_type_bits,
+        memory_location a_location)
+    {
+        using flag = MemoryPropertyFlagBits;
+
+        const auto mapped = flag::eHostVisible | flag::eHostCoherent;
+        const auto coherent = flag::eHostCoherent;
+        const auto rejected = flag::eProtected | flag::eLazilyAllocated;
+
+        MemoryPropertyFlags required, preferred, avoided;
+
+        switch(a_location)
+        {
+            case memory_location::device:
+                required = flag::eDeviceLocal;
+                avoided = flag::eHostVisible;
+                break;
+            case memory_location::host:
+                required = flag::eHostVisible;
+                preferred = coherent;
+                avoided = flag::eDeviceLocal | flag::eHostCached;
+                break;
+            case memory_location::unified:
+                required = flag::eDeviceLocal;
+                preferred = mapped;
+                break;
+            case memory_location::external:
+                preferred = flag::eDeviceLocal;
+                break;
+        }
+
+        auto main_heap = largest_device_heap(a_props);
+
+        optional<uint32_t> best;
+        int32_t best_score = 0;
+        DeviceSize best_heap = 0;
+
+        for(uint32_t i = 0; i < a_props.memoryTypeCount; ++i)
+        {
+            if(!(a_type_bits & (1u << i)))
+                continue;
+
+            auto flags = a_props.memoryTypes[i].propertyFlags;
+            auto heap = a_props.memoryHeaps[a_props.memoryTypes[i].heapIndex].size;
+
+            if((flags & required) != required || !!(flags & rejected))
+                continue;
+
+            auto wanted = preferred;
+
+            // Mapping a small window into video memory isn't worth the heap pressure, upload through staging
+
+            if(a_location == memory_location::unified && heap < main_heap)
+                wanted = MemoryPropertyFlags{};
+
+            // Preferred flags only count as a whole. Non-coherent mappings still work, they are flushed after
+            // every write, so they only lose against coherent ones.
+
+            int32_t score = (!!wanted && (flags & wanted) == wanted ? 2 : 0) -
+                static_cast<int32_t>(count_bits(static_cast<uint32_t>(flags & avoided)));
+
+            if(!best || score > best_score || (score == best_score && heap > best_heap))
+            {
+                best = i;
+                best_score = score;
+                best_heap = heap;
+            }
+        }
+
+        return best;
+    }
+
+    bool is_unified_memory(const PhysicalDeviceMemoryProperties &a_props)
+    {
+        auto type = find_memory_type(a_props, ~0u, memory_location::unified);
+
+        if(!type)
+            return false;
+
+        auto flags = a_props.memoryTypes[*type].propertyFlags;
+        auto mapped = MemoryPropertyFlagBits::eHostVisible | MemoryPropertyFlagBits::eHostCoherent;
+
+        return (flags & mapped) == mapped;
+    }
+
+    struct memory_block
+    {
+        DeviceMemory memory = nullptr;
+        uint8_t* mapped = nullptr;
+        uint32_t type = 0;
+        bool optimal = false;
+        memory_lifetime lifetime = memory_lifetime::persistent;
+        unique_ptr<buddy_allocator> buddy;
+        unique_ptr<linear_allocator> linear;
+
+        bool allocate(uint64_t a_size, uint64_t a_alignment, block_range& a_range)
+        {
+            return buddy ? buddy->allocate(a_size, a_alignment, a_range) :
+                linear->allocate(a_size, a_alignment, a_range);
+        }
+
+        void free(const block_range& a_range)
+        {
+            buddy ? buddy->free(a_range) : linear->free(a_range);
+        }
+
+        bool empty() const { return buddy ? buddy->empty() : linear->empty(); }
+        uint64_t capacity() const { return buddy ? buddy->get_capacity() : linear->get_capacity(); }
+        uint64_t used() const { return buddy ? buddy->get_used() : linear->get_used(); }
+        uint64_t largest_free() const { return buddy ? buddy->get_largest_free() : linear->get_largest_free(); }
+
+        bool matches(uint32_t a_type, bool a_optimal, memory_lifetime a_lifetime) const
+        {
+            return type == a_type && optimal == a_optimal && lifetime == a_lifetime;
+        }
+    };
+
+    memory_allocator::memory_allocator(const PhysicalDevice &a_gpu, const UniqueDevice &a_device,
+        DeviceSize a_block_size) : m_gpu{a_gpu}, m_device{a_device.get()}, m_block_size{a_block_size}
+    {
+        m_mem_props = a_gpu.getMemoryProperties();
+        auto limits = a_gpu.getProperties().limits;
+
+        m_granularity = limits.bufferImageGranularity;
+        m_atom_size = std::max<DeviceSize>(limits.nonCoherentAtomSize, 1);
+        m_unified = is_unified_memory(m_mem_props);
+    }
+
+    memory_allocator::~memory_allocator()
+    {
+        if constexpr(__ncv_logging_enabled)
+        {
+            if(m_sub_allocations || m_dedicated_count)
+                _log_android(log_level::warning) << "Memory allocator destroyed with " << m_sub_allocations
+                    << " sub-allocations and " << m_dedicated_count << " dedicated allocations alive.";
+        }
+
+        for(auto& block : m_blocks)
+        {
+            if(block->mapped)
+                m_device.unmapMemory(block->memory);
+            m_device.freeMemory(block->memory);
+        }
+    }
+
+    uint32_t memory_allocator::get_memory_index(uint32_t a_memory_type_bits, memory_location a_location) const
+    {
+        auto index = find_memory_type(m_mem_props, a_memory_type_bits, a_location);
+
+        if(!index)
+            throw runtime_error{"No suitable memory type found."};
+
+        return *index;
+    }
+
+    allocation memory_allocator::allocate(const Buffer &a_buffer, memory_location a_location,
+        memory_lifetime a_lifetime)
+    {
+        BufferMemoryRequirementsInfo2 reqs_info;
+
+        reqs_info.buffer = a_buffer;
+
+        MemoryDedicatedRequirements ded_reqs;
+        MemoryRequirements2 reqs;
+
+        reqs.pNext = &ded_reqs;
+
+        m_device.getBufferMemoryRequirements2(&reqs_info, &reqs);
+
+        MemoryDedicatedAllocateInfo ded_info;
+
+        ded_info.buffer = a_buffer;
+
+        auto result = allocate(reqs.memoryRequirements,
+            ded_reqs.prefersDedicatedAllocation || ded_reqs.requiresDedicatedAllocation, false, a_location,
+            a_lifetime, ded_info);
+
+        try
+        {
+            m_device.bindBufferMemory(a_buffer, result.memory, result.offset);
+        }
+        catch(...)
+        {
+            free(result);
+            throw;
+        }
+
+        return result;
+    }
+
+    allocation memory_allocator::allocate(const Image &a_image, memory_location a_location,
+        memory_lifetime a_lifetime)
+    {
+        ImageMemoryRequirementsInfo2 reqs_info;
+
+        reqs_info.image = a_image;
+
+        MemoryDedicatedRequirements ded_reqs;
+        MemoryRequirements2 reqs;
+
+        reqs.pNext = &ded_reqs;
+
+        m_device.getImageMemoryRequirements2(&reqs_info, &reqs);
+
+        MemoryDedicatedAllocateInfo ded_info;
+
+        ded_info.image = a_image;
+
+        // Every image created here is optimally tiled
+
+        auto result = allocate(reqs.memoryRequirements,
+            ded_reqs.prefersDedicatedAllocation || ded_reqs.requiresDedicatedAllocation, true, a_location,
+            a_lifetime, ded_info);
+
+        try
+        {
+            m_device.bindImageMemory(a_image, result.memory, result.offset);
+        }
+        catch(...)
+        {
+            free(result);
+            throw;
+        }
+
+        return result;
+    }
+
+    allocation memory_allocator::import(const MemoryAllocateInfo &a_info)
+    {
+        lock_guard<mutex> lock{m_mutex};
+
+        allocation result;
+
+        result.memory = m_device.allocateMemory(a_info);
+        result.size = a_info.allocationSize;
+
+        m_dedicated_count++;
+        m_dedicated_bytes += result.size;
+
+        return result;
+    }
+
+    allocation memory_allocator::allocate(const MemoryRequirements &a_reqs, bool a_dedicated, bool a_optimal_image,
+        memory_location a_location, memory_lifetime a_lifetime, const MemoryDedicatedAllocateInfo &a_dedicated_info)
+    {
+        auto type = get_memory_index(a_reqs.memoryTypeBits, a_location);
+        auto coherent = is_coherent(type);
+
+        // Non-coherent ranges are padded out to whole atoms, so flushing one never touches a neighbour
+
+        auto size = coherent ? a_reqs.size : (a_reqs.size + m_atom_size - 1) / m_atom_size * m_atom_size;
+
+        lock_guard<mutex> lock{m_mutex};
+
+        // Anything over half a block would waste most of it
+
+        if(a_dedicated || size > m_block_size / 2)
+            return allocate_dedicated(size, type, a_dedicated ? &a_dedicated_info : nullptr);
+
+        auto optimal = a_optimal_image && m_granularity > 1;
+        auto alignment = std::max<DeviceSize>(a_reqs.alignment ? a_reqs.alignment : 1, coherent ? 1 : m_atom_size);
+
+        block_range range;
+        memory_block* target = nullptr;
+
+        for(auto& block : m_blocks)
+        {
+            if(block->matches(type, optimal, a_lifetime) && block->allocate(size, alignment, range))
+            {
+                target = block.get();
+                break;
+            }
+        }
+
+        if(!target)
+        {
+            auto block = make_unique<memory_block>();
+
+            block->type = type;
+            block->optimal = optimal;
+            block->lifetime = a_lifetime;
+
+            if(a_lifetime == memory_lifetime::persistent)
+                block->buddy = make_unique<buddy_allocator>(m_block_size);
+            else
+                block->linear = make_unique<linear_allocator>(m_block_size);
+
+            MemoryAllocateInfo mem_info;
+
+            mem_info.allocationSize = block->capacity();
+            mem_info.memoryTypeIndex = type;
+
+            block->memory = m_device.allocateMemory(mem_info);
+
+            try
+            {
+                block->mapped = map(block->memory, type);
+            }
+            catch(...)
+            {
+                m_device.freeMemory(block->memory);
+                throw;
+            }
+
+            if(!block->allocate(size, alignment, range))
+            {
+                if(block->mapped)
+                    m_device.unmapMemory(block->memory);
+                m_device.freeMemory(block->memory);
+                throw runtime_error{"Allocation doesn't fit an empty memory block."};
+            }
+
+            if constexpr(__ncv_logging_enabled)
+                _log_android(log_level::debug) << "Memory block of " << block->capacity() << " bytes created (type "
+                    << type << (a_lifetime == memory_lifetime::persistent ? ", buddy" : ", linear")
+                    << (optimal ? ", optimal images)." : ").");
+
+            target = block.get();
+            m_blocks.push_back(move(block));
+        }
+
+        m_sub_allocations++;
+
+        allocation result;
+
+        result.memory = target->memory;
+        result.offset = range.offset;
+        result.size = size;
+        result.mapped = target->mapped ? target->mapped + range.offset : nullptr;
+        result.coherent = coherent;
+        result.block = target;
+        result.range = range;
+
+        return result;
+    }
+
+    allocation memory_allocator::allocate_dedicated(DeviceSize a_size, uint32_t a_type, const void *a_next)
+    {
+        MemoryAllocateInfo mem_info;
+
+        mem_info.pNext = a_next;
+        mem_info.allocationSize = a_size;
+        mem_info.memoryTypeIndex = a_type;
+
+        allocation result;
+
+        result.memory = m_device.allocateMemory(mem_info);
+        result.size = a_size;
+        result.coherent = is_coherent(a_type);
+
+        try
+        {
+            result.mapped = map(result.memory, a_type);
+        }
+        catch(...)
+        {
+            m_device.freeMemory(result.memory);
+            throw;
+        }
+
+        m_dedicated_count++;
+        m_dedicated_bytes += a_size;
+
+        return result;
+    }
+
+    uint8_t* memory_allocator::map(DeviceMemory a_memory, uint32_t a_type)
+    {
+        if(!(m_mem_props.memoryTypes[a_type].propertyFlags & MemoryPropertyFlagBits::eHostVisible))
+            return nullptr;
+
+        uint8_t* mapped = nullptr;
+        MemoryMapFlags map_flags {0};
+
+        auto result = m_device.mapMemory(a_memory, 0, VK_WHOLE_SIZE, map_flags, reinterpret_cast<void**>(&mapped));
+
+        if(result != Result::eSuccess)
+            throw runtime_error{"Result is: " + to_string(result) + ". Could not map host memory."};
+
+        return mapped;
+    }
+
+    bool memory_allocator::is_coherent(uint32_t a_type) const
+    {
+        return !!(m_mem_props.memoryTypes[a_type].propertyFlags & MemoryPropertyFlagBits::eHostCoherent);
+    }
+
+    void memory_allocator::flush(const allocation &a_allocation, DeviceSize a_offset, DeviceSize a_size) const
+    {
+        if(a_allocation.coherent || !a_allocation.mapped || !a_size)
+            return;
+
+        // The allocation starts on an atom and spans whole atoms, so the rounded range stays inside it
+
+        auto begin = a_offset / m_atom_size * m_atom_size;
+        auto end = std::min((a_offset + a_size + m_atom_size - 1) / m_atom_size * m_atom_size, a_allocation.size);
+
+        MappedMemoryRange range;
+
+        range.memory = a_allocation.memory;
+        range.offset = a_allocation.offset + begin;
+        range.size = end - begin;
+
+        auto result = m_device.flushMappedMemoryRanges(1, &range);
+
+        if(result != Result::eSuccess)
+            throw runtime_error{"Result is: " + to_string(result) + ". Could not flush host memory."};
+    }
+
+    void memory_allocator::free(allocation &a_allocation) noexcept
+    {
+        if(!a_allocation)
+            return;
+
+        lock_guard<mutex> lock{m_mutex};
+
+        if(!a_allocation.block)
+        {
+            if(a_allocation.mapped)
+                m_device.unmapMemory(a_allocation.memory);
+            m_device.freeMemory(a_allocation.memory);
+
+            m_dedicated_count--;
+            m_dedicated_bytes -= a_allocation.size;
+        }
+        else
+        {
+            auto block = a_allocation.block;
+
+            block->free(a_allocation.range);
+            m_sub_allocations--;
+
+            // One empty block per pool is kept around, further ones go back to the driver
+
+            if(block->empty())
+            {
+                for(auto it = m_blocks.begin(); it != m_blocks.end(); ++it)
+                {
+                    auto& other = *it;
+
+                    if(other.get() != block && other->empty() &&
+                       other->matches(block->type, block->optimal, block->lifetime))
+                    {
+                        if(other->mapped)
+                            m_device.unmapMemory(other->memory);
+                        m_device.freeMemory(other->memory);
+                        m_blocks.erase(it);
+                        break;
+                    }
+                }
+            }
+        }
+
+        a_allocation = allocation{};
+    }
+
+    memory_allocator::statistics memory_allocator::get_statistics() const
+    {
+        lock_guard<mutex> lock{m_mutex};
+
+        statistics stats;
+        DeviceSize total_free = 0;
+
+        for(auto& block : m_blocks)
+        {
+            stats.reserved_bytes += block->capacity();
+            stats.used_bytes += block->used();
+            stats.largest_free = std::max<DeviceSize>(stats.largest_free, block->largest_free());
+            total_free += block->capacity() - block->used();
+        }
+
+        stats.blocks = static_cast<uint32_t>(m_blocks.size());
+        stats.dedicated_allocations = m_dedicated_count;
+        stats.device_allocations = stats.blocks + m_dedicated_count;
+        stats.sub_allocations = m_sub_allocations;
+        stats.reserved_bytes += m_dedicated_bytes;
+        stats.used_bytes += m_dedicated_bytes;
+        stats.fragmentation = total_free ? 1.f - static_cast<float>(stats.largest_free) / total_free : 0.f;
+
+        return stats;
+    }
+}}
@@ -0,0 +1,167 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_RESOURCES_MEMORY_ALLOCATOR_HPP
+#define NCV_RESOURCES_MEMORY_ALLOCATOR_HPP
+
+#include <graphics/resources/block_allocator.hpp>
+#include <vulkan_hpp/vulkan.hpp>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+namespace graphics{ namespace resources{
+
+    // unified: device local memory the host can write to directly, when the device has it in its main heap
+    // (UMA). Falls back to plain device memory, allocations that got a host visible type come back mapped.
+
+    enum class memory_location
+    {
+        device,
+        host,
+        unified,
+        external
+    };
+
+    // persistent: buddy sub-allocation, freed individually in any order.
+    // transient: linear sub-allocation for short lived data (staging), a block rewinds once all of its
+    // allocations are gone.
+
+    enum class memory_lifetime
+    {
+        persistent,
+        transient
+    };
+
+    struct memory_block;
+
+    struct allocation
+    {
+        vk::DeviceMemory memory = nullptr;
+        vk::DeviceSize offset = 0;
+        vk::DeviceSize size = 0;
+
+        // Host visible memory is mapped once per block, this already points at offset. Writes through a
+        // mapping that isn't coherent only reach the device once flushed.
+
+        uint8_t* mapped = nullptr;
+        bool coherent = true;
+
+        memory_block* block = nullptr;
+        block_range range;
+
+        explicit operator bool() const { return !!memory; }
+    };
+
+    // Scores every type allowed by a_type_bits for the location and returns the best one. Protected and lazily
+    // allocated types are never picked. Device memory avoids host visible types so they stay available for
+    // those who map them, host memory must be host visible, prefers coherent types and avoids device local and
+    // cached ones. Ties go to the larger heap, then to the lower index.
+
+    std::optional<uint32_t> find_memory_type(const vk::PhysicalDeviceMemoryProperties& a_props,
+        uint32_t a_type_bits, memory_location a_location);
+
+    // True when a device local type is host visible and coherent and sits in the largest device local heap.
+    // Small host visible windows into dedicated video memory don't count.
+
+    bool is_unified_memory(const vk::PhysicalDeviceMemoryProperties& a_props);
+
+    // Device memory is taken from the driver in large blocks per memory type and handed out in pieces, so the
+    // vkAllocateMemory count stays far below maxMemoryAllocationCount. Resources only get memory of their own
+    // when the driver asks for a dedicated allocation, when they don't fit a block, or when memory is imported.
+    // When bufferImageGranularity is above 1, buffers and optimally tiled images use separate blocks so
+    // neighbours never share a granularity page.
+
+    class memory_allocator
+    {
+    public:
+
+        struct statistics
+        {
+            uint32_t device_allocations = 0;
+            uint32_t dedicated_allocations = 0;
+            uint32_t blocks = 0;
+            uint64_t sub_allocations = 0;
+            vk::DeviceSize reserved_bytes = 0;
+            vk::DeviceSize used_bytes = 0;
+            vk::DeviceSize largest_free = 0;
+
+            // 1 - largest free range / total free, 0 when all free space is contiguous
+
+            float fragmentation = 0.f;
+        };
+
+        memory_allocator(const vk::PhysicalDevice& a_gpu, const vk::UniqueDevice& a_device,
+            vk::DeviceSize a_block_size = 16 * 1024 * 1024);
+        ~memory_allocator();
+
+        memory_allocator(const memory_allocator&) = delete;
+        memory_allocator& operator=(const memory_allocator&) = delete;
+
+        // Allocate and bind
+
+        allocation allocate(const vk::Buffer& a_buffer, memory_location a_location,
+            memory_lifetime a_lifetime = memory_lifetime::persistent);
+        allocation allocate(const vk::Image& a_image, memory_location a_location,
+            memory_lifetime a_lifetime = memory_lifetime::persistent);
+
+        // Imported memory (e.g. hardware buffers) is always dedicated, a_info carries the import chain
+
+        allocation import(const vk::MemoryAllocateInfo& a_info);
+
+        void free(allocation& a_allocation) noexcept;
+
+        // Makes host writes to a range of the allocation visible to the device, a no-op for coherent memory.
+        // Nothing reads device writes back on the host, so there is no invalidate counterpart.
+
+        void flush(const allocation& a_allocation, vk::DeviceSize a_offset, vk::DeviceSize a_size) const;
+
+        uint32_t get_memory_index(uint32_t a_memory_type_bits, memory_location a_location) const;
+        const vk::PhysicalDeviceMemoryProperties& get_memory_properties() const { return m_mem_props; }
+        bool is_unified() const { return m_unified; }
+        vk::Device get_device() const { return m_device; }
+        vk::PhysicalDevice get_physical_device() const { return m_gpu; }
+        statistics get_statistics() const;
+
+    private:
+
+        allocation allocate(const vk::MemoryRequirements& a_reqs, bool a_dedicated, bool a_optimal_image,
+            memory_location a_location, memory_lifetime a_lifetime,
+            const vk::MemoryDedicatedAllocateInfo& a_dedicated_info);
+        allocation allocate_dedicated(vk::DeviceSize a_size, uint32_t a_type, const void* a_next);
+        uint8_t* map(vk::DeviceMemory a_memory, uint32_t a_type);
+        bool is_coherent(uint32_t a_type) const;
+
+        vk::PhysicalDevice m_gpu = nullptr;
+        vk::Device m_device = nullptr;
+        vk::PhysicalDeviceMemoryProperties m_mem_props;
+        vk::DeviceSize m_granularity = 1;
+        vk::DeviceSize m_atom_size = 1;
+        vk::DeviceSize m_block_size = 0;
+        bool m_unified = false;
+
+        mutable std::mutex m_mutex;
+        std::list<std::unique_ptr<memory_block>> m_blocks;
+        uint32_t m_dedicated_count = 0;
+        vk::DeviceSize m_dedicated_bytes = 0;
+        uint64_t m_sub_allocations = 0;
+    };
+}}
+
+#endif //NCV_RESOURCES_MEMORY_ALLOCATOR_HPP
@@ -25,6 +25,10 @@ namespace graphics{ namespace resources
     struct device;
     struct external;
 
+    class memory_allocator;
+    class deletion_queue;
+    class upload_manager;
+
     template<typename T, typename S = void>
     class buffer;
 
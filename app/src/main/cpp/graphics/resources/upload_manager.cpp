@@ -0,0 +1,896 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <graphics/resources/upload_manager.hpp>
+#include <utilities/log.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#include <unistd.h>
+
+using namespace ::std;
+using namespace ::vk;
+using namespace ::utilities;
+
+namespace
+{
+    // Satisfies texel block alignment of every uncompressed format and the 4 byte rule of buffer image copies
+
+    constexpr DeviceSize ring_alignment = 16;
+
+    // Ranges of mip levels or array layers, given as first and count
+
+    bool overlaps(uint32_t a_first, uint32_t a_count, uint32_t a_other_first, uint32_t a_other_count)
+    {
+        return a_first < a_other_first + a_other_count && a_other_first < a_first + a_count;
+    }
+
+    bool contains(uint32_t a_first, uint32_t a_count, uint32_t a_other_first, uint32_t a_other_count)
+    {
+        return a_first <= a_other_first && a_other_first + a_other_count <= a_first + a_count;
+    }
+}
+
+namespace graphics{ namespace resources{
+
+    upload_manager::upload_manager(memory_allocator &a_allocator, Queue a_queue, uint32_t a_queue_family,
+        DeviceSize a_ring_size) : m_allocator{a_allocator}, m_device{a_allocator.get_device()}, m_queue{a_queue},
+        m_ring_size{a_ring_size}
+    {
+        CommandPoolCreateInfo pool_info;
+
+        pool_info.flags = CommandPoolCreateFlagBits::eResetCommandBuffer | CommandPoolCreateFlagBits::eTransient;
+        pool_info.queueFamilyIndex = a_queue_family;
+
+        m_cmd_pool = m_device.createCommandPool(pool_info);
+
+        try
+        {
+            create_ring();
+        }
+        catch(...)
+        {
+            destroy_resources();
+            throw;
+        }
+
+        open_batch(1);
+    }
+
+    upload_manager::~upload_manager()
+    {
+        {
+            unique_lock<mutex> lock{m_mutex};
+
+            while(!m_in_flight.empty())
+                wait_oldest(lock);
+        }
+
+        destroy_resources();
+    }
+
+    void upload_manager::destroy_resources() noexcept
+    {
+        release_imports(m_open);
+
+        for(auto& recycled : m_recycled)
+            m_device.destroyFence(recycled.second);
+        m_recycled.clear();
+
+        for(auto& retired : m_retired)
+            m_device.destroyFence(retired.second);
+        m_retired.clear();
+
+        if(!!m_cmd_pool)
+            m_device.destroyCommandPool(m_cmd_pool);
+        m_cmd_pool = nullptr;
+
+        release_ring();
+    }
+
+    void upload_manager::create_ring()
+    {
+        BufferCreateInfo ring_info;
+
+        ring_info.usage = BufferUsageFlagBits::eTransferSrc;
+        ring_info.size = m_ring_size;
+        ring_info.sharingMode = SharingMode::eExclusive;
+
+        m_ring = m_device.createBuffer(ring_info);
+
+        try
+        {
+            m_ring_memory = m_allocator.allocate(m_ring, memory_location::host);
+        }
+        catch(...)
+        {
+            release_ring();
+            throw;
+        }
+
+        m_head = m_tail = m_used = 0;
+    }
+
+    void upload_manager::release_ring() noexcept
+    {
+        if(!!m_ring)
+            m_device.destroyBuffer(m_ring);
+        m_allocator.free(m_ring_memory);
+        m_ring = nullptr;
+    }
+
+    void upload_manager::open_batch(ticket a_id)
+    {
+        m_open = batch{};
+        m_open.id = a_id;
+        m_open.future = m_open.done.get_future().share();
+    }
+
+    DeviceSize upload_manager::reserve(DeviceSize a_size, unique_lock<mutex> &a_lock)
+    {
+        if(a_size > m_ring_size)
+            throw runtime_error{"Upload of " + to_string(a_size) + " bytes doesn't fit the staging ring."};
+
+        for(;;)
+        {
+            // Checked on every round, the ring may be trimmed while waiting
+
+            if(!m_ring)
+                create_ring();
+
+            if(m_used == 0)
+                m_head = m_tail = 0;
+
+            auto offset = (m_head + ring_alignment - 1) & ~(ring_alignment - 1);
+            auto taken = DeviceSize{0};
+
+            if(m_used == 0 || m_head > m_tail)
+            {
+                // Free space is [head, end) and [0, tail), wrapping wastes the end of the ring
+
+                if(offset + a_size <= m_ring_size)
+                    taken = offset + a_size - m_head;
+                else if(a_size <= m_tail)
+                {
+                    offset = 0;
+                    taken = m_ring_size - m_head + a_size;
+                }
+            }
+            else if(m_head < m_tail && offset + a_size <= m_tail)
+                taken = offset + a_size - m_head;
+
+            if(taken)
+            {
+                m_head = offset + a_size;
+                m_used += taken;
+                m_open.bytes += taken;
+                return offset;
+            }
+
+            // Full. Space held by pending uploads only comes back once they are submitted and complete.
+
+            m_stats.ring_stalls++;
+
+            if(m_in_flight.empty())
+                submit();
+
+            wait_oldest(a_lock);
+        }
+    }
+
+    upload_manager::ticket upload_manager::enqueue(const buffer_region &a_region, const void *a_data,
+        DeviceSize a_size)
+    {
+        return enqueue(a_region, a_data, a_size, nullptr);
+    }
+
+    upload_manager::ticket upload_manager::enqueue(const image_region &a_region, const void *a_data,
+        DeviceSize a_size)
+    {
+        return enqueue(a_region, a_data, a_size, nullptr);
+    }
+
+    upload_manager::ticket upload_manager::enqueue(const buffer_region &a_region, const void *a_data,
+        DeviceSize a_size, shared_ptr<const void> a_owner)
+    {
+        unique_lock<mutex> lock{m_mutex};
+
+        // Buffer copies have no offset rule, 4 keeps imported sources on the same footing as the ring
+
+        auto source = import_source(a_data, a_size, 4, a_owner);
+
+        if(!source)
+        {
+            source.emplace(nullptr, reserve(a_size, lock));
+            memcpy(m_ring_memory.mapped + source->second, a_data, a_size);
+            m_allocator.flush(m_ring_memory, source->second, a_size);
+        }
+
+        m_buffer_copies.push_back({a_region, source->first, BufferCopy{source->second, a_region.offset, a_size}});
+        m_stats.uploads++;
+        m_stats.bytes += a_size;
+
+        return m_open.id;
+    }
+
+    upload_manager::ticket upload_manager::enqueue(const image_region &a_region, const void *a_data,
+        DeviceSize a_size, shared_ptr<const void> a_owner)
+    {
+        unique_lock<mutex> lock{m_mutex};
+
+        // Each subresource may only leave undefined once per batch, the pre-barriers all go into one command
+
+        auto& target = a_region.subresource;
+        auto levels = std::max(a_region.mip_levels, 1u);
+
+        auto overlapped = [&](const image_copy& a_upload)
+        {
+            auto& pending = a_upload.region.subresource;
+
+            return a_upload.region.image == a_region.image && !!(pending.aspectMask & target.aspectMask) &&
+                overlaps(target.mipLevel, levels, pending.mipLevel, std::max(a_upload.region.mip_levels, 1u)) &&
+                overlaps(target.baseArrayLayer, target.layerCount, pending.baseArrayLayer, pending.layerCount);
+        };
+
+        auto covered = [&](const image_copy& a_upload)
+        {
+            auto& pending = a_upload.region.subresource;
+
+            return (pending.aspectMask & target.aspectMask) == pending.aspectMask &&
+                contains(target.mipLevel, levels, pending.mipLevel, std::max(a_upload.region.mip_levels, 1u)) &&
+                contains(target.baseArrayLayer, target.layerCount, pending.baseArrayLayer, pending.layerCount);
+        };
+
+        // Whole layers are uploaded, so a pending upload covered by this one would only be overwritten (its ring
+        // space stays with the batch). Partial overlaps are left to the next batch.
+
+        if(any_of(m_image_copies.begin(), m_image_copies.end(),
+            [&](const image_copy& a_upload) { return overlapped(a_upload) && !covered(a_upload); }))
+            submit();
+        else
+            m_image_copies.erase(remove_if(m_image_copies.begin(), m_image_copies.end(), overlapped),
+                m_image_copies.end());
+
+        auto source = import_source(a_data, a_size, lcm(a_region.block_size, DeviceSize{4}), a_owner);
+
+        if(!source)
+        {
+            source.emplace(nullptr, reserve(a_size, lock));
+            memcpy(m_ring_memory.mapped + source->second, a_data, a_size);
+            m_allocator.flush(m_ring_memory, source->second, a_size);
+        }
+
+        BufferImageCopy copy;
+
+        copy.bufferOffset = source->second;
+        copy.bufferRowLength = 0;
+        copy.bufferImageHeight = 0;
+        copy.imageSubresource = a_region.subresource;
+        copy.imageOffset = Offset3D{0, 0, 0};
+        copy.imageExtent = a_region.extent;
+
+        m_image_copies.push_back({a_region, source->first, copy});
+        m_stats.uploads++;
+        m_stats.bytes += a_size;
+
+        return m_open.id;
+    }
+
+    optional<pair<Buffer, DeviceSize>> upload_manager::import_source(const void *a_data, DeviceSize a_size,
+        DeviceSize a_alignment, shared_ptr<const void> &a_owner)
+    {
+        if(!m_host_import || !a_owner || !a_size)
+            return nullopt;
+
+        auto address = reinterpret_cast<uintptr_t>(a_data);
+
+        // Uploads out of one allocation (levels of a KTX2 file) share an import that covers them
+
+        for(auto& imported : m_open.imports)
+            if(address >= imported.base && address + a_size <= imported.base + imported.size)
+            {
+                if((address - imported.base) % a_alignment)
+                    return nullopt;
+
+                m_stats.imported_bytes += a_size;
+                return make_pair(imported.buffer, static_cast<DeviceSize>(address - imported.base));
+            }
+
+        // Rounding out to the alignment stays inside the pages of the allocation as long as the alignment doesn't
+        // exceed a page, larger alignments have to be met by the allocation itself
+
+        static const auto page_size = static_cast<DeviceSize>(sysconf(_SC_PAGESIZE));
+
+        auto base = address & ~static_cast<uintptr_t>(m_import_alignment - 1);
+        auto end = (address + a_size + m_import_alignment - 1) & ~static_cast<uintptr_t>(m_import_alignment - 1);
+
+        if(m_import_alignment > page_size && (base != address || end != address + a_size))
+            return nullopt;
+
+        // The copy reads from address - base, which has to satisfy the copy's offset rules. Levels inside a file
+        // that was read as a whole can miss the 8 or 16 byte blocks of compressed formats.
+
+        if((address - base) % a_alignment)
+            return nullopt;
+
+        // A range reaching into pages imported already (neighbouring KTX2 levels) is imported on its own, pages may
+        // be imported more than once. Drivers refusing that send it through the ring below.
+
+        host_import imported;
+
+        imported.base = base;
+        imported.size = end - base;
+
+        try
+        {
+            auto handle_type = ExternalMemoryHandleTypeFlagBits::eHostAllocationEXT;
+            auto host_pointer = reinterpret_cast<void*>(base);
+            auto pointer_props = m_device.getMemoryHostPointerPropertiesEXT(handle_type, host_pointer);
+
+            ExternalMemoryBufferCreateInfo external_info;
+
+            external_info.handleTypes = handle_type;
+
+            BufferCreateInfo buffer_info;
+
+            buffer_info.pNext = &external_info;
+            buffer_info.usage = BufferUsageFlagBits::eTransferSrc;
+            buffer_info.size = imported.size;
+            buffer_info.sharingMode = SharingMode::eExclusive;
+
+            imported.buffer = m_device.createBuffer(buffer_info);
+
+            auto type_bits = m_device.getBufferMemoryRequirements(imported.buffer).memoryTypeBits &
+                pointer_props.memoryTypeBits;
+
+            if(!type_bits)
+                throw runtime_error{"No memory type can import the host allocation."};
+
+            // Imported pages are never mapped, so nothing could flush them, only a coherent type sees the data
+
+            auto& mem_props = m_allocator.get_memory_properties();
+            auto type = find_memory_type(mem_props, type_bits, memory_location::host);
+
+            if(!type || !(mem_props.memoryTypes[*type].propertyFlags & MemoryPropertyFlagBits::eHostCoherent))
+                throw runtime_error{"No coherent memory type can import the host allocation."};
+
+            ImportMemoryHostPointerInfoEXT import_info;
+
+            import_info.handleType = handle_type;
+            import_info.pHostPointer = host_pointer;
+
+            MemoryAllocateInfo memory_info;
+
+            memory_info.pNext = &import_info;
+            memory_info.allocationSize = imported.size;
+            memory_info.memoryTypeIndex = *type;
+
+            imported.memory = m_allocator.import(memory_info);
+            m_device.bindBufferMemory(imported.buffer, imported.memory.memory, 0);
+        }
+        catch(exception const &e)
+        {
+            if constexpr(__ncv_logging_enabled)
+                _log_android(log_level::warning) << "Host memory import failed, using the ring: " << e.what();
+
+            if(!!imported.buffer)
+                m_device.destroyBuffer(imported.buffer);
+            m_allocator.free(imported.memory);
+
+            return nullopt;
+        }
+
+        imported.owner = move(a_owner);
+        m_open.imports.push_back(move(imported));
+        m_stats.imports++;
+        m_stats.imported_bytes += a_size;
+
+        auto& result = m_open.imports.back();
+
+        return make_pair(result.buffer, static_cast<DeviceSize>(address - result.base));
+    }
+
+    void upload_manager::release_imports(batch &a_batch) noexcept
+    {
+        for(auto& imported : a_batch.imports)
+        {
+            m_device.destroyBuffer(imported.buffer);
+            m_allocator.free(imported.memory);
+        }
+
+        a_batch.imports.clear();
+    }
+
+    upload_manager::ticket upload_manager::flush()
+    {
+        lock_guard<mutex> lock{m_mutex};
+
+        return submit();
+    }
+
+    upload_manager::ticket upload_manager::submit()
+    {
+        if(m_buffer_copies.empty() && m_image_copies.empty())
+            return m_open.id - 1;
+
+        CommandBuffer cmd;
+        Fence fence;
+
+        if(!m_recycled.empty())
+        {
+            tie(cmd, fence) = m_recycled.back();
+            m_recycled.pop_back();
+        }
+        else
+        {
+            CommandBufferAllocateInfo cmd_info;
+
+            cmd_info.commandPool = m_cmd_pool;
+            cmd_info.level = CommandBufferLevel::ePrimary;
+            cmd_info.commandBufferCount = 1;
+
+            cmd = m_device.allocateCommandBuffers(cmd_info).front();
+            fence = m_device.createFence(FenceCreateInfo{});
+        }
+
+        CommandBufferBeginInfo begin_info;
+
+        begin_info.flags = CommandBufferUsageFlagBits::eOneTimeSubmit;
+
+        cmd.begin(begin_info);
+
+        // Images: undefined -> transfer destination -> final layout. Buffers share one memory barrier per side.
+
+        vector<ImageMemoryBarrier> pre_barriers, post_barriers;
+        vector<MemoryBarrier> buffer_pre_barriers, buffer_barriers;
+        PipelineStageFlags dst_stages;
+
+        auto image_barrier = [](const image_region& a_region, uint32_t a_level, uint32_t a_count)
+        {
+            ImageMemoryBarrier barrier;
+
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = a_region.image;
+            barrier.subresourceRange.aspectMask = a_region.subresource.aspectMask;
+            barrier.subresourceRange.baseMipLevel = a_level;
+            barrier.subresourceRange.levelCount = a_count;
+            barrier.subresourceRange.baseArrayLayer = a_region.subresource.baseArrayLayer;
+            barrier.subresourceRange.layerCount = a_region.subresource.layerCount;
+
+            return barrier;
+        };
+
+        for(auto& upload : m_image_copies)
+        {
+            auto& region = upload.region;
+            auto base = region.subresource.mipLevel;
+            auto levels = std::max(region.mip_levels, 1u);
+
+            auto barrier = image_barrier(region, base, levels);
+
+            barrier.oldLayout = ImageLayout::eUndefined;
+            barrier.newLayout = ImageLayout::eTransferDstOptimal;
+            barrier.srcAccessMask = region.dst_access;
+            barrier.dstAccessMask = AccessFlagBits::eTransferWrite;
+            pre_barriers.push_back(barrier);
+
+            // Generated levels were read by the next blit, they leave from transfer source. The last level
+            // (the only one without generation) is still a transfer destination.
+
+            if(levels > 1)
+            {
+                barrier = image_barrier(region, base, levels - 1);
+                barrier.oldLayout = ImageLayout::eTransferSrcOptimal;
+                barrier.newLayout = region.final_layout;
+                barrier.srcAccessMask = AccessFlagBits::eTransferRead;
+                barrier.dstAccessMask = region.dst_access;
+                post_barriers.push_back(barrier);
+            }
+
+            barrier = image_barrier(region, base + levels - 1, 1);
+            barrier.oldLayout = ImageLayout::eTransferDstOptimal;
+            barrier.newLayout = region.final_layout;
+            barrier.srcAccessMask = AccessFlagBits::eTransferWrite;
+            barrier.dstAccessMask = region.dst_access;
+            post_barriers.push_back(barrier);
+
+            dst_stages |= region.dst_stage;
+        }
+
+        if(!m_buffer_copies.empty())
+        {
+            buffer_pre_barriers.emplace_back(AccessFlags{0}, AccessFlagBits::eTransferWrite);
+            buffer_barriers.emplace_back(AccessFlagBits::eTransferWrite);
+
+            for(auto& upload : m_buffer_copies)
+            {
+                buffer_pre_barriers.back().srcAccessMask |= upload.region.dst_access;
+                buffer_barriers.back().dstAccessMask |= upload.region.dst_access;
+                dst_stages |= upload.region.dst_stage;
+            }
+        }
+
+        // Updates overwrite what earlier submissions may still be reading, the consumers of each region are the
+        // source scope of the first barrier as well (write after read)
+
+        cmd.pipelineBarrier(dst_stages, PipelineStageFlagBits::eTransfer, DependencyFlags{0}, buffer_pre_barriers,
+            nullptr, pre_barriers);
+
+        for(auto& upload : m_buffer_copies)
+            cmd.copyBuffer(!!upload.source ? upload.source : m_ring, upload.region.buffer, upload.copy);
+
+        for(auto& upload : m_image_copies)
+            cmd.copyBufferToImage(!!upload.source ? upload.source : m_ring, upload.region.image,
+                ImageLayout::eTransferDstOptimal, upload.copy);
+
+        // Mip chains, each level is blitted from the one above it once that one is complete
+
+        for(auto& upload : m_image_copies)
+        {
+            auto& region = upload.region;
+            auto base = region.subresource.mipLevel;
+            auto width = static_cast<int32_t>(region.extent.width);
+            auto height = static_cast<int32_t>(region.extent.height);
+
+            for(uint32_t level = base + 1; level < base + region.mip_levels; ++level)
+            {
+                auto barrier = image_barrier(region, level - 1, 1);
+
+                barrier.oldLayout = ImageLayout::eTransferDstOptimal;
+                barrier.newLayout = ImageLayout::eTransferSrcOptimal;
+                barrier.srcAccessMask = AccessFlagBits::eTransferWrite;
+                barrier.dstAccessMask = AccessFlagBits::eTransferRead;
+
+                cmd.pipelineBarrier(PipelineStageFlagBits::eTransfer, PipelineStageFlagBits::eTransfer,
+                    DependencyFlags{0}, nullptr, nullptr, barrier);
+
+                ImageBlit blit;
+
+                blit.srcSubresource = region.subresource;
+                blit.srcSubresource.mipLevel = level - 1;
+                blit.srcOffsets[1] = Offset3D{width, height, 1};
+
+                width = std::max(width / 2, 1);
+                height = std::max(height / 2, 1);
+
+                blit.dstSubresource = region.subresource;
+                blit.dstSubresource.mipLevel = level;
+                blit.dstOffsets[1] = Offset3D{width, height, 1};
+
+                cmd.blitImage(region.image, ImageLayout::eTransferSrcOptimal, region.image,
+                    ImageLayout::eTransferDstOptimal, blit, Filter::eLinear);
+            }
+        }
+
+        cmd.pipelineBarrier(PipelineStageFlagBits::eTransfer, dst_stages, DependencyFlags{0}, buffer_barriers,
+            nullptr, post_barriers);
+
+        cmd.end();
+
+        SubmitInfo submit_info;
+
+        submit_info.commandBufferCount = 1;
+        submit_info.pCommandBuffers = &cmd;
+
+        try
+        {
+            m_queue.submit(submit_info, fence);
+        }
+        catch(...)
+        {
+            m_recycled.emplace_back(cmd, fence);
+            throw;
+        }
+
+        auto id = m_open.id;
+
+        m_open.cmd = cmd;
+        m_open.fence = fence;
+        m_open.ring_end = m_head;
+        m_in_flight.push_back(move(m_open));
+        m_buffer_copies.clear();
+        m_image_copies.clear();
+        m_stats.batches++;
+
+        open_batch(id + 1);
+
+        return id;
+    }
+
+    void upload_manager::wait_oldest(unique_lock<mutex> &a_lock)
+    {
+        if(m_in_flight.empty())
+            return;
+
+        // Waits with the lock released so other threads aren't held up by the device. While anyone waits, retired
+        // fences are set aside rather than reset and reused, which keeps the fence waited on valid.
+
+        auto fence = m_in_flight.front().fence;
+
+        m_waiters++;
+        a_lock.unlock();
+
+        try
+        {
+            m_device.waitForFences(fence, VK_TRUE, UINT64_MAX);
+        }
+        catch(...)
+        {
+            a_lock.lock();
+            release_waiter();
+            throw;
+        }
+
+        a_lock.lock();
+        release_waiter();
+        retire();
+    }
+
+    void upload_manager::release_waiter()
+    {
+        if(--m_waiters)
+            return;
+
+        for(auto& retired : m_retired)
+        {
+            m_device.resetFences(retired.second);
+            m_recycled.push_back(retired);
+        }
+
+        m_retired.clear();
+    }
+
+    void upload_manager::retire()
+    {
+        while(!m_in_flight.empty())
+        {
+            auto& oldest = m_in_flight.front();
+
+            if(m_device.getFenceStatus(oldest.fence) != Result::eSuccess)
+                break;
+
+            m_tail = oldest.ring_end;
+            m_used -= oldest.bytes;
+            m_completed = oldest.id;
+
+            if(m_waiters)
+                m_retired.emplace_back(oldest.cmd, oldest.fence);
+            else
+            {
+                m_device.resetFences(oldest.fence);
+                m_recycled.emplace_back(oldest.cmd, oldest.fence);
+            }
+
+            release_imports(oldest);
+
+            oldest.done.set_value();
+            m_in_flight.pop_front();
+        }
+    }
+
+    void upload_manager::collect()
+    {
+        lock_guard<mutex> lock{m_mutex};
+
+        retire();
+    }
+
+    bool upload_manager::trim()
+    {
+        lock_guard<mutex> lock{m_mutex};
+
+        retire();
+
+        if(!m_in_flight.empty() || !m_buffer_copies.empty() || !m_image_copies.empty())
+            return false;
+
+        release_ring();
+
+        return true;
+    }
+
+    bool upload_manager::enable_host_image_copy()
+    {
+#ifdef VK_EXT_host_image_copy
+        auto gpu = m_allocator.get_physical_device();
+
+        // Layouts images can be host copied into, counted first
+
+        PhysicalDeviceHostImageCopyPropertiesEXT host_props;
+        PhysicalDeviceProperties2 props;
+
+        props.pNext = &host_props;
+        gpu.getProperties2(&props);
+
+        m_host_copy_layouts.resize(host_props.copyDstLayoutCount);
+        host_props.pCopyDstLayouts = m_host_copy_layouts.data();
+        host_props.copySrcLayoutCount = 0;
+        gpu.getProperties2(&props);
+
+        m_host_copy_layouts.resize(host_props.copyDstLayoutCount);
+        m_host_copy = true;
+#endif
+        return m_host_copy;
+    }
+
+    optional<ImageUsageFlags> upload_manager::get_host_copy_usage(Format a_format, ImageUsageFlags a_usage) const
+    {
+#ifdef VK_EXT_host_image_copy
+        if(!m_host_copy || find(m_host_copy_layouts.begin(), m_host_copy_layouts.end(),
+            ImageLayout::eShaderReadOnlyOptimal) == m_host_copy_layouts.end())
+            return nullopt;
+
+        auto usage = a_usage | ImageUsageFlagBits::eHostTransferEXT;
+
+        PhysicalDeviceImageFormatInfo2 format_info;
+
+        format_info.format = a_format;
+        format_info.type = ImageType::e2D;
+        format_info.tiling = ImageTiling::eOptimal;
+        format_info.usage = usage;
+
+        try
+        {
+            auto chain = m_allocator.get_physical_device().getImageFormatProperties2<ImageFormatProperties2,
+                HostImageCopyDevicePerformanceQueryEXT>(format_info);
+
+            if(!chain.get<HostImageCopyDevicePerformanceQueryEXT>().optimalDeviceAccess)
+                return nullopt;
+        }
+        catch(SystemError const &)
+        {
+            return nullopt;
+        }
+
+        return usage;
+#else
+        static_cast<void>(a_format);
+        static_cast<void>(a_usage);
+        return nullopt;
+#endif
+    }
+
+    void upload_manager::host_transition(Image a_image, uint32_t a_mip_levels, ImageLayout a_layout)
+    {
+#ifdef VK_EXT_host_image_copy
+        HostImageLayoutTransitionInfoEXT transition;
+
+        transition.image = a_image;
+        transition.oldLayout = ImageLayout::eUndefined;
+        transition.newLayout = a_layout;
+        transition.subresourceRange = ImageSubresourceRange{ImageAspectFlagBits::eColor, 0, a_mip_levels, 0, 1};
+
+        m_device.transitionImageLayoutEXT(transition);
+#else
+        static_cast<void>(a_image);
+        static_cast<void>(a_mip_levels);
+        static_cast<void>(a_layout);
+        throw runtime_error{"Host image copy is not available in this build."};
+#endif
+    }
+
+    void upload_manager::host_copy(const image_region &a_region, const void *a_data, DeviceSize a_size)
+    {
+#ifdef VK_EXT_host_image_copy
+        MemoryToImageCopyEXT region;
+
+        region.pHostPointer = a_data;
+        region.memoryRowLength = 0;
+        region.memoryImageHeight = 0;
+        region.imageSubresource = a_region.subresource;
+        region.imageOffset = Offset3D{0, 0, 0};
+        region.imageExtent = a_region.extent;
+
+        CopyMemoryToImageInfoEXT copy_info;
+
+        copy_info.dstImage = a_region.image;
+        copy_info.dstImageLayout = a_region.final_layout;
+        copy_info.regionCount = 1;
+        copy_info.pRegions = &region;
+
+        m_device.copyMemoryToImageEXT(copy_info);
+
+        lock_guard<mutex> lock{m_mutex};
+
+        m_stats.host_copies++;
+        m_stats.host_bytes += a_size;
+#else
+        static_cast<void>(a_region);
+        static_cast<void>(a_data);
+        static_cast<void>(a_size);
+        throw runtime_error{"Host image copy is not available in this build."};
+#endif
+    }
+
+    bool upload_manager::enable_host_import()
+    {
+        PhysicalDeviceExternalMemoryHostPropertiesEXT host_props;
+        PhysicalDeviceProperties2 props;
+
+        props.pNext = &host_props;
+        m_allocator.get_physical_device().getProperties2(&props);
+
+        // Power of two by spec, zero would mean the query went unanswered
+
+        if(!host_props.minImportedHostPointerAlignment)
+            return false;
+
+        lock_guard<mutex> lock{m_mutex};
+
+        m_import_alignment = host_props.minImportedHostPointerAlignment;
+        m_host_import = true;
+
+        return true;
+    }
+
+    bool upload_manager::is_complete(ticket a_ticket)
+    {
+        lock_guard<mutex> lock{m_mutex};
+
+        retire();
+
+        return a_ticket <= m_completed;
+    }
+
+    void upload_manager::wait(ticket a_ticket)
+    {
+        unique_lock<mutex> lock{m_mutex};
+
+        if(a_ticket >= m_open.id)
+            submit();
+
+        while(m_completed < a_ticket && !m_in_flight.empty())
+            wait_oldest(lock);
+    }
+
+    shared_future<void> upload_manager::get_future(ticket a_ticket)
+    {
+        lock_guard<mutex> lock{m_mutex};
+
+        if(a_ticket == m_open.id)
+            return m_open.future;
+
+        for(auto& in_flight : m_in_flight)
+            if(in_flight.id == a_ticket)
+                return in_flight.future;
+
+        // Already retired
+
+        promise<void> done;
+
+        done.set_value();
+
+        return done.get_future().share();
+    }
+
+    DeviceSize upload_manager::get_resident_size() const
+    {
+        lock_guard<mutex> lock{m_mutex};
+
+        return m_ring_memory.size;
+    }
+
+    upload_manager::statistics upload_manager::get_statistics() const
+    {
+        lock_guard<mutex> lock{m_mutex};
+
+        return m_stats;
+    }
+}}
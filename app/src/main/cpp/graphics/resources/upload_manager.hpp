@@ -0,0 +1,247 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_RESOURCES_UPLOAD_MANAGER_HPP
+#define NCV_RESOURCES_UPLOAD_MANAGER_HPP
+
+#include <graphics/resources/memory_allocator.hpp>
+
+#include <deque>
+#include <future>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace graphics{ namespace resources{
+
+    // All host to device copies go through one persistently mapped staging ring. Enqueueing copies the data
+    // into the ring right away and records the region, flush() submits everything pending as a single
+    // transfer batch with its own fence. Batches end with barriers towards the consumers, so later
+    // submissions on the same queue may use the data without further synchronization. Ring space is reclaimed
+    // as batches complete, enqueueing blocks on the oldest batch only when the ring is full.
+    //
+    // With VK_EXT_host_image_copy enabled, images can instead be written by the CPU straight from host memory,
+    // with no staging memory and no command buffer, on whichever thread creates them.
+    //
+    // With VK_EXT_external_memory_host enabled, uploads whose source is kept alive by an owner can skip the ring:
+    // the host allocation itself is imported as device memory and copied from, the owner is held until the batch
+    // completes. Sources that aren't suitably aligned or can't be imported silently take the ring.
+
+    class upload_manager
+    {
+    public:
+
+        // Batch sequence number, every upload enqueued before a flush shares the ticket of that batch
+
+        using ticket = uint64_t;
+
+        struct buffer_region
+        {
+            vk::Buffer buffer = nullptr;
+            vk::DeviceSize offset = 0;
+            vk::PipelineStageFlags dst_stage = vk::PipelineStageFlagBits::eVertexInput;
+            vk::AccessFlags dst_access = vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead;
+        };
+
+        // Whole subresource layers are uploaded, previous contents are discarded. With mip_levels above 1 the
+        // uploaded level is the base of a chain, the levels below it are generated with linear blits (the format
+        // has to support linear filtering of blits with optimal tiling). A later upload in the same batch that
+        // covers every level and layer of a pending one replaces it, any other overlap starts a new batch.
+
+        struct image_region
+        {
+            vk::Image image = nullptr;
+            vk::ImageSubresourceLayers subresource{vk::ImageAspectFlagBits::eColor, 0, 0, 1};
+            vk::Extent3D extent;
+            uint32_t mip_levels = 1;
+
+            // Bytes per texel block, copies from host imports need their offset to be a multiple of it (and of
+            // 4). The default suits every format.
+
+            vk::DeviceSize block_size = 16;
+            vk::ImageLayout final_layout = vk::ImageLayout::eShaderReadOnlyOptimal;
+            vk::PipelineStageFlags dst_stage = vk::PipelineStageFlagBits::eFragmentShader;
+            vk::AccessFlags dst_access = vk::AccessFlagBits::eShaderRead;
+        };
+
+        struct statistics
+        {
+            uint64_t uploads = 0;
+            uint64_t batches = 0;
+            uint64_t bytes = 0;
+            uint64_t ring_stalls = 0;
+            uint64_t host_copies = 0;
+            uint64_t host_bytes = 0;
+            uint64_t imports = 0;
+            uint64_t imported_bytes = 0;
+        };
+
+        upload_manager(memory_allocator& a_allocator, vk::Queue a_queue, uint32_t a_queue_family,
+            vk::DeviceSize a_ring_size = 32 * 1024 * 1024);
+        ~upload_manager();
+
+        upload_manager(const upload_manager&) = delete;
+        upload_manager& operator=(const upload_manager&) = delete;
+
+        // A full ring submits what is pending and waits, so enqueue belongs to the queue's thread as well. Waits
+        // on the device (here and in wait()) don't hold the manager's lock, other threads carry on meanwhile.
+
+        ticket enqueue(const buffer_region& a_region, const void* a_data, vk::DeviceSize a_size);
+        ticket enqueue(const image_region& a_region, const void* a_data, vk::DeviceSize a_size);
+
+        // a_owner keeps a_data alive and unchanged until the returned ticket completes, which lets the data be
+        // imported in place instead of copied into the ring (when host import is enabled). a_data has to be an
+        // ordinary host allocation, file mappings are passed without an owner.
+
+        ticket enqueue(const buffer_region& a_region, const void* a_data, vk::DeviceSize a_size,
+            std::shared_ptr<const void> a_owner);
+        ticket enqueue(const image_region& a_region, const void* a_data, vk::DeviceSize a_size,
+            std::shared_ptr<const void> a_owner);
+
+        // Submits pending uploads, returns the ticket of the submitted batch (or of the last one when nothing
+        // was pending). Must be called from the thread that owns the queue.
+
+        ticket flush();
+
+        // Retires completed batches without blocking, meant to be called once per frame
+
+        void collect();
+
+        // Hands the staging ring back to the allocator when nothing is pending or in flight, the next enqueue
+        // maps a new one. Meant for the end of a loading phase, returns false when the ring is still in use.
+
+        bool trim();
+
+        // Turns on host image copies, the device must have been created with the hostImageCopy feature. Returns
+        // false when the headers the build used predate VK_EXT_host_image_copy.
+
+        bool enable_host_image_copy();
+        bool is_host_image_copy_enabled() const { return m_host_copy; }
+
+        // Usage an image of a_format needs for host copies next to a_usage, nullopt when it can't be host copied
+        // into shader read only layout. Formats whose device access would suffer from host transfer usage (the
+        // driver may drop compression of such images) keep going through the ring.
+
+        std::optional<vk::ImageUsageFlags> get_host_copy_usage(vk::Format a_format, vk::ImageUsageFlags a_usage) const;
+
+        // Moves all levels of a host copy capable image from undefined to a_layout, ahead of host_copy(). The image
+        // may not be in use by the device. Both are thread safe, the copy is complete when they return and seen
+        // by every later queue submission.
+
+        void host_transition(vk::Image a_image, uint32_t a_mip_levels, vk::ImageLayout a_layout);
+        void host_copy(const image_region& a_region, const void* a_data, vk::DeviceSize a_size);
+
+        // Turns on host pointer imports, the device must have been created with VK_EXT_external_memory_host.
+        // Allocations aligned to get_import_alignment() (page aligned ones on every known driver) are importable.
+
+        bool enable_host_import();
+        bool is_host_import_enabled() const { return m_host_import; }
+        vk::DeviceSize get_import_alignment() const { return m_import_alignment; }
+
+        bool is_complete(ticket a_ticket);
+        void wait(ticket a_ticket);
+        std::shared_future<void> get_future(ticket a_ticket);
+
+        vk::DeviceSize get_ring_size() const { return m_ring_size; }
+        vk::DeviceSize get_resident_size() const;
+        statistics get_statistics() const;
+
+    private:
+
+        // Host memory wrapped as a transfer source, [base, base + size) covers the imported pages
+
+        struct host_import
+        {
+            uintptr_t base = 0;
+            vk::DeviceSize size = 0;
+            vk::Buffer buffer = nullptr;
+            allocation memory;
+            std::shared_ptr<const void> owner;
+        };
+
+        struct batch
+        {
+            ticket id = 0;
+            vk::CommandBuffer cmd = nullptr;
+            vk::Fence fence = nullptr;
+            vk::DeviceSize ring_end = 0;
+            vk::DeviceSize bytes = 0;
+            std::vector<host_import> imports;
+            std::promise<void> done;
+            std::shared_future<void> future;
+        };
+
+        struct buffer_copy
+        {
+            buffer_region region;
+            vk::Buffer source = nullptr;
+            vk::BufferCopy copy;
+        };
+
+        struct image_copy
+        {
+            image_region region;
+            vk::Buffer source = nullptr;
+            vk::BufferImageCopy copy;
+        };
+
+        void create_ring();
+        void release_ring() noexcept;
+        vk::DeviceSize reserve(vk::DeviceSize a_size, std::unique_lock<std::mutex>& a_lock);
+        std::optional<std::pair<vk::Buffer, vk::DeviceSize>> import_source(const void* a_data, vk::DeviceSize a_size,
+            vk::DeviceSize a_alignment, std::shared_ptr<const void>& a_owner);
+        void release_imports(batch& a_batch) noexcept;
+        ticket submit();
+        void open_batch(ticket a_id);
+        void retire();
+        void wait_oldest(std::unique_lock<std::mutex>& a_lock);
+        void release_waiter();
+        void destroy_resources() noexcept;
+
+        memory_allocator& m_allocator;
+        vk::Device m_device = nullptr;
+        vk::Queue m_queue = nullptr;
+
+        vk::CommandPool m_cmd_pool = nullptr;
+        std::vector<std::pair<vk::CommandBuffer, vk::Fence>> m_recycled;
+        std::vector<std::pair<vk::CommandBuffer, vk::Fence>> m_retired;
+        uint32_t m_waiters = 0;
+
+        vk::Buffer m_ring = nullptr;
+        allocation m_ring_memory;
+        vk::DeviceSize m_ring_size = 0;
+        vk::DeviceSize m_head = 0;
+        vk::DeviceSize m_tail = 0;
+        vk::DeviceSize m_used = 0;
+
+        mutable std::mutex m_mutex;
+        std::deque<batch> m_in_flight;
+        batch m_open;
+        std::vector<buffer_copy> m_buffer_copies;
+        std::vector<image_copy> m_image_copies;
+        ticket m_completed = 0;
+        statistics m_stats;
+
+        bool m_host_copy = false;
+        std::vector<vk::ImageLayout> m_host_copy_layouts;
+
+        bool m_host_import = false;
+        vk::DeviceSize m_import_alignment = 0;
+    };
+}}
+
+#endif //NCV_RESOURCES_UPLOAD_MANAGER_HPP
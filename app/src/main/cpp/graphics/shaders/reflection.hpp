@@ -0,0 +1,504 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_GRAPHICS_SHADERS_REFLECTION_HPP
+#define NCV_GRAPHICS_SHADERS_REFLECTION_HPP
+
+#include <vulkan_hpp/vulkan.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Minimal SPIR-V reflection. Everything is constexpr, so the embedded modules (graphics/shaders/spirv.hpp) can be
+// reflected and checked against the C++ side at compile time, and the same code builds pipeline layouts at run
+// time. Only what the pipelines of this project use is covered: descriptor bindings, push constant block size
+// and vertex stage inputs.
+
+namespace graphics{ namespace shaders{
+
+    enum class scalar_kind : uint32_t
+    {
+        floating,
+        signed_int,
+        unsigned_int,
+        unknown
+    };
+
+    struct descriptor_binding
+    {
+        uint32_t set = 0;
+        uint32_t binding = 0;
+        vk::DescriptorType type = vk::DescriptorType::eUniformBuffer;
+        uint32_t count = 1;
+    };
+
+    struct stage_input
+    {
+        uint32_t location = 0;
+        scalar_kind kind = scalar_kind::unknown;
+        uint32_t components = 0;
+    };
+
+    template<typename T, size_t Capacity>
+    struct fixed_list
+    {
+        constexpr bool push(const T& a_item)
+        {
+            if(count == Capacity)
+                return false;
+            items[count++] = a_item;
+            return true;
+        }
+
+        constexpr const T* begin() const { return items.data(); }
+        constexpr const T* end() const { return items.data() + count; }
+        constexpr size_t size() const { return count; }
+
+        std::array<T, Capacity> items{};
+        size_t count = 0;
+    };
+
+    struct reflection
+    {
+        bool valid = false;
+        vk::ShaderStageFlagBits stage = vk::ShaderStageFlagBits::eAll;
+        fixed_list<descriptor_binding, 16> bindings;
+        fixed_list<stage_input, 16> inputs;
+        uint32_t push_constant_size = 0;
+    };
+
+    // Numeric kind and component count the shader observes when reading a vertex attribute of the given format
+
+    struct format_traits
+    {
+        scalar_kind kind = scalar_kind::unknown;
+        uint32_t components = 0;
+    };
+
+    constexpr format_traits get_format_traits(vk::Format a_format)
+    {
+        using vk::Format;
+
+        switch(a_format)
+        {
+            case Format::eR32Sfloat: case Format::eR16Sfloat: case Format::eR8Unorm: case Format::eR8Snorm:
+            case Format::eR16Unorm: case Format::eR16Snorm:
+                return {scalar_kind::floating, 1};
+            case Format::eR32G32Sfloat: case Format::eR16G16Sfloat: case Format::eR8G8Unorm:
+            case Format::eR8G8Snorm: case Format::eR16G16Unorm: case Format::eR16G16Snorm:
+                return {scalar_kind::floating, 2};
+            case Format::eR32G32B32Sfloat:
+                return {scalar_kind::floating, 3};
+            case Format::eR32G32B32A32Sfloat: case Format::eR16G16B16A16Sfloat: case Format::eR8G8B8A8Unorm:
+            case Format::eR8G8B8A8Snorm: case Format::eR16G16B16A16Unorm: case Format::eR16G16B16A16Snorm:
+            case Format::eA2B10G10R10UnormPack32: case Format::eA2B10G10R10SnormPack32:
+                return {scalar_kind::floating, 4};
+            case Format::eR32Sint: return {scalar_kind::signed_int, 1};
+            case Format::eR32G32Sint: return {scalar_kind::signed_int, 2};
+            case Format::eR32G32B32Sint: return {scalar_kind::signed_int, 3};
+            case Format::eR32G32B32A32Sint: return {scalar_kind::signed_int, 4};
+            case Format::eR32Uint: return {scalar_kind::unsigned_int, 1};
+            case Format::eR32G32Uint: return {scalar_kind::unsigned_int, 2};
+            case Format::eR32G32B32Uint: return {scalar_kind::unsigned_int, 3};
+            case Format::eR32G32B32A32Uint: return {scalar_kind::unsigned_int, 4};
+            default:
+                return {};
+        }
+    }
+
+    namespace detail
+    {
+        // Opcodes, decorations, storage classes and execution models, as numbered by the SPIR-V specification
+
+        enum op : uint32_t
+        {
+            op_entry_point = 15,
+            op_type_int = 21,
+            op_type_float = 22,
+            op_type_vector = 23,
+            op_type_matrix = 24,
+            op_type_image = 25,
+            op_type_sampler = 26,
+            op_type_sampled_image = 27,
+            op_type_array = 28,
+            op_type_runtime_array = 29,
+            op_type_struct = 30,
+            op_type_pointer = 32,
+            op_constant = 43,
+            op_variable = 59,
+            op_decorate = 71,
+            op_member_decorate = 72
+        };
+
+        enum decoration : uint32_t
+        {
+            dec_block = 2,
+            dec_buffer_block = 3,
+            dec_array_stride = 6,
+            dec_matrix_stride = 7,
+            dec_built_in = 11,
+            dec_location = 30,
+            dec_binding = 33,
+            dec_descriptor_set = 34,
+            dec_offset = 35
+        };
+
+        enum storage : uint32_t
+        {
+            sc_uniform_constant = 0,
+            sc_input = 1,
+            sc_uniform = 2,
+            sc_push_constant = 9,
+            sc_storage_buffer = 12
+        };
+
+        constexpr uint32_t magic = 0x07230203;
+        constexpr size_t header_words = 5;
+        constexpr uint32_t none = ~0u;
+
+        class module_view
+        {
+        public:
+
+            constexpr module_view(const uint32_t* a_code, size_t a_words) : m_code{a_code}, m_words{a_words}
+            {}
+
+            constexpr bool valid() const
+            {
+                return m_words > header_words && m_code[0] == magic;
+            }
+
+            template<typename Visitor>
+            constexpr void for_each(Visitor a_visitor) const
+            {
+                for(size_t pos = header_words; pos < m_words;)
+                {
+                    auto count = m_code[pos] >> 16;
+                    if(count == 0 || pos + count > m_words)
+                        return;
+                    if(!a_visitor(static_cast<uint32_t>(m_code[pos] & 0xffffu), m_code + pos, count))
+                        return;
+                    pos += count;
+                }
+            }
+
+            // Instruction declaring the given type or constant, nullptr when not found
+
+            constexpr const uint32_t* find_definition(uint32_t a_id) const
+            {
+                const uint32_t* result = nullptr;
+
+                for_each([&](uint32_t a_op, const uint32_t* a_ins, uint32_t a_count) {
+                    bool is_type = a_op >= op_type_int && a_op <= op_type_pointer;
+                    bool is_constant = a_op == op_constant;
+                    if((is_type && a_count > 1 && a_ins[1] == a_id) || (is_constant && a_count > 2 && a_ins[2] == a_id))
+                    {
+                        result = a_ins;
+                        return false;
+                    }
+                    return true;
+                });
+
+                return result;
+            }
+
+            constexpr uint32_t decoration(uint32_t a_id, uint32_t a_decoration) const
+            {
+                uint32_t result = none;
+
+                for_each([&](uint32_t a_op, const uint32_t* a_ins, uint32_t a_count) {
+                    if(a_op == op_decorate && a_count > 2 && a_ins[1] == a_id && a_ins[2] == a_decoration)
+                    {
+                        result = a_count > 3 ? a_ins[3] : 0;
+                        return false;
+                    }
+                    return true;
+                });
+
+                return result;
+            }
+
+            constexpr uint32_t member_decoration(uint32_t a_id, uint32_t a_member, uint32_t a_decoration) const
+            {
+                uint32_t result = none;
+
+                for_each([&](uint32_t a_op, const uint32_t* a_ins, uint32_t a_count) {
+                    if(a_op == op_member_decorate && a_count > 3 && a_ins[1] == a_id && a_ins[2] == a_member &&
+                       a_ins[3] == a_decoration)
+                    {
+                        result = a_count > 4 ? a_ins[4] : 0;
+                        return false;
+                    }
+                    return true;
+                });
+
+                return result;
+            }
+
+            constexpr uint32_t constant_value(uint32_t a_id) const
+            {
+                auto ins = find_definition(a_id);
+                return ins && (ins[0] & 0xffffu) == op_constant ? ins[3] : 1;
+            }
+
+            // Size in bytes of a type as laid out in a block, following the explicit layout decorations
+
+            constexpr uint32_t type_size(uint32_t a_id, uint32_t a_matrix_stride = none) const
+            {
+                auto ins = find_definition(a_id);
+
+                if(!ins)
+                    return 0;
+
+                switch(ins[0] & 0xffffu)
+                {
+                    case op_type_int:
+                    case op_type_float:
+                        return ins[2] / 8;
+                    case op_type_vector:
+                        return type_size(ins[2]) * ins[3];
+                    case op_type_matrix:
+                        return (a_matrix_stride != none ? a_matrix_stride : type_size(ins[2])) * ins[3];
+                    case op_type_array:
+                    {
+                        auto stride = decoration(ins[1], dec_array_stride);
+                        return (stride != none ? stride : type_size(ins[2])) * constant_value(ins[3]);
+                    }
+                    case op_type_struct:
+                    {
+                        uint32_t size = 0;
+                        for(uint32_t m = 0; m + 2 < (ins[0] >> 16); ++m)
+                        {
+                            auto offset = member_decoration(ins[1], m, dec_offset);
+                            auto end = (offset != none ? offset : size) +
+                                type_size(ins[2 + m], member_decoration(ins[1], m, dec_matrix_stride));
+                            size = end > size ? end : size;
+                        }
+                        return size;
+                    }
+                    default:
+                        return 0;
+                }
+            }
+
+        private:
+
+            const uint32_t* m_code;
+            size_t m_words;
+        };
+
+        constexpr scalar_kind kind_of(const uint32_t* a_ins)
+        {
+            if((a_ins[0] & 0xffffu) == op_type_float)
+                return scalar_kind::floating;
+            if((a_ins[0] & 0xffffu) == op_type_int)
+                return a_ins[3] ? scalar_kind::signed_int : scalar_kind::unsigned_int;
+            return scalar_kind::unknown;
+        }
+
+        constexpr vk::ShaderStageFlagBits stage_of(uint32_t a_execution_model)
+        {
+            switch(a_execution_model)
+            {
+                case 0: return vk::ShaderStageFlagBits::eVertex;
+                case 4: return vk::ShaderStageFlagBits::eFragment;
+                case 5: return vk::ShaderStageFlagBits::eCompute;
+                default: return vk::ShaderStageFlagBits::eAll;
+            }
+        }
+    }
+
+    constexpr reflection reflect(const uint32_t* a_code, size_t a_words)
+    {
+        using namespace detail;
+
+        reflection result;
+        module_view module{a_code, a_words};
+
+        if(!module.valid())
+            return result;
+
+        result.valid = true;
+
+        module.for_each([&](uint32_t a_op, const uint32_t* a_ins, uint32_t a_count) {
+            if(a_op == op_entry_point && result.stage == vk::ShaderStageFlagBits::eAll)
+                result.stage = stage_of(a_ins[1]);
+
+            if(a_op != op_variable || a_count < 4)
+                return true;
+
+            auto var_id = a_ins[2];
+            auto storage_class = a_ins[3];
+            auto pointer = module.find_definition(a_ins[1]);
+
+            if(!pointer || (pointer[0] & 0xffffu) != op_type_pointer)
+                return true;
+
+            auto type = module.find_definition(pointer[3]);
+
+            if(!type)
+                return true;
+
+            if(storage_class == sc_input)
+            {
+                if(module.decoration(var_id, dec_built_in) != none)
+                    return true;
+
+                stage_input input;
+
+                input.location = module.decoration(var_id, dec_location);
+
+                if((type[0] & 0xffffu) == op_type_vector)
+                {
+                    input.components = type[3];
+                    type = module.find_definition(type[2]);
+                }
+                else
+                    input.components = 1;
+
+                input.kind = type ? kind_of(type) : scalar_kind::unknown;
+
+                if(input.location != none && input.kind != scalar_kind::unknown)
+                    result.valid &= result.inputs.push(input);
+            }
+            else if(storage_class == sc_push_constant)
+            {
+                result.push_constant_size = module.type_size(type[1]);
+            }
+            else if(storage_class == sc_uniform_constant || storage_class == sc_uniform ||
+                    storage_class == sc_storage_buffer)
+            {
+                descriptor_binding binding;
+
+                binding.set = module.decoration(var_id, dec_descriptor_set);
+                binding.binding = module.decoration(var_id, dec_binding);
+
+                if(binding.set == none || binding.binding == none)
+                    return true;
+
+                // Arrays of resources map to a single binding with a descriptor count
+
+                while(type && (type[0] & 0xffffu) == op_type_array)
+                {
+                    binding.count *= module.constant_value(type[3]);
+                    type = module.find_definition(type[2]);
+                }
+
+                if(!type)
+                    return true;
+
+                switch(type[0] & 0xffffu)
+                {
+                    case op_type_sampled_image:
+                        binding.type = vk::DescriptorType::eCombinedImageSampler;
+                        break;
+                    case op_type_sampler:
+                        binding.type = vk::DescriptorType::eSampler;
+                        break;
+                    case op_type_image:
+                        binding.type = type[7] == 2 ? vk::DescriptorType::eStorageImage :
+                            vk::DescriptorType::eSampledImage;
+                        break;
+                    case op_type_struct:
+                        binding.type = storage_class == sc_storage_buffer ||
+                            module.decoration(type[1], dec_buffer_block) != none ?
+                                vk::DescriptorType::eStorageBuffer : vk::DescriptorType::eUniformBuffer;
+                        break;
+                    default:
+                        return true;
+                }
+
+                result.valid &= result.bindings.push(binding);
+            }
+
+            return true;
+        });
+
+        return result;
+    }
+
+    // True when every vertex stage input is fed by an attribute of the layout with the same location, numeric
+    // kind and component count, and every attribute of the layout is consumed. A wider attribute than the shader
+    // reads only costs fetch bandwidth, so it is reported as a mismatch too.
+
+    template<typename Layout>
+    constexpr bool matches_vertex_layout(const reflection& a_shader)
+    {
+        if(!a_shader.valid)
+            return false;
+
+        for(auto& input : a_shader.inputs)
+        {
+            bool found = false;
+
+            for(auto& attribute : Layout::attributes)
+            {
+                if(attribute.location != input.location)
+                    continue;
+
+                auto traits = get_format_traits(attribute.format);
+
+                if(traits.kind != input.kind || traits.components != input.components)
+                    return false;
+
+                found = true;
+            }
+
+            if(!found)
+                return false;
+        }
+
+        for(auto& attribute : Layout::attributes)
+        {
+            bool consumed = false;
+
+            for(auto& input : a_shader.inputs)
+                consumed = consumed || input.location == attribute.location;
+
+            if(!consumed)
+                return false;
+        }
+
+        return true;
+    }
+
+    // True when two stages agree on every descriptor binding they share. Pipeline layouts merge stages by set and
+    // binding, so a type or array size that differs between them has to be caught here rather than by the driver.
+
+    constexpr bool compatible_bindings(const reflection& a_first, const reflection& a_second)
+    {
+        if(!a_first.valid || !a_second.valid)
+            return false;
+
+        for(auto& first : a_first.bindings)
+        {
+            for(auto& second : a_second.bindings)
+            {
+                if(first.set != second.set || first.binding != second.binding)
+                    continue;
+
+                if(first.type != second.type || first.count != second.count)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+}}
+
+#endif //NCV_GRAPHICS_SHADERS_REFLECTION_HPP
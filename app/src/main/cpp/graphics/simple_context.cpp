@@ -101,14 +101,11 @@ namespace graphics
 
     simple_context::~simple_context()
     {
-        if(m_cmd_buffers.size() > 0)
+        // The device outlives a suspension, so it is there even when the window resources are already gone
+
+        if(m_device)
         {
-            m_device->waitIdle();
-            m_device->freeCommandBuffers(m_cmd_pool.get(), m_cmd_buffers);
-            m_cmd_buffers.clear();
-            m_device->destroyCommandPool(m_cmd_pool.release());
-            m_device->destroySwapchainKHR(m_swap_chain.release());
-            m_instance->destroySurfaceKHR(m_surface.release());
+            release_window_resources();
             m_device->destroySemaphore(m_render_semaphore.release());
             m_device->destroySemaphore(m_semaphore.release());
             if(m_enable_validation && !!m_debug_msg)
@@ -123,15 +120,7 @@ namespace graphics
     {
         m_app = a_app;
 
-        if(m_cmd_buffers.size() > 0)
-        {
-            m_device->destroySwapchainKHR(m_swap_chain.release());
-            m_instance->destroySurfaceKHR(m_surface.release());
-            m_device->waitIdle();
-            m_device->freeCommandBuffers(m_cmd_pool.get(), m_cmd_buffers);
-            m_cmd_buffers.clear();
-            m_device->destroyCommandPool(m_cmd_pool.release());
-        }
+        release_window_resources();
 
         // Create a presentation surface
 
@@ -374,6 +363,30 @@ namespace graphics
             _log_android(log_level::debug) << "Command buffers created with success.";
     }
 
+    void simple_context::suspend_graphics()
+    {
+        // The window is about to go away, the device and semaphores are kept for the next initialize_graphics
+
+        release_window_resources();
+
+        if constexpr(__ncv_logging_enabled)
+            _log_android(log_level::debug) << "Graphics suspended, window bound resources released.";
+    }
+
+    void simple_context::release_window_resources()
+    {
+        if(m_cmd_buffers.empty())
+            return;
+
+        m_device->waitIdle();
+        m_device->freeCommandBuffers(m_cmd_pool.get(), m_cmd_buffers);
+        m_cmd_buffers.clear();
+        m_images.clear();
+        m_device->destroyCommandPool(m_cmd_pool.release());
+        m_device->destroySwapchainKHR(m_swap_chain.release());
+        m_instance->destroySurfaceKHR(m_surface.release());
+    }
+
     void simple_context::render_frame(const std::any& a_params)
     {
         vec4 a_rgba = any_cast<vec4>(a_params);
@@ -32,10 +32,13 @@ namespace graphics
         explicit simple_context(const std::string& a_app_name);
         ~simple_context();
         void initialize_graphics(android_app* a_app);
+        void suspend_graphics();
         void render_frame(const std::any& a_params);
 
     private:
 
+        void release_window_resources();
+
 #ifdef NCV_VULKAN_VALIDATION_ENABLED
         const bool m_enable_validation = true;
 #else
@@ -0,0 +1,105 @@
+#
+# Copyright 2020 Konstantinos Tzevanidis
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+# Compiles the GLSL sources to SPIR-V, optimizes them and embeds the result as constexpr word arrays in a
+# single header. The arrays are inline, every translation unit including the header shares one copy of each
+# module. Invoked by the build as:
+#
+# >cmake -DGLSLANG=<glslangValidator> [-DSPIRV_OPT=<spirv-opt>] -DSHADERS="<a.vert;b.frag>"
+#        -DWORK_DIR=<dir> -DOUTPUT=<header> -P shaders.cmake
+
+if(NOT GLSLANG OR NOT SHADERS OR NOT WORK_DIR OR NOT OUTPUT)
+    message(FATAL_ERROR "GLSLANG, SHADERS, WORK_DIR and OUTPUT must be defined.")
+endif()
+
+file(MAKE_DIRECTORY ${WORK_DIR})
+
+set(ARRAYS_ "")
+set(ENTRIES_ "")
+
+foreach(SHADER_ ${SHADERS})
+    get_filename_component(NAME_ ${SHADER_} NAME)
+    string(REGEX REPLACE "[^A-Za-z0-9_]" "_" IDENTIFIER_ ${NAME_})
+
+    set(SPV_ ${WORK_DIR}/${NAME_}.spv)
+
+    execute_process(COMMAND ${GLSLANG} -V ${SHADER_} -o ${SPV_}
+            RESULT_VARIABLE RESULT_
+            OUTPUT_VARIABLE LOG_
+            ERROR_VARIABLE LOG_)
+
+    if(NOT RESULT_ EQUAL 0)
+        message(FATAL_ERROR "Compilation of ${NAME_} failed:\n${LOG_}")
+    endif()
+
+    if(SPIRV_OPT)
+        execute_process(COMMAND ${SPIRV_OPT} -O ${SPV_} -o ${SPV_}.opt
+                RESULT_VARIABLE RESULT_
+                OUTPUT_VARIABLE LOG_
+                ERROR_VARIABLE LOG_)
+
+        if(NOT RESULT_ EQUAL 0)
+            message(FATAL_ERROR "Optimization of ${NAME_} failed:\n${LOG_}")
+        endif()
+
+        set(SPV_ ${SPV_}.opt)
+    endif()
+
+    # SPIR-V is a little endian stream of 32-bit words, swap each group of four bytes into a word literal
+
+    file(READ ${SPV_} HEX_ HEX)
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])"
+            "0x\\4\\3\\2\\1," WORDS_ ${HEX_})
+    string(REPEAT "0x[0-9a-f]+," 8 ROW_)
+    string(REGEX REPLACE "(${ROW_})" "\\1\n            " WORDS_ ${WORDS_})
+
+    string(APPEND ARRAYS_ "
+    inline constexpr uint32_t ${IDENTIFIER_}[] = {
+            ${WORDS_}
+    };
+")
+    string(APPEND ENTRIES_ "
+        spirv_module{\"${NAME_}\", ${IDENTIFIER_}, sizeof(${IDENTIFIER_})},")
+endforeach()
+
+file(WRITE ${OUTPUT}.tmp "// Generated by shaders.cmake, do not edit.
+
+#ifndef NCV_GRAPHICS_SHADERS_SPIRV_HPP
+#define NCV_GRAPHICS_SHADERS_SPIRV_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace graphics{ namespace shaders{
+
+    struct spirv_module
+    {
+        const char* name;
+        const uint32_t* code;
+        size_t size;
+    };
+${ARRAYS_}
+    inline constexpr spirv_module modules[] = {${ENTRIES_}
+    };
+}}
+
+#endif //NCV_GRAPHICS_SHADERS_SPIRV_HPP
+")
+
+# Only touch the header when its contents change, so sources including it are not needlessly rebuilt
+
+execute_process(COMMAND ${CMAKE_COMMAND} -E copy_if_different ${OUTPUT}.tmp ${OUTPUT})
+file(REMOVE ${OUTPUT}.tmp)
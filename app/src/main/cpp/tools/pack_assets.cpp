@@ -0,0 +1,307 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+// Builds an asset pack (see graphics/data/asset_pack.hpp) out of a directory tree, runs on the host:
+//
+// >c++ -std=c++17 -O2 -I.. pack_assets.cpp ../graphics/data/asset_pack.cpp -lz -o pack_assets
+// >pack_assets [--store] [--align <bytes>] <assets directory> <output pack>
+// >pack_assets --bench <assets directory> <pack>
+//
+// Entry names are the paths relative to the directory, with '/' separators. Entries are deflated when that
+// saves at least an eighth of their size, unless --store is given. Already compressed formats (JPEG, KTX2
+// with supercompression) are left as they are by that rule.
+//
+// --bench compares reading every file of the directory on its own with mapping the pack once and reading the
+// same entries out of it (page cache warm, every page touched on both sides).
+
+#include <graphics/data/asset_pack.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+namespace
+{
+    using graphics::data::asset_pack;
+
+    struct source
+    {
+        std::string name;
+        std::vector<uint8_t> data;
+        asset_pack::compression method = asset_pack::compression::none;
+        uint64_t size = 0;
+    };
+
+    std::vector<uint8_t> read_file(const std::filesystem::path& a_path)
+    {
+        std::ifstream file{a_path, std::ios::binary | std::ios::ate};
+
+        if(!file)
+            throw std::runtime_error{"Couldn't open " + a_path.string() + "."};
+
+        std::vector<uint8_t> data(static_cast<size_t>(file.tellg()));
+
+        file.seekg(0);
+
+        if(!file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())))
+            throw std::runtime_error{"Couldn't read " + a_path.string() + "."};
+
+        return data;
+    }
+
+    void deflate_if_smaller(source& a_source)
+    {
+        auto bound = compressBound(static_cast<uLong>(a_source.data.size()));
+        std::vector<uint8_t> packed(bound);
+
+        if(compress2(packed.data(), &bound, a_source.data.data(), static_cast<uLong>(a_source.data.size()),
+            Z_BEST_COMPRESSION) != Z_OK)
+            throw std::runtime_error{"Couldn't deflate " + a_source.name + "."};
+
+        if(bound > a_source.data.size() - a_source.data.size() / 8)
+            return;
+
+        packed.resize(bound);
+        a_source.data.swap(packed);
+        a_source.method = asset_pack::compression::deflate;
+    }
+
+    uint64_t align_up(uint64_t a_value, uint64_t a_alignment)
+    {
+        return (a_value + a_alignment - 1) / a_alignment * a_alignment;
+    }
+
+    uint8_t touch(const uint8_t* a_data, size_t a_size)
+    {
+        volatile uint8_t sink = 0;
+
+        for(size_t i = 0; i < a_size; i += 4096)
+            sink = sink + a_data[i];
+
+        return sink;
+    }
+
+    void benchmark(const std::filesystem::path& a_root, const std::filesystem::path& a_pack)
+    {
+        using clock_type = std::chrono::steady_clock;
+
+        constexpr int rounds = 100;
+
+        std::vector<std::pair<std::string, std::filesystem::path>> files;
+
+        for(auto& item : std::filesystem::recursive_directory_iterator{a_root})
+            if(item.is_regular_file())
+                files.emplace_back(item.path().lexically_relative(a_root).generic_string(), item.path());
+
+        if(files.empty())
+            throw std::runtime_error{"Nothing to compare in " + a_root.string() + "."};
+
+        auto start = clock_type::now();
+
+        for(int round = 0; round < rounds; ++round)
+            for(auto& file : files)
+            {
+                auto data = read_file(file.second);
+                touch(data.data(), data.size());
+            }
+
+        auto loose_us = std::chrono::duration<double, std::micro>(clock_type::now() - start).count() / rounds;
+        auto open_us = 0.0;
+
+        start = clock_type::now();
+
+        for(int round = 0; round < rounds; ++round)
+        {
+            auto opened = clock_type::now();
+            asset_pack pack{a_pack.string()};
+
+            open_us += std::chrono::duration<double, std::micro>(clock_type::now() - opened).count();
+
+            std::vector<uint8_t> storage;
+
+            for(auto& file : files)
+            {
+                if(!pack.contains(file.first))
+                    continue;
+
+                auto contents = pack.read(file.first, storage);
+                touch(contents.data(), contents.size());
+            }
+        }
+
+        auto pack_us = std::chrono::duration<double, std::micro>(clock_type::now() - start).count() / rounds;
+
+        std::cout << files.size() << " files: " << loose_us << " us read separately, " << pack_us
+            << " us out of the pack (" << open_us / rounds << " us of it mapping).\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool store = false, bench = false;
+    uint64_t alignment = 16;
+    std::vector<std::string> paths;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg{argv[i]};
+
+        if(arg == "--store")
+            store = true;
+        else if(arg == "--bench")
+            bench = true;
+        else if(arg == "--align" && i + 1 < argc)
+            alignment = std::stoull(argv[++i]);
+        else
+            paths.push_back(arg);
+    }
+
+    if(paths.size() != 2 || !alignment || (alignment & (alignment - 1)))
+    {
+        std::cerr << "Usage: pack_assets [--store] [--align <power of two>] <assets directory> <output pack>\n"
+            "       pack_assets --bench <assets directory> <pack>\n";
+        return 1;
+    }
+
+    if(bench)
+    {
+        try
+        {
+            benchmark(paths[0], paths[1]);
+        }
+        catch(std::exception const &e)
+        {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+
+        return 0;
+    }
+
+    try
+    {
+        std::filesystem::path root{paths[0]}, output{paths[1]};
+        std::vector<source> sources;
+        std::error_code ignored;
+
+        for(auto& item : std::filesystem::recursive_directory_iterator{root})
+        {
+            if(!item.is_regular_file() || std::filesystem::equivalent(item.path(), output, ignored))
+                continue;
+
+            source next;
+
+            next.name = item.path().lexically_relative(root).generic_string();
+            next.data = read_file(item.path());
+            next.size = next.data.size();
+
+            if(!store && !next.data.empty())
+                deflate_if_smaller(next);
+
+            sources.push_back(std::move(next));
+        }
+
+        // The reader binary searches the index, names are compared bytewise
+
+        std::sort(sources.begin(), sources.end(), [](const source& a_lhs, const source& a_rhs) {
+            return a_lhs.name < a_rhs.name;
+        });
+
+        std::string names;
+
+        for(auto& item : sources)
+            names += item.name;
+
+        asset_pack::header head{};
+
+        memcpy(head.magic, asset_pack::magic, sizeof(head.magic));
+        head.version = asset_pack::version;
+        head.entry_count = static_cast<uint32_t>(sources.size());
+        head.alignment = static_cast<uint32_t>(alignment);
+        head.names_size = static_cast<uint32_t>(names.size());
+
+        std::vector<asset_pack::entry> entries;
+        uint64_t offset = sizeof(head) + sources.size() * sizeof(asset_pack::entry) + names.size();
+        uint32_t name_offset = 0;
+
+        for(auto& item : sources)
+        {
+            offset = align_up(offset, alignment);
+
+            asset_pack::entry info{};
+
+            info.offset = offset;
+            info.stored_size = item.data.size();
+            info.size = item.size;
+            info.name_offset = name_offset;
+            info.name_length = static_cast<uint32_t>(item.name.size());
+            info.method = item.method;
+
+            entries.push_back(info);
+            offset += item.data.size();
+            name_offset += info.name_length;
+        }
+
+        std::ofstream file{output, std::ios::binary | std::ios::trunc};
+
+        if(!file)
+            throw std::runtime_error{"Couldn't create " + output.string() + "."};
+
+        file.write(reinterpret_cast<const char*>(&head), sizeof(head));
+        file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(asset_pack::entry));
+        file << names;
+
+        uint64_t stored = 0, original = 0;
+
+        for(size_t i = 0; i < sources.size(); ++i)
+        {
+            auto position = static_cast<uint64_t>(file.tellp());
+            std::fill_n(std::ostreambuf_iterator<char>{file}, entries[i].offset - position, '\0');
+            file.write(reinterpret_cast<const char*>(sources[i].data.data()), sources[i].data.size());
+
+            stored += sources[i].data.size();
+            original += sources[i].size;
+
+            std::cout << sources[i].name << ": " << sources[i].size << " bytes"
+                << (sources[i].method == asset_pack::compression::deflate ?
+                    ", deflated to " + std::to_string(sources[i].data.size()) : std::string{}) << "\n";
+        }
+
+        if(!file)
+            throw std::runtime_error{"Couldn't write " + output.string() + "."};
+
+        std::cout << sources.size() << " entries, " << original << " bytes stored in " << stored << " (pack "
+            << file.tellp() << " bytes).\n";
+    }
+    catch(std::exception const &e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
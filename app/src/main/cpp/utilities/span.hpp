@@ -0,0 +1,79 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_SPAN_HPP
+#define NCV_SPAN_HPP
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace utilities
+{
+    // Non owning view over contiguous elements, a subset of C++20 std::span.
+
+    template<typename T>
+    class span
+    {
+    public:
+
+        using element_type = T;
+        using value_type = std::remove_cv_t<T>;
+
+        constexpr span() noexcept = default;
+
+        constexpr span(T* a_data, size_t a_size) noexcept : m_data{a_data}, m_size{a_size}
+        {}
+
+        template<size_t N>
+        constexpr span(T (&a_array)[N]) noexcept : m_data{a_array}, m_size{N}
+        {}
+
+        template<size_t N>
+        constexpr span(std::array<value_type, N>& a_array) noexcept : m_data{a_array.data()}, m_size{N}
+        {}
+
+        template<size_t N, typename U = T, typename = std::enable_if_t<std::is_const<U>::value>>
+        constexpr span(const std::array<value_type, N>& a_array) noexcept : m_data{a_array.data()}, m_size{N}
+        {}
+
+        span(std::vector<value_type>& a_vector) noexcept : m_data{a_vector.data()}, m_size{a_vector.size()}
+        {}
+
+        template<typename U = T, typename = std::enable_if_t<std::is_const<U>::value>>
+        span(const std::vector<value_type>& a_vector) noexcept : m_data{a_vector.data()}, m_size{a_vector.size()}
+        {}
+
+        constexpr T* data() const noexcept { return m_data; }
+        constexpr size_t size() const noexcept { return m_size; }
+        constexpr size_t size_bytes() const noexcept { return m_size * sizeof(T); }
+        constexpr bool empty() const noexcept { return m_size == 0; }
+
+        constexpr T* begin() const noexcept { return m_data; }
+        constexpr T* end() const noexcept { return m_data + m_size; }
+
+        constexpr T& operator[](size_t a_index) const noexcept { return m_data[a_index]; }
+
+    private:
+
+        T* m_data = nullptr;
+        size_t m_size = 0;
+    };
+}
+
+#endif //NCV_SPAN_HPP
@@ -1,30 +0,0 @@
-/*
- * Copyright 2020 Konstantinos Tzevanidis
- *
- * Licensed under the Apache License, Version 2.0 (the "License");
- * you may not use this file except in compliance with the License.
- * You may obtain a copy of the License at
- *
- *      http://www.apache.org/licenses/LICENSE-2.0
- *
- * Unless required by applicable law or agreed to in writing, software
- * distributed under the License is distributed on an "AS IS" BASIS,
- * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
- * See the License for the specific language governing permissions and
- * limitations under the License.
- *
- */
-
-#version 450
-#extension GL_ARB_separate_shader_objects : enable
-
-layout(binding = 1) uniform sampler2D cam_sampler;
-
-layout(location = 0) in vec3 i_color;
-layout(location = 1) in vec2 i_tex_coords;
-
-layout(location = 0) out vec4 o_color;
-
-void main() {
-    o_color = texture(cam_sampler, i_tex_coords);
-}
@@ -18,7 +18,13 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
-layout(binding = 1) uniform sampler2D tex_sampler;
+// Sampling mode, fixed per pipeline variant through specialization:
+//   0 - still texture
+//   1 - camera image (the immutable sampler carries the YCbCr conversion)
+
+layout(constant_id = 0) const uint sampling_mode = 0u;
+
+layout(binding = 1) uniform sampler2D i_sampler;
 
 layout(location = 0) in vec3 i_color;
 layout(location = 1) in vec2 i_tex_coords;
@@ -26,5 +32,8 @@ layout(location = 1) in vec2 i_tex_coords;
 layout(location = 0) out vec4 o_color;
 
 void main() {
-    o_color = texture(tex_sampler, i_tex_coords) + 0.1f;
+    if(sampling_mode == 1u)
+        o_color = texture(i_sampler, i_tex_coords);
+    else
+        o_color = texture(i_sampler, i_tex_coords) + 0.1f;
 }
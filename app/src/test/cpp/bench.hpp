@@ -0,0 +1,69 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_BENCH_HPP
+#define NCV_BENCH_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+// Minimal timing for the host benchmarks. Each case runs until a time budget is spent and reports its fastest
+// run, which is the least disturbed by the rest of the machine. Numbers are only comparable within one run.
+
+namespace bench
+{
+    // Keeps the compiler from dropping work whose result is never read
+
+    inline void keep(const void* a_pointer)
+    {
+        asm volatile("" : : "g"(a_pointer) : "memory");
+    }
+
+    // Fastest run of a_body in milliseconds, a_body runs at least 3 times and for at least a_budget_ms
+
+    template<typename Body>
+    double measure(Body&& a_body, double a_budget_ms = 200.0)
+    {
+        using clock = std::chrono::steady_clock;
+
+        auto best = 1e300;
+        auto spent = 0.0;
+
+        for(int runs = 0; runs < 3 || spent < a_budget_ms; ++runs)
+        {
+            auto start = clock::now();
+            a_body();
+            auto ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+            best = std::min(best, ms);
+            spent += ms;
+        }
+
+        return best;
+    }
+
+    // One line per case: name, problem size, fastest run and the cost per item
+
+    inline void report(const char* a_name, size_t a_items, double a_ms, const char* a_unit = "item")
+    {
+        std::printf("%-40s %10zu %12.3f ms %12.2f ns/%s\n", a_name, a_items, a_ms,
+            a_items ? a_ms * 1e6 / static_cast<double>(a_items) : 0.0, a_unit);
+    }
+}
+
+#endif //NCV_BENCH_HPP
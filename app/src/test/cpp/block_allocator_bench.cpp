@@ -0,0 +1,145 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <graphics/resources/block_allocator.hpp>
+#include <bench.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+// Allocation throughput of the block allocators, and fragmentation of the buddy allocator under a long
+// running mix of allocations and frees. Sizes are spread log uniformly from 256 bytes to 64 KiB inside the
+// default 16 MiB block of the memory allocator.
+
+namespace
+{
+    using namespace graphics::resources;
+
+    constexpr uint64_t capacity = 16ull << 20;
+    constexpr uint64_t alignment = 256;
+
+    std::vector<uint64_t> make_sizes(size_t a_count, uint32_t a_seed)
+    {
+        std::mt19937 rng{a_seed};
+        std::uniform_real_distribution<double> exponent{8.0, 16.0};
+        std::vector<uint64_t> sizes(a_count);
+
+        for(auto& size : sizes)
+            size = static_cast<uint64_t>(std::exp2(exponent(rng)));
+
+        return sizes;
+    }
+
+    // Allocates every size, then frees them in random order
+
+    template<typename Allocator>
+    void throughput(const char* a_name, const std::vector<uint64_t>& a_sizes)
+    {
+        std::vector<block_range> ranges;
+        std::vector<size_t> order(a_sizes.size());
+
+        for(size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+
+        std::shuffle(order.begin(), order.end(), std::mt19937{5});
+
+        auto ms = bench::measure([&] {
+            Allocator allocator{capacity};
+
+            ranges.clear();
+
+            for(auto size : a_sizes)
+            {
+                block_range range;
+
+                if(allocator.allocate(size, alignment, range))
+                    ranges.push_back(range);
+            }
+
+            for(auto i : order)
+                if(i < ranges.size())
+                    allocator.free(ranges[i]);
+
+            bench::keep(&allocator);
+        });
+
+        bench::report(a_name, a_sizes.size() * 2, ms, "op");
+    }
+
+    // Keeps about half the block live while replacing random allocations, then reports how much of the
+    // rounding and free space is lost
+
+    void fragmentation(size_t a_operations)
+    {
+        buddy_allocator allocator{capacity};
+        std::mt19937 rng{9};
+        auto sizes = make_sizes(a_operations, 13);
+
+        std::vector<std::pair<block_range, uint64_t>> live;
+        uint64_t requested = 0;
+        size_t failures = 0;
+
+        for(auto size : sizes)
+        {
+            while(!live.empty() && requested + size > capacity / 2)
+            {
+                std::uniform_int_distribution<size_t> pick{0, live.size() - 1};
+                auto victim = pick(rng);
+
+                allocator.free(live[victim].first);
+                requested -= live[victim].second;
+                live[victim] = live.back();
+                live.pop_back();
+            }
+
+            block_range range;
+
+            if(!allocator.allocate(size, alignment, range))
+            {
+                failures++;
+                continue;
+            }
+
+            live.emplace_back(range, size);
+            requested += size;
+        }
+
+        auto used = allocator.get_used();
+        auto free = allocator.get_capacity() - used;
+
+        std::printf("buddy after %zu operations: %zu live, %.1f%% of the block used for %.1f%% requested, largest "
+            "free range %.1f%% of free space, %zu failed\n", a_operations, live.size(), 100.0 * used / capacity,
+            100.0 * requested / capacity, free ? 100.0 * allocator.get_largest_free() / free : 0.0, failures);
+    }
+}
+
+int main()
+{
+    for(size_t count : {100u, 500u})
+    {
+        auto sizes = make_sizes(count, 1);
+
+        throughput<buddy_allocator>("buddy allocate + free", sizes);
+        throughput<linear_allocator>("linear allocate + free", sizes);
+    }
+
+    fragmentation(100000);
+    fragmentation(1000000);
+
+    return 0;
+}
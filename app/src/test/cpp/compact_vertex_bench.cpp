@@ -0,0 +1,111 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <graphics/data/compact_vertex.hpp>
+#include <bench.hpp>
+
+#include <cstring>
+#include <random>
+#include <string>
+
+// Packing a large mesh into each compact layout, and one pass over the packed streams. The pass reads every
+// byte a vertex fetch of the layout would, so it shows how the footprint scales memory traffic on the host;
+// fetch bandwidth on the GPU itself needs a device.
+
+namespace
+{
+    using namespace graphics::data;
+
+    constexpr size_t vertex_count = 1 << 20;
+
+    std::vector<vertex_format> make_mesh()
+    {
+        std::mt19937 rng{3};
+        std::uniform_real_distribution<float> unit{0.f, 1.f};
+        std::vector<vertex_format> vertices(vertex_count);
+
+        for(auto& v : vertices)
+        {
+            v.position = {unit(rng) * 2.f - 1.f, unit(rng) * 2.f - 1.f, unit(rng) * 2.f - 1.f, 1.f};
+            v.color = {unit(rng), unit(rng), unit(rng), 1.f};
+            v.tex_coords = {unit(rng), unit(rng)};
+        }
+
+        return vertices;
+    }
+
+    // Sums the stream as 32 bit words, every byte is loaded once
+
+    template<typename T>
+    uint32_t read_stream(const std::vector<T>& a_stream)
+    {
+        auto bytes = reinterpret_cast<const uint8_t*>(a_stream.data());
+        auto size = a_stream.size() * sizeof(T);
+        uint32_t sum = 0;
+
+        for(size_t i = 0; i + 4 <= size; i += 4)
+        {
+            uint32_t word;
+            std::memcpy(&word, bytes + i, 4);
+            sum += word;
+        }
+
+        return sum;
+    }
+
+    template<typename T>
+    std::string label(const char* a_action, const char* a_layout)
+    {
+        return std::string{a_action} + " " + a_layout + " (" + std::to_string(sizeof(T)) + " B)";
+    }
+
+    template<typename T>
+    void run(const std::vector<vertex_format>& a_mesh, const char* a_layout)
+    {
+        std::vector<T> packed;
+
+        bench::report(label<T>("pack", a_layout).c_str(), a_mesh.size(), bench::measure([&] {
+            packed = pack_vertices<T>(a_mesh);
+            bench::keep(packed.data());
+        }), "vertex");
+
+        bench::report(label<T>("read", a_layout).c_str(), packed.size(), bench::measure([&] {
+            auto sum = read_stream(packed);
+            bench::keep(&sum);
+        }), "vertex");
+    }
+}
+
+int main()
+{
+    auto mesh = make_mesh();
+
+    bench::report(label<vertex_format>("read", "vertex_format").c_str(), mesh.size(), bench::measure([&] {
+        auto sum = read_stream(mesh);
+        bench::keep(&sum);
+    }), "vertex");
+
+    run<compact_vertex>(mesh, "compact_vertex");
+    run<snorm_vertex>(mesh, "snorm_vertex");
+
+    // Position only passes bind the first stream alone
+
+    run<split_position>(mesh, "split_position");
+    run<split_attributes>(mesh, "split_attributes");
+
+    return 0;
+}
@@ -0,0 +1,248 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <graphics/data/ktx2.hpp>
+#include <test.hpp>
+
+#include <cstring>
+#include <limits>
+
+// KTX2 containers are assembled in memory, then damaged one field at a time
+
+namespace
+{
+    using graphics::data::ktx2;
+    using bytes = std::vector<uint8_t>;
+
+    constexpr uint32_t rgba8_unorm = 37;
+    constexpr uint32_t rgba8_srgb = 43;
+    constexpr uint32_t bc1_rgb_unorm = 131;
+    constexpr uint32_t bc1_rgb_srgb = 132;
+    constexpr uint32_t astc_6x6_unorm = 165;
+
+    constexpr size_t header_size = 80;
+    constexpr size_t level_entry_size = 24;
+    constexpr size_t dfd_size = 44;
+
+    template<typename T>
+    void write(bytes& a_file, size_t a_offset, T a_value)
+    {
+        memcpy(a_file.data() + a_offset, &a_value, sizeof(T));
+    }
+
+    size_t level_entry(uint32_t a_level)
+    {
+        return header_size + a_level * level_entry_size;
+    }
+
+    // Levels are stored back to back after the descriptor, with the sizes given
+
+    bytes make_file(uint32_t a_format, uint32_t a_width, uint32_t a_height, const std::vector<uint64_t>& a_sizes)
+    {
+        const uint8_t identifier[12] = {0xab, 0x4b, 0x54, 0x58, 0x20, 0x32, 0x30, 0xbb, 0x0d, 0x0a, 0x1a, 0x0a};
+
+        auto level_count = static_cast<uint32_t>(a_sizes.size());
+        auto dfd_offset = header_size + level_count * level_entry_size;
+        auto offset = dfd_offset + dfd_size;
+
+        bytes file(offset, 0);
+
+        memcpy(file.data(), identifier, sizeof(identifier));
+        write<uint32_t>(file, 12, a_format);
+        write<uint32_t>(file, 16, 1);
+        write<uint32_t>(file, 20, a_width);
+        write<uint32_t>(file, 24, a_height);
+        write<uint32_t>(file, 36, 1);
+        write<uint32_t>(file, 40, level_count);
+        write<uint32_t>(file, 48, static_cast<uint32_t>(dfd_offset));
+        write<uint32_t>(file, 52, static_cast<uint32_t>(dfd_size));
+
+        for(uint32_t i = 0; i < level_count; ++i)
+        {
+            write<uint64_t>(file, level_entry(i), offset);
+            write<uint64_t>(file, level_entry(i) + 8, a_sizes[i]);
+            write<uint64_t>(file, level_entry(i) + 16, a_sizes[i]);
+            offset += a_sizes[i];
+        }
+
+        file.resize(offset, 0x5a);
+
+        return file;
+    }
+
+    ktx2 parse(const bytes& a_file)
+    {
+        return ktx2{utilities::span<const uint8_t>{a_file}};
+    }
+
+    void parses_valid_levels()
+    {
+        auto file = make_file(rgba8_unorm, 4, 2, {32, 8, 4});
+        auto container = parse(file);
+        auto& levels = container.get_levels();
+
+        NCV_CHECK(container.get_format() == rgba8_unorm);
+        NCV_CHECK(container.get_width() == 4 && container.get_height() == 2);
+        NCV_CHECK(!container.is_basis() && !container.is_srgb());
+        NCV_CHECK(levels.size() == 3);
+        NCV_CHECK(levels[1].width == 2 && levels[1].height == 1 && levels[1].size == 8);
+        NCV_CHECK(levels[2].width == 1 && levels[2].height == 1 && levels[2].size == 4);
+        NCV_CHECK(levels[2].offset + levels[2].size == file.size());
+
+        // Block formats round partial blocks up, 5x5 BC1 is 2x2 blocks of 8 bytes
+
+        auto bc1 = make_file(bc1_rgb_srgb, 5, 5, {32});
+
+        NCV_CHECK(parse(bc1).is_srgb());
+        NCV_CHECK(parse(bc1).get_levels()[0].size == 32);
+        NCV_CHECK(parse(make_file(rgba8_srgb, 1, 1, {4})).is_srgb());
+    }
+
+    void rejects_truncated_headers()
+    {
+        auto file = make_file(rgba8_unorm, 1, 1, {4});
+
+        NCV_CHECK(ktx2::is_ktx2(utilities::span<const uint8_t>{file}));
+        NCV_CHECK_THROWS(parse(bytes{}));
+        NCV_CHECK_THROWS(parse(bytes(file.begin(), file.begin() + 12)));
+        NCV_CHECK_THROWS(parse(bytes(file.begin(), file.begin() + header_size - 1)));
+
+        auto bad_identifier = file;
+
+        bad_identifier[5] ^= 0xff;
+
+        NCV_CHECK(!ktx2::is_ktx2(utilities::span<const uint8_t>{bad_identifier}));
+        NCV_CHECK_THROWS(parse(bad_identifier));
+
+        // The level index runs past the end of the file
+
+        auto levels = make_file(rgba8_unorm, 4, 4, {64, 16, 4});
+
+        NCV_CHECK_THROWS(parse(bytes(levels.begin(), levels.begin() + level_entry(2) + 8)));
+    }
+
+    void rejects_out_of_bounds_dfd()
+    {
+        auto file = make_file(rgba8_unorm, 1, 1, {4});
+
+        auto past_end = file;
+        write<uint32_t>(past_end, 48, static_cast<uint32_t>(file.size() - 8));
+        NCV_CHECK_THROWS(parse(past_end));
+
+        auto too_long = file;
+        write<uint32_t>(too_long, 52, static_cast<uint32_t>(file.size()));
+        NCV_CHECK_THROWS(parse(too_long));
+
+        // Offset and length that wrap around in 32 bits
+
+        auto wrapping = file;
+        write<uint32_t>(wrapping, 48, std::numeric_limits<uint32_t>::max() - 8);
+        write<uint32_t>(wrapping, 52, 16);
+        NCV_CHECK_THROWS(parse(wrapping));
+    }
+
+    void rejects_out_of_bounds_levels()
+    {
+        auto file = make_file(rgba8_unorm, 2, 2, {16, 4});
+
+        auto offset_past_end = file;
+        write<uint64_t>(offset_past_end, level_entry(1), file.size() + 1);
+        NCV_CHECK_THROWS(parse(offset_past_end));
+
+        auto size_past_end = file;
+        write<uint64_t>(size_past_end, level_entry(1), file.size() - 2);
+        NCV_CHECK_THROWS(parse(size_past_end));
+
+        // Offset plus size would wrap around in 64 bits
+
+        auto wrapping = file;
+        write<uint64_t>(wrapping, level_entry(0) + 8, std::numeric_limits<uint64_t>::max() - 8);
+        NCV_CHECK_THROWS(parse(wrapping));
+
+        // More levels than the mip chain of the image has
+
+        NCV_CHECK_THROWS(parse(make_file(rgba8_unorm, 2, 2, {16, 4, 4})));
+    }
+
+    void rejects_level_size_mismatch()
+    {
+        NCV_CHECK_THROWS(parse(make_file(rgba8_unorm, 4, 4, {60})));
+        NCV_CHECK_THROWS(parse(make_file(rgba8_unorm, 4, 4, {64, 20})));
+        NCV_CHECK_THROWS(parse(make_file(bc1_rgb_unorm, 8, 8, {64})));
+        NCV_CHECK_THROWS(parse(make_file(astc_6x6_unorm, 12, 12, {32})));
+
+        NCV_CHECK(parse(make_file(astc_6x6_unorm, 12, 12, {64})).get_levels().size() == 1);
+    }
+
+    void rejects_unsupported_content()
+    {
+        auto supercompressed = make_file(rgba8_unorm, 1, 1, {4});
+        write<uint32_t>(supercompressed, 44, 2);
+        NCV_CHECK_THROWS(parse(supercompressed));
+
+        NCV_CHECK_THROWS(parse(make_file(1000, 1, 1, {4})));
+
+        auto layered = make_file(rgba8_unorm, 1, 1, {4});
+        write<uint32_t>(layered, 32, 2);
+        NCV_CHECK_THROWS(parse(layered));
+
+        auto empty = make_file(rgba8_unorm, 1, 1, {4});
+        write<uint32_t>(empty, 20, 0);
+        NCV_CHECK_THROWS(parse(empty));
+    }
+
+    void block_info()
+    {
+        auto astc = ktx2::get_block_info(astc_6x6_unorm);
+
+        NCV_CHECK(astc && astc->width == 6 && astc->height == 6 && astc->bytes == 16);
+        NCV_CHECK(ktx2::get_block_info(bc1_rgb_srgb)->bytes == 8);
+        NCV_CHECK(!ktx2::get_block_info(0));
+        NCV_CHECK(!ktx2::get_block_info(157 + 28));
+    }
+
+    void prepare_honors_device_support()
+    {
+        auto file = make_file(bc1_rgb_unorm, 4, 4, {8});
+        auto container = parse(file);
+        utilities::span<const uint8_t> view{file};
+
+        auto image = graphics::data::prepare_ktx2(container, view, [](uint32_t a_format) {
+            return a_format == bc1_rgb_unorm;
+        });
+
+        NCV_CHECK(image.format == bc1_rgb_unorm);
+        NCV_CHECK(image.data.empty());
+        NCV_CHECK(image.levels.size() == 1 && image.levels[0].size == 8);
+
+        NCV_CHECK_THROWS(graphics::data::prepare_ktx2(container, view, [](uint32_t) { return false; }));
+    }
+}
+
+int main()
+{
+    parses_valid_levels();
+    rejects_truncated_headers();
+    rejects_out_of_bounds_dfd();
+    rejects_out_of_bounds_levels();
+    rejects_level_size_mismatch();
+    rejects_unsupported_content();
+    block_info();
+    prepare_honors_device_support();
+
+    return test::result();
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <engine/lifecycle.hpp>
+#include <test.hpp>
+
+#include <vector>
+
+// Drives engine::lifecycle through window and focus events against a backend that only records the calls
+
+namespace
+{
+    enum class call
+    {
+        start,
+        stop,
+        suspend,
+        resume
+    };
+
+    struct fake_backend
+    {
+        void start_engine() { calls.push_back(call::start); }
+        void stop_engine() { calls.push_back(call::stop); }
+        void suspend_engine() { calls.push_back(call::suspend); }
+
+        bool resume_engine()
+        {
+            calls.push_back(call::resume);
+            return resumable;
+        }
+
+        std::vector<call> calls;
+        bool resumable = true;
+    };
+
+    using machine = engine::lifecycle<fake_backend>;
+    using state = machine::state;
+    using calls = std::vector<call>;
+
+    void cold_start_and_warm_resume()
+    {
+        fake_backend backend;
+        machine lifecycle{backend};
+
+        NCV_CHECK(lifecycle.get_state() == state::idle);
+
+        lifecycle.focus_gained(true);
+        NCV_CHECK(lifecycle.get_state() == state::running);
+        NCV_CHECK(backend.calls == calls{call::start});
+
+        // Focus that returns without the window going away changes nothing
+
+        lifecycle.focus_gained(true);
+        NCV_CHECK(backend.calls == calls{call::start});
+
+        lifecycle.window_terminated();
+        NCV_CHECK(lifecycle.get_state() == state::suspended);
+        NCV_CHECK((backend.calls == calls{call::start, call::suspend}));
+
+        lifecycle.window_terminated();
+        NCV_CHECK((backend.calls == calls{call::start, call::suspend}));
+
+        lifecycle.focus_gained(true);
+        NCV_CHECK(lifecycle.get_state() == state::running);
+        NCV_CHECK((backend.calls == calls{call::start, call::suspend, call::resume}));
+    }
+
+    void failed_resume_restarts()
+    {
+        fake_backend backend;
+        machine lifecycle{backend};
+
+        lifecycle.focus_gained(true);
+        lifecycle.window_terminated();
+
+        backend.resumable = false;
+        lifecycle.focus_gained(true);
+
+        NCV_CHECK(lifecycle.get_state() == state::running);
+        NCV_CHECK((backend.calls == calls{call::start, call::suspend, call::resume, call::stop, call::start}));
+    }
+
+    void permission_change_restarts()
+    {
+        fake_backend backend;
+        machine lifecycle{backend};
+
+        lifecycle.focus_gained(false);
+        lifecycle.window_terminated();
+        lifecycle.focus_gained(true);
+
+        NCV_CHECK(lifecycle.get_state() == state::running);
+        NCV_CHECK(lifecycle.is_camera_permitted());
+        NCV_CHECK((backend.calls == calls{call::start, call::suspend, call::stop, call::start}));
+    }
+
+    void destroy_while_suspended()
+    {
+        fake_backend backend;
+        machine lifecycle{backend};
+
+        lifecycle.focus_gained(true);
+        lifecycle.window_terminated();
+        lifecycle.destroy();
+
+        NCV_CHECK(lifecycle.get_state() == state::idle);
+        NCV_CHECK((backend.calls == calls{call::start, call::suspend, call::stop}));
+
+        lifecycle.destroy();
+        NCV_CHECK((backend.calls == calls{call::start, call::suspend, call::stop}));
+    }
+
+    void events_while_idle()
+    {
+        fake_backend backend;
+        machine lifecycle{backend};
+
+        lifecycle.window_terminated();
+        lifecycle.destroy();
+
+        NCV_CHECK(lifecycle.get_state() == state::idle);
+        NCV_CHECK(backend.calls.empty());
+    }
+}
+
+int main()
+{
+    cold_start_and_warm_resume();
+    failed_resume_restarts();
+    permission_change_restarts();
+    destroy_while_suspended();
+    events_while_idle();
+
+    return test::result();
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <graphics/data/mesh_optimizer.hpp>
+#include <test.hpp>
+
+#include <algorithm>
+#include <array>
+#include <random>
+
+namespace
+{
+    using namespace graphics::data;
+
+    using triangle = std::array<uint32_t, 3>;
+
+    // Regular grid of quads, two triangles each, with row by row triangle order
+
+    std::vector<uint32_t> make_grid(uint32_t a_size)
+    {
+        std::vector<uint32_t> indices;
+
+        for(uint32_t y = 0; y < a_size; ++y)
+        {
+            for(uint32_t x = 0; x < a_size; ++x)
+            {
+                uint32_t v = y * (a_size + 1) + x;
+                indices.insert(indices.end(), {v, v + a_size + 1, v + 1, v + 1, v + a_size + 1, v + a_size + 2});
+            }
+        }
+
+        return indices;
+    }
+
+    std::vector<uint32_t> shuffle_triangles(const std::vector<uint32_t>& a_indices)
+    {
+        std::vector<triangle> triangles(a_indices.size() / 3);
+        std::vector<uint32_t> result;
+
+        for(size_t t = 0; t < triangles.size(); ++t)
+            triangles[t] = {a_indices[t * 3], a_indices[t * 3 + 1], a_indices[t * 3 + 2]};
+
+        std::shuffle(triangles.begin(), triangles.end(), std::mt19937{42});
+
+        for(auto& t : triangles)
+            result.insert(result.end(), t.begin(), t.end());
+
+        return result;
+    }
+
+    std::vector<triangle> sorted_triangles(const std::vector<uint32_t>& a_indices)
+    {
+        std::vector<triangle> result(a_indices.size() / 3);
+
+        for(size_t t = 0; t < result.size(); ++t)
+            result[t] = {a_indices[t * 3], a_indices[t * 3 + 1], a_indices[t * 3 + 2]};
+
+        std::sort(result.begin(), result.end());
+
+        return result;
+    }
+
+    void acmr_bounds()
+    {
+        NCV_CHECK(compute_acmr({}) == 0.f);
+        NCV_CHECK(compute_acmr({0, 1, 2, 3, 4, 5}) == 3.f);
+        NCV_CHECK(compute_acmr({0, 1, 2, 2, 1, 3}) == 2.f);
+    }
+
+    void vertex_cache_keeps_triangles()
+    {
+        // Triangles are only reordered, each one keeps its vertices and winding
+
+        auto input = shuffle_triangles(make_grid(40));
+        auto output = optimize_vertex_cache(input, 41 * 41);
+
+        NCV_CHECK(output.size() == input.size());
+        NCV_CHECK(sorted_triangles(output) == sorted_triangles(input));
+    }
+
+    void vertex_cache_improves_acmr()
+    {
+        auto input = shuffle_triangles(make_grid(64));
+        auto output = optimize_vertex_cache(input, 65 * 65);
+
+        auto before = compute_acmr(input);
+        auto after = compute_acmr(output);
+
+        NCV_CHECK(before > 2.f);
+        NCV_CHECK(after < 1.f);
+        NCV_CHECK(after <= compute_acmr(make_grid(64)));
+    }
+
+    void vertex_cache_rejects_bad_input()
+    {
+        NCV_CHECK_THROWS(optimize_vertex_cache({0, 1}, 2));
+        NCV_CHECK_THROWS(optimize_vertex_cache({0, 1, 5}, 3));
+        NCV_CHECK(optimize_vertex_cache({}, 0).empty());
+    }
+
+    void vertex_fetch_remaps_in_first_use_order()
+    {
+        // Vertex 1 and 4 are unused
+
+        std::vector<uint32_t> indices{5, 3, 0, 0, 3, 2, 6, 5, 2};
+        auto original = indices;
+        size_t used = 0;
+
+        auto remap = optimize_vertex_fetch(indices, 7, used);
+
+        NCV_CHECK(used == 5);
+        NCV_CHECK(remap.size() == 7);
+        NCV_CHECK(remap[1] == UINT32_MAX && remap[4] == UINT32_MAX);
+        NCV_CHECK((indices == std::vector<uint32_t>{0, 1, 2, 2, 1, 3, 4, 0, 3}));
+
+        for(size_t i = 0; i < indices.size(); ++i)
+            NCV_CHECK(remap[original[i]] == indices[i]);
+
+        NCV_CHECK_THROWS(optimize_vertex_fetch(original, 6, used));
+    }
+
+    void optimized_mesh_references_same_vertices()
+    {
+        // After both passes every triangle still resolves to the same vertex data, in a dense buffer whose
+        // first use order matches the index order.
+
+        uint32_t vertex_count = 33 * 33;
+        std::vector<uint32_t> vertices(vertex_count);
+
+        for(uint32_t v = 0; v < vertex_count; ++v)
+            vertices[v] = v * 7 + 1;
+
+        auto input = shuffle_triangles(make_grid(32));
+        auto indices = optimize_vertex_cache(input, vertex_count);
+        auto cached = indices;
+        size_t used = 0;
+
+        auto remap = optimize_vertex_fetch(indices, vertex_count, used);
+        auto remapped = remap_vertices(vertices, remap, used);
+
+        NCV_CHECK(used == vertex_count);
+        NCV_CHECK(remapped.size() == used);
+
+        uint32_t next = 0;
+
+        for(size_t i = 0; i < indices.size(); ++i)
+        {
+            NCV_CHECK(indices[i] < used);
+            NCV_CHECK(remapped[indices[i]] == vertices[cached[i]]);
+
+            if(indices[i] == next)
+                next++;
+            else
+                NCV_CHECK(indices[i] < next);
+        }
+
+        NCV_CHECK(compute_acmr(indices) == compute_acmr(cached));
+    }
+}
+
+int main()
+{
+    acmr_bounds();
+    vertex_cache_keeps_triangles();
+    vertex_cache_improves_acmr();
+    vertex_cache_rejects_bad_input();
+    vertex_fetch_remaps_in_first_use_order();
+    optimized_mesh_references_same_vertices();
+
+    return test::result();
+}
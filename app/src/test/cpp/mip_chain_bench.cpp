@@ -0,0 +1,126 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <graphics/data/mip_chain.hpp>
+#include <bench.hpp>
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+// The CPU side of mipmapping: building a full RGBA8 chain with the box filter (the path taken when the format
+// can't be blitted), and what a chain saves when a texture is drawn minified. The second part samples a
+// 256x256 footprint out of the base level and out of the level of matching size, the same texel count read
+// from a spread out or a compact region, which is the locality the sampler gains on the GPU.
+
+namespace
+{
+    using namespace graphics::data;
+
+    constexpr uint32_t channels = 4;
+
+    std::vector<std::vector<uint8_t>> make_chain(uint32_t a_size)
+    {
+        std::mt19937 rng{21};
+        std::vector<std::vector<uint8_t>> chain(1, std::vector<uint8_t>(static_cast<size_t>(a_size) * a_size *
+            channels));
+
+        for(auto& texel : chain[0])
+            texel = static_cast<uint8_t>(rng());
+
+        for(auto size = a_size; size > 1; size /= 2)
+        {
+            chain.emplace_back(static_cast<size_t>(size / 2) * (size / 2) * channels);
+            downsample(chain[chain.size() - 2].data(), size, size, channels, chain.back().data());
+        }
+
+        return chain;
+    }
+
+    // Nearest texel of every output pixel, a_size / a_output apart in the source
+
+    uint32_t sample(const std::vector<uint8_t>& a_level, uint32_t a_size, uint32_t a_output)
+    {
+        auto step = a_size / a_output;
+        uint32_t sum = 0;
+
+        for(uint32_t y = 0; y < a_output; ++y)
+        {
+            for(uint32_t x = 0; x < a_output; ++x)
+            {
+                uint32_t texel;
+                std::memcpy(&texel, &a_level[(static_cast<size_t>(y * step) * a_size + x * step) * channels], 4);
+                sum += texel;
+            }
+        }
+
+        return sum;
+    }
+
+    void run(uint32_t a_size)
+    {
+        auto prefix = std::to_string(a_size) + "^2 ";
+        auto chain = make_chain(a_size);
+        auto pixels = static_cast<size_t>(a_size) * a_size;
+
+        size_t chain_bytes = 0;
+
+        for(auto& level : chain)
+            chain_bytes += level.size();
+
+        bench::report((prefix + "box filter chain").c_str(), pixels, bench::measure([&] {
+            auto size = a_size;
+
+            for(size_t level = 1; level < chain.size(); ++level, size /= 2)
+                downsample(chain[level - 1].data(), size, size, channels, chain[level].data());
+
+            bench::keep(chain.back().data());
+        }), "base texel");
+
+        std::printf("%s%u levels, %.1f%% more memory than the base level\n", prefix.c_str(),
+            mip_count(a_size, a_size), 100.0 * (chain_bytes - chain[0].size()) / chain[0].size());
+
+        // 256x256 on screen, nearest filtering on both sides so only the source level differs
+
+        constexpr uint32_t output = 256;
+        auto level = 0u;
+
+        for(auto size = a_size; size > output; size /= 2)
+            level++;
+
+        bench::report((prefix + "minified, base level").c_str(), output * output, bench::measure([&] {
+            auto sum = sample(chain[0], a_size, output);
+            bench::keep(&sum);
+        }), "pixel");
+
+        bench::report((prefix + "minified, level " + std::to_string(level)).c_str(), output * output,
+            bench::measure([&] {
+                auto sum = sample(chain[level], a_size >> level, output);
+                bench::keep(&sum);
+            }), "pixel");
+    }
+}
+
+int main()
+{
+    run(1024);
+    run(2048);
+    run(4096);
+
+    return 0;
+}
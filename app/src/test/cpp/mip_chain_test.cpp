@@ -0,0 +1,109 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <graphics/data/mip_chain.hpp>
+#include <test.hpp>
+
+#include <vector>
+
+namespace
+{
+    using namespace graphics::data;
+
+    void counts_levels_down_to_one_texel()
+    {
+        NCV_CHECK(mip_count(1, 1) == 1);
+        NCV_CHECK(mip_count(2, 2) == 2);
+        NCV_CHECK(mip_count(256, 256) == 9);
+        NCV_CHECK(mip_count(256, 1) == 9);
+        NCV_CHECK(mip_count(300, 200) == 9);
+        NCV_CHECK(mip_count(4032, 3024) == 12);
+    }
+
+    void averages_two_by_two_blocks()
+    {
+        // 4x2, two channels, rounded to nearest
+
+        const std::vector<uint8_t> src = {
+            0, 10,   2, 20,   100, 0,   200, 255,
+            4, 30,   6, 41,   100, 0,   201, 255
+        };
+        std::vector<uint8_t> dst(2 * 1 * 2);
+
+        downsample(src.data(), 4, 2, 2, dst.data());
+
+        NCV_CHECK(dst[0] == 3 && dst[1] == 25);
+        NCV_CHECK(dst[2] == 150 && dst[3] == 128);
+    }
+
+    void handles_odd_and_one_texel_wide_sizes()
+    {
+        // 3x3 halves to 1x1, the last row and column are left out like in a blit
+
+        const std::vector<uint8_t> src = {
+            10, 20, 30,
+            40, 50, 60,
+            70, 80, 90
+        };
+        std::vector<uint8_t> dst(1);
+
+        downsample(src.data(), 3, 3, 1, dst.data());
+        NCV_CHECK(dst[0] == 30);
+
+        // 1x4 and 4x1 stay one texel wide, the missing neighbour is the texel itself
+
+        const std::vector<uint8_t> line = {0, 100, 200, 255};
+        std::vector<uint8_t> half(2);
+
+        downsample(line.data(), 1, 4, 1, half.data());
+        NCV_CHECK(half[0] == 50 && half[1] == 228);
+
+        half.assign(2, 0);
+        downsample(line.data(), 4, 1, 1, half.data());
+        NCV_CHECK(half[0] == 50 && half[1] == 228);
+    }
+
+    void a_full_chain_ends_in_the_mean()
+    {
+        // Uniform images stay uniform all the way down
+
+        uint32_t size = 64;
+        auto levels = mip_count(size, size);
+        std::vector<uint8_t> level(size * size * 4, 77), next;
+
+        for(uint32_t i = 1; i < levels; ++i)
+        {
+            next.resize(static_cast<size_t>(size / 2) * (size / 2) * 4);
+            downsample(level.data(), size, size, 4, next.data());
+            level.swap(next);
+            size /= 2;
+        }
+
+        NCV_CHECK(size == 1);
+        NCV_CHECK(level.size() == 4 && level[0] == 77 && level[3] == 77);
+    }
+}
+
+int main()
+{
+    counts_levels_down_to_one_texel();
+    averages_two_by_two_blocks();
+    handles_odd_and_one_texel_wide_sizes();
+    a_full_chain_ends_in_the_mean();
+
+    return test::result();
+}
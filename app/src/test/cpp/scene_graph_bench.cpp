@@ -0,0 +1,100 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <graphics/data/scene_graph.hpp>
+#include <bench.hpp>
+
+#include <random>
+#include <string>
+
+// update() of trees from 1k to 100k nodes with a growing share of moving nodes, from a frame where nothing
+// moved to one where the root moved and every world matrix is recomputed
+
+namespace
+{
+    using namespace graphics::data;
+
+    // Every node has a_fan_out children, a fan out of 1 is a single chain
+
+    scene_graph make_tree(size_t a_count, size_t a_fan_out)
+    {
+        scene_graph graph;
+
+        graph.add_node();
+
+        for(size_t i = 1; i < a_count; ++i)
+            graph.add_node(static_cast<scene_graph::node_id>((i - 1) / a_fan_out));
+
+        for(scene_graph::node_id i = 0; i < a_count; ++i)
+            graph.set(i, glm::vec3{static_cast<float>(i % 7), 1.f, 0.f}, glm::quat{1.f, 0.f, 0.f, 0.f},
+                glm::vec3{1.f});
+
+        graph.update();
+
+        return graph;
+    }
+
+    void run(const char* a_shape, size_t a_count, size_t a_fan_out)
+    {
+        auto graph = make_tree(a_count, a_fan_out);
+        auto prefix = std::string{a_shape} + " ";
+
+        std::mt19937 rng{11};
+        std::uniform_int_distribution<scene_graph::node_id> any_node{0,
+            static_cast<scene_graph::node_id>(a_count - 1)};
+        auto position = 0.f;
+
+        bench::report((prefix + "clean").c_str(), a_count, bench::measure([&] {
+            auto range = graph.update();
+            bench::keep(&range);
+        }), "node");
+
+        bench::report((prefix + "one leaf").c_str(), a_count, bench::measure([&] {
+            graph.set_translation(static_cast<scene_graph::node_id>(a_count - 1), glm::vec3{position += 1.f});
+            auto range = graph.update();
+            bench::keep(&range);
+        }), "node");
+
+        for(auto share : {100u, 10u})
+        {
+            bench::report((prefix + "1/" + std::to_string(share) + " random").c_str(), a_count, bench::measure([&] {
+                for(size_t i = 0; i < a_count / share; ++i)
+                    graph.set_translation(any_node(rng), glm::vec3{position += 1.f});
+                auto range = graph.update();
+                bench::keep(&range);
+            }), "node");
+        }
+
+        bench::report((prefix + "root").c_str(), a_count, bench::measure([&] {
+            graph.set_translation(0, glm::vec3{position += 1.f});
+            auto range = graph.update();
+            bench::keep(&range);
+        }), "node");
+    }
+}
+
+int main()
+{
+    for(size_t count : {1000u, 10000u, 100000u})
+    {
+        run("flat", count, count);
+        run("fan out 4", count, 4);
+        run("chain", count, 1);
+    }
+
+    return 0;
+}
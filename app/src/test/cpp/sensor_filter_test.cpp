@@ -0,0 +1,133 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <devices/sensor_filter.hpp>
+#include <test.hpp>
+
+#include <cmath>
+
+namespace
+{
+    constexpr int64_t ms = 1000000;
+
+    bool near(float a_lhs, float a_rhs, float a_tolerance = 1e-4f)
+    {
+        return std::fabs(a_lhs - a_rhs) < a_tolerance;
+    }
+
+    void low_pass_passes_through_without_time_constant()
+    {
+        devices::low_pass_filter<float> filter;
+
+        NCV_CHECK(filter.update(0, 1.f) == 1.f);
+        NCV_CHECK(filter.update(10 * ms, 5.f) == 5.f);
+    }
+
+    void low_pass_weights_by_time()
+    {
+        // A batch of two 10ms samples has to end up where a single 20ms step of the same signal would,
+        // up to the discretization of the first order filter.
+
+        devices::low_pass_filter<float> batched{.1f}, single{.1f};
+
+        batched.update(0, 0.f);
+        batched.update(10 * ms, 1.f);
+        batched.update(20 * ms, 1.f);
+
+        single.update(0, 0.f);
+        single.update(20 * ms, 1.f);
+
+        NCV_CHECK(near(batched.state(), single.state(), .02f));
+        NCV_CHECK(batched.state() > 0.f && batched.state() < 1.f);
+
+        // Stale or repeated timestamps don't move the state
+
+        auto state = batched.state();
+
+        NCV_CHECK(batched.update(20 * ms, 100.f) == state);
+        NCV_CHECK(batched.update(5 * ms, 100.f) == state);
+    }
+
+    void low_pass_converges()
+    {
+        devices::low_pass_filter<float> filter{.05f};
+
+        filter.update(0, 0.f);
+
+        for(int64_t t = 1; t <= 200; ++t)
+            filter.update(t * 5 * ms, 2.f);
+
+        NCV_CHECK(near(filter.state(), 2.f));
+
+        filter.reset();
+        NCV_CHECK(filter.update(2000 * ms, -1.f) == -1.f);
+    }
+
+    void complementary_primes_with_reference()
+    {
+        devices::complementary_filter<float> filter{.5f};
+
+        NCV_CHECK(!filter.is_primed());
+        NCV_CHECK(filter.update(0, 10.f, 3.f) == 3.f);
+        NCV_CHECK(filter.is_primed());
+    }
+
+    void complementary_follows_rate_short_term()
+    {
+        // Within a small fraction of the time constant the integrated rate dominates the reference
+
+        devices::complementary_filter<float> filter{10.f};
+
+        filter.update(0, 0.f, 0.f);
+
+        for(int64_t t = 1; t <= 10; ++t)
+            filter.update(t * 10 * ms, 1.f, 0.f);
+
+        NCV_CHECK(near(filter.state(), .1f, .001f));
+    }
+
+    void complementary_cancels_drift_long_term()
+    {
+        // A constant rate bias with a still reference settles at bias * time constant instead of growing
+
+        devices::complementary_filter<float> filter{.5f};
+
+        filter.update(0, 0.f, 0.f);
+
+        for(int64_t t = 1; t <= 2000; ++t)
+            filter.update(t * 5 * ms, .2f, 0.f);
+
+        NCV_CHECK(near(filter.state(), .2f * .5f, .002f));
+
+        // Without a time constant only the reference is left
+
+        filter.set_time_constant(0.f);
+        NCV_CHECK(filter.update(10005 * ms, 5.f, 1.f) == 1.f);
+    }
+}
+
+int main()
+{
+    low_pass_passes_through_without_time_constant();
+    low_pass_weights_by_time();
+    low_pass_converges();
+    complementary_primes_with_reference();
+    complementary_follows_rate_short_term();
+    complementary_cancels_drift_long_term();
+
+    return test::result();
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <devices/sensor_history.hpp>
+#include <test.hpp>
+
+#include <cmath>
+
+namespace
+{
+    using history = devices::sensor_history<float, 4>;
+
+    bool near(float a_lhs, float a_rhs)
+    {
+        return std::fabs(a_lhs - a_rhs) < 1e-5f;
+    }
+
+    void push_rejects_out_of_order()
+    {
+        history samples;
+
+        NCV_CHECK(samples.push(100, 1.f));
+        NCV_CHECK(samples.push(200, 2.f));
+        NCV_CHECK(!samples.push(200, 3.f));
+        NCV_CHECK(!samples.push(150, 3.f));
+        NCV_CHECK(samples.size() == 2);
+        NCV_CHECK(samples.latest().timestamp == 200 && samples.latest().value == 2.f);
+
+        // A rejected sample leaves the next in-order one unaffected
+
+        NCV_CHECK(samples.push(201, 4.f));
+        NCV_CHECK(samples.size() == 3);
+    }
+
+    void push_overwrites_oldest()
+    {
+        history samples;
+
+        for(int64_t i = 1; i <= 6; ++i)
+            samples.push(i * 10, static_cast<float>(i));
+
+        NCV_CHECK(samples.size() == history::capacity);
+        NCV_CHECK(samples.oldest().timestamp == 30);
+        NCV_CHECK(samples.latest().timestamp == 60);
+
+        for(size_t i = 1; i < samples.size(); ++i)
+            NCV_CHECK(samples[i - 1].timestamp < samples[i].timestamp);
+
+        NCV_CHECK(!samples.push(20, 0.f));
+
+        samples.clear();
+        NCV_CHECK(samples.empty());
+        NCV_CHECK(samples.push(20, 0.f));
+    }
+
+    void sample_at_interpolates()
+    {
+        history samples;
+
+        samples.push(1000, 0.f);
+        samples.push(2000, 10.f);
+        samples.push(4000, 30.f);
+
+        NCV_CHECK(near(samples.sample_at(1000), 0.f));
+        NCV_CHECK(near(samples.sample_at(1500), 5.f));
+        NCV_CHECK(near(samples.sample_at(2000), 10.f));
+        NCV_CHECK(near(samples.sample_at(3000), 20.f));
+        NCV_CHECK(near(samples.sample_at(3999), 29.99f));
+
+        // Interpolation also holds across the wrap of the ring
+
+        samples.push(5000, 40.f);
+        samples.push(6000, 20.f);
+
+        NCV_CHECK(samples.oldest().timestamp == 2000);
+        NCV_CHECK(near(samples.sample_at(5500), 30.f));
+    }
+
+    void sample_at_clamps_ends()
+    {
+        history samples;
+
+        NCV_CHECK(samples.sample_at(100) == 0.f);
+
+        samples.push(1000, 5.f);
+
+        NCV_CHECK(samples.sample_at(0) == 5.f);
+        NCV_CHECK(samples.sample_at(2000) == 5.f);
+
+        samples.push(2000, 7.f);
+
+        NCV_CHECK(samples.sample_at(-1000) == 5.f);
+        NCV_CHECK(samples.sample_at(999) == 5.f);
+        NCV_CHECK(samples.sample_at(2001) == 7.f);
+        NCV_CHECK(samples.sample_at(1000000) == 7.f);
+    }
+
+    void sample_at_custom_blend()
+    {
+        history samples;
+
+        samples.push(0, 1.f);
+        samples.push(100, 3.f);
+
+        auto t = samples.sample_at(25, [](float, float, float a_t) { return a_t; });
+
+        NCV_CHECK(near(t, .25f));
+    }
+}
+
+int main()
+{
+    push_rejects_out_of_order();
+    push_overwrites_oldest();
+    sample_at_interpolates();
+    sample_at_clamps_ends();
+    sample_at_custom_blend();
+
+    return test::result();
+}
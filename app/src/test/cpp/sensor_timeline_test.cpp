@@ -0,0 +1,154 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <devices/sensor_timeline.hpp>
+#include <test.hpp>
+
+#include <cmath>
+
+// Synthetic timestamp streams resampled at camera frame times
+
+namespace
+{
+    using devices::sensor_timeline;
+    using time_base = sensor_timeline::time_base;
+
+    bool near(float a_lhs, float a_rhs, float a_tolerance = 1e-4f)
+    {
+        return std::fabs(a_lhs - a_rhs) < a_tolerance;
+    }
+
+    bool near(const glm::vec3& a_lhs, const glm::vec3& a_rhs)
+    {
+        return near(a_lhs.x, a_rhs.x) && near(a_lhs.y, a_rhs.y) && near(a_lhs.z, a_rhs.z);
+    }
+
+    // Rotation angle of a unit quaternion, in degrees, regardless of its sign
+
+    float angle_of(const glm::quat& a_rotation)
+    {
+        return glm::degrees(2.f * std::acos(std::fmin(1.f, std::fabs(a_rotation.w))));
+    }
+
+    glm::quat about_z(float a_degrees)
+    {
+        return glm::angleAxis(glm::radians(a_degrees), glm::vec3{0.f, 0.f, 1.f});
+    }
+
+    void resamples_between_samples()
+    {
+        sensor_timeline timeline;
+
+        for(int64_t i = 0; i < 10; ++i)
+            timeline.push_acceleration(i * 1000, glm::vec3{static_cast<float>(i), 0.f, -static_cast<float>(i)});
+
+        auto state = timeline.state_at(4250);
+
+        NCV_CHECK(state.timestamp == 4250);
+        NCV_CHECK(near(state.acceleration, glm::vec3{4.25f, 0.f, -4.25f}));
+
+        NCV_CHECK(near(timeline.state_at(-500).acceleration, glm::vec3{0.f, 0.f, 0.f}));
+        NCV_CHECK(near(timeline.state_at(20000).acceleration, glm::vec3{9.f, 0.f, -9.f}));
+    }
+
+    void converts_monotonic_timestamps()
+    {
+        // Camera frames stamped in the monotonic base are shifted by the boot time offset before resampling
+
+        sensor_timeline timeline;
+
+        timeline.set_monotonic_offset(5000);
+        timeline.push_angular_rate(10000, glm::vec3{0.f, 0.f, 0.f});
+        timeline.push_angular_rate(20000, glm::vec3{10.f, 0.f, 0.f});
+
+        NCV_CHECK(timeline.to_boottime(7000, time_base::monotonic) == 12000);
+        NCV_CHECK(timeline.to_boottime(7000, time_base::boottime) == 7000);
+
+        auto monotonic = timeline.state_at(10000, time_base::monotonic);
+        auto boottime = timeline.state_at(15000, time_base::boottime);
+
+        NCV_CHECK(monotonic.timestamp == 15000);
+        NCV_CHECK(near(monotonic.angular_rate, boottime.angular_rate));
+        NCV_CHECK(near(monotonic.angular_rate.x, 5.f));
+
+        NCV_CHECK(near(timeline.state_at(15000, time_base::monotonic).angular_rate.x, 10.f));
+    }
+
+    void slerps_orientation()
+    {
+        sensor_timeline timeline;
+
+        NCV_CHECK(near(angle_of(timeline.state_at(0).orientation), 0.f));
+
+        timeline.push_orientation(0, about_z(0.f));
+        timeline.push_orientation(1000, about_z(90.f));
+
+        auto halfway = timeline.state_at(500).orientation;
+
+        NCV_CHECK(near(angle_of(halfway), 45.f, 1e-2f));
+        NCV_CHECK(near(glm::length(halfway), 1.f));
+
+        // Constant angular velocity, so a quarter of the interval is a quarter of the angle
+
+        NCV_CHECK(near(angle_of(timeline.state_at(250).orientation), 22.5f, 1e-2f));
+        NCV_CHECK(near(angle_of(timeline.state_at(2000).orientation), 90.f, 1e-2f));
+    }
+
+    void keeps_orientation_on_short_arc()
+    {
+        // q and -q are the same rotation, a sign flip between samples must not send the blend the long way
+
+        sensor_timeline timeline;
+
+        timeline.push_orientation(0, about_z(0.f));
+        timeline.push_orientation(1000, -about_z(20.f));
+
+        NCV_CHECK(glm::dot(timeline.orientation().latest().value, about_z(20.f)) > 0.f);
+        NCV_CHECK(near(angle_of(timeline.state_at(500).orientation), 10.f, 1e-2f));
+    }
+
+    void latest_spans_all_streams()
+    {
+        sensor_timeline timeline;
+
+        NCV_CHECK(timeline.latest_timestamp() == 0);
+
+        timeline.push_acceleration(100, glm::vec3{1.f, 0.f, 0.f});
+        timeline.push_gravity(300, glm::vec3{0.f, 9.81f, 0.f});
+        timeline.push_angular_rate(200, glm::vec3{0.f, 1.f, 0.f});
+
+        auto state = timeline.latest();
+
+        NCV_CHECK(state.timestamp == 300);
+        NCV_CHECK(near(state.acceleration, glm::vec3{1.f, 0.f, 0.f}));
+        NCV_CHECK(near(state.gravity, glm::vec3{0.f, 9.81f, 0.f}));
+
+        timeline.clear();
+        NCV_CHECK(timeline.latest_timestamp() == 0);
+    }
+}
+
+int main()
+{
+    resamples_between_samples();
+    converts_monotonic_timestamps();
+    slerps_orientation();
+    keeps_orientation_on_short_arc();
+    latest_spans_all_streams();
+
+    return test::result();
+}
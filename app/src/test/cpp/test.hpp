@@ -0,0 +1,61 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NCV_TEST_HPP
+#define NCV_TEST_HPP
+
+#include <iostream>
+
+// Minimal checks for the host tests. A failed check is reported and the test goes on, the executable's exit
+// code tells ctest whether anything failed.
+
+namespace test
+{
+    inline int& failures()
+    {
+        static int count = 0;
+        return count;
+    }
+
+    inline void check(bool a_condition, const char* a_expression, const char* a_file, int a_line)
+    {
+        if(a_condition)
+            return;
+
+        ++failures();
+        std::cerr << a_file << ":" << a_line << ": check failed: " << a_expression << std::endl;
+    }
+
+    inline int result()
+    {
+        if(failures() > 0)
+            std::cerr << failures() << " check(s) failed." << std::endl;
+
+        return failures() > 0 ? 1 : 0;
+    }
+}
+
+#define NCV_CHECK(expr) ::test::check(static_cast<bool>(expr), #expr, __FILE__, __LINE__)
+
+#define NCV_CHECK_THROWS(expr) \
+    do { \
+        bool thrown = false; \
+        try { (void)(expr); } catch(...) { thrown = true; } \
+        ::test::check(thrown, "throws: " #expr, __FILE__, __LINE__); \
+    } while(false)
+
+#endif //NCV_TEST_HPP
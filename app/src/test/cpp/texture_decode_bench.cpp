@@ -0,0 +1,159 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <bench.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+
+#include <stb/stb_image.h>
+#include <stb/stb_image_write.h>
+
+// JPEG decoding with stb_image as texture::load does it (RGBA8 out of a file in memory), for 2 and 12 megapixel
+// images. Decoding alone is compared with the former decode and copy into a vector, and a queue of images is
+// decoded by 1 to N threads the way texture_loader's workers share it.
+
+namespace
+{
+    // Gradients with some noise, so the encoder has detail to keep like in a photograph
+
+    std::vector<uint8_t> make_jpeg(int a_width, int a_height)
+    {
+        std::mt19937 rng{17};
+        std::uniform_int_distribution<int> noise{-24, 24};
+        std::vector<uint8_t> pixels(static_cast<size_t>(a_width) * a_height * 3);
+
+        for(int y = 0; y < a_height; ++y)
+        {
+            for(int x = 0; x < a_width; ++x)
+            {
+                auto pixel = &pixels[(static_cast<size_t>(y) * a_width + x) * 3];
+
+                pixel[0] = static_cast<uint8_t>(std::clamp(x * 255 / a_width + noise(rng), 0, 255));
+                pixel[1] = static_cast<uint8_t>(std::clamp(y * 255 / a_height + noise(rng), 0, 255));
+                pixel[2] = static_cast<uint8_t>(std::clamp(((x ^ y) & 255) + noise(rng), 0, 255));
+            }
+        }
+
+        std::vector<uint8_t> jpeg;
+
+        auto append = [](void* a_context, void* a_data, int a_size) {
+            auto out = static_cast<std::vector<uint8_t>*>(a_context);
+            auto bytes = static_cast<const uint8_t*>(a_data);
+
+            out->insert(out->end(), bytes, bytes + a_size);
+        };
+
+        if(!stbi_write_jpg_to_func(append, &jpeg, a_width, a_height, 3, pixels.data(), 90))
+            throw std::runtime_error{"Could not encode the test image."};
+
+        return jpeg;
+    }
+
+    stbi_uc* decode(const std::vector<uint8_t>& a_jpeg, size_t a_pixel_count)
+    {
+        int width, height, channels;
+
+        auto pixels = stbi_load_from_memory(a_jpeg.data(), static_cast<int>(a_jpeg.size()), &width, &height,
+            &channels, STBI_rgb_alpha);
+
+        if(!pixels)
+            throw std::runtime_error{"Could not decode the test image."};
+
+        if(static_cast<size_t>(width) * height != a_pixel_count)
+        {
+            stbi_image_free(pixels);
+            throw std::runtime_error{"Decoded test image has the wrong size."};
+        }
+
+        return pixels;
+    }
+
+    void run(int a_width, int a_height)
+    {
+        auto jpeg = make_jpeg(a_width, a_height);
+        auto pixel_count = static_cast<size_t>(a_width) * a_height;
+        auto prefix = std::to_string(a_width) + "x" + std::to_string(a_height) + " ";
+
+        bench::report((prefix + "decode").c_str(), pixel_count, bench::measure([&] {
+            auto pixels = decode(jpeg, pixel_count);
+            bench::keep(pixels);
+            stbi_image_free(pixels);
+        }), "pixel");
+
+        std::vector<uint8_t> copy;
+
+        bench::report((prefix + "decode + copy").c_str(), pixel_count, bench::measure([&] {
+            auto pixels = decode(jpeg, pixel_count);
+            copy.assign(pixels, pixels + pixel_count * 4);
+            bench::keep(copy.data());
+            stbi_image_free(pixels);
+        }), "pixel");
+
+        // Eight images per run, workers take the next one off a shared counter
+
+        constexpr size_t images = 8;
+        auto cores = std::max(std::thread::hardware_concurrency(), 1u);
+        std::vector<unsigned> thread_counts;
+
+        for(unsigned threads = 1; threads < cores && threads < images; threads *= 2)
+            thread_counts.push_back(threads);
+
+        thread_counts.push_back(std::min<unsigned>(cores, images));
+
+        for(auto threads : thread_counts)
+        {
+            auto ms = bench::measure([&] {
+                std::atomic<size_t> next{0};
+                std::vector<std::thread> workers;
+
+                for(unsigned i = 0; i < threads; ++i)
+                    workers.emplace_back([&] {
+                        while(next++ < images)
+                        {
+                            auto pixels = decode(jpeg, pixel_count);
+                            bench::keep(pixels);
+                            stbi_image_free(pixels);
+                        }
+                    });
+
+                for(auto& worker : workers)
+                    worker.join();
+            }, 1000.0);
+
+            bench::report((prefix + "8 images, " + std::to_string(threads) + " threads").c_str(),
+                pixel_count * images, ms, "pixel");
+        }
+    }
+}
+
+int main()
+{
+    run(1920, 1080);
+    run(4032, 3024);
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2020 Konstantinos Tzevanidis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <graphics/data/transform_batch.hpp>
+#include <bench.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <random>
+#include <string>
+
+// Model and model-view-projection matrices of 1k to 1M instances, the batch kernels against composing each
+// instance out of glm matrices the way model_view_projection does
+
+namespace
+{
+    using namespace graphics::data;
+
+    struct instance
+    {
+        glm::vec3 translation;
+        glm::quat rotation;
+        glm::vec3 scale;
+    };
+
+    std::vector<instance> make_instances(size_t a_count)
+    {
+        std::mt19937 rng{7};
+        std::uniform_real_distribution<float> unit{-1.f, 1.f};
+        std::vector<instance> instances(a_count);
+
+        for(auto& i : instances)
+        {
+            i.translation = {unit(rng) * 100.f, unit(rng) * 100.f, unit(rng) * 100.f};
+            i.rotation = glm::normalize(glm::quat{unit(rng), unit(rng), unit(rng), unit(rng)});
+            i.scale = glm::vec3{1.f + unit(rng) * .5f};
+        }
+
+        return instances;
+    }
+
+    glm::mat4 glm_model(const instance& a_instance)
+    {
+        return glm::translate(glm::mat4{1.f}, a_instance.translation) * glm::mat4_cast(a_instance.rotation) *
+            glm::scale(glm::mat4{1.f}, a_instance.scale);
+    }
+}
+
+int main()
+{
+    auto view_projection = glm::perspective(glm::radians(45.f), 16.f / 9.f, .1f, 1000.f) *
+        glm::lookAt(glm::vec3{0.f, 0.f, 200.f}, glm::vec3{0.f}, glm::vec3{0.f, 1.f, 0.f});
+    auto isa = std::string{" ("} + transform_batch::get_isa() + ")";
+
+    for(size_t count : {1000u, 10000u, 100000u, 1000000u})
+    {
+        auto instances = make_instances(count);
+        transform_batch batch{count};
+        std::vector<glm::mat4> out(count);
+
+        for(size_t i = 0; i < count; ++i)
+            batch.set(i, instances[i].translation, instances[i].rotation, instances[i].scale);
+
+        bench::report("glm T * R * S", count, bench::measure([&] {
+            for(size_t i = 0; i < count; ++i)
+                out[i] = glm_model(instances[i]);
+            bench::keep(out.data());
+        }), "instance");
+
+        bench::report(("batch models" + isa).c_str(), count, bench::measure([&] {
+            batch.compute_models(&out[0][0][0]);
+            bench::keep(out.data());
+        }), "instance");
+
+        bench::report("glm VP * T * R * S", count, bench::measure([&] {
+            for(size_t i = 0; i < count; ++i)
+                out[i] = view_projection * glm_model(instances[i]);
+            bench::keep(out.data());
+        }), "instance");
+
+        bench::report(("batch mvps" + isa).c_str(), count, bench::measure([&] {
+            batch.compute_mvps(view_projection, &out[0][0][0]);
+            bench::keep(out.data());
+        }), "instance");
+    }
+
+    return 0;
+}